@@ -62,6 +62,8 @@ enum ERROR_MESSAGE
     EM_FEATURE_CREATION_FAILED,
     EM_INSTALL_PDF_VIEWER,
     EM_INSTALL_CHM_VIEWER,
+    EM_UNSUPPORTED_COMPRESSION,
+    EM_COMPRESSION_FAILED,
     EM_COUNT
 };
 
@@ -218,6 +220,10 @@ enum OPTIONS_HELP
     OH_PLAIN_DMS,
     OH_NOPRINTSPPMM,
     OH_SEPARATOR,
+    OH_APPROX,
+    OH_INVERSE_GRIDS,
+    OH_THREADS,
+    OH_LINE_BUFFERED,
     OH_COUNT
 };
 
@@ -286,6 +292,9 @@ enum FILE_FORMAT
     FF_KML_POINT,
     FF_GPX_POINT,
     FF_NMEA_POINT,
+    FF_BINARY,
+    FF_GEOJSON,
+    FF_GEOJSONSEQ,
     FF_COUNT
 };
 
@@ -335,6 +344,8 @@ enum UI_FORMAT
     UF_NMEA_POINT,
     UF_KML_POINT,
     UF_GPX_POINT,
+    UF_GEOJSON,
+    UF_GEOJSONSEQ,
     UF_COUNT
 };
 
@@ -547,7 +558,7 @@ static const std::string StatusText[S_COUNT] =
 
 static const std::string FileFormatText[FF_COUNT] =
 {
-    "UNDEFINED","BASIC","GDAL_OGR","KML","GPX","NMEA"
+    "UNDEFINED","BASIC","GDAL_OGR","KML","GPX","NMEA","BINARY","GEOJSON","GEOJSONSEQ"
 };
 
 //for user-friendly HMI only (unused in API or command-line mode)
@@ -594,7 +605,9 @@ static const std::string uiFormat[UF_COUNT] =
 #endif
     "NMEA",
     "KML",
-    "GPX"
+    "GPX",
+    "GEOJSON",
+    "GEOJSONSEQ"
 };
 
 }
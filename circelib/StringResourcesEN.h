@@ -111,7 +111,9 @@ static const std::string ErrorMessageText[EM_COUNT] =
     "Creating Name field failed",
     "Failed to create feature in layer",
     "Install a PDF viewer",
-    "Install a CHM viewer"
+    "Install a CHM viewer",
+    "Compression not supported by this build: ",
+    "Compression or decompression failed: "
 };
 
 static const std::string OperationMessageText[OM_COUNT] =
@@ -193,12 +195,12 @@ static const std::wstring OptionsHelpText[OH_COUNT] =
    L"Argument: Target CRS ids in format GeodeticCRSid.VerticalCRSid",
    L"Argument: Required transfo ids in format idGeodeticTransfo.idVerticalTransfo",
    L"Follow up transformation values",
-   L"Argument: Source format and units in format FormatId.LinearUnit.AngularUnit",
-   L"Argument: Target format and units in format FormatId.LinearUnit.AngularUnit",
+   L"Argument: Source format and units in format FormatId.LinearUnit.AngularUnit[.BINARY]",
+   L"Argument: Target format and units in format FormatId.LinearUnit.AngularUnit[.BINARY]",
    L"Argument: Source epoch in decimal years",
    L"Argument: Target epoch in decimal years",
-   L"Argument: Source data file pathname",
-   L"Argument: Target data file pathname",
+   L"Argument: Source data file pathname (- for the standard input)",
+   L"Argument: Target data file pathname (- for the standard output)",
    L"Process the tests",
    L"Process multiple CRS",
    L"Silent",
@@ -226,7 +228,11 @@ static const std::wstring OptionsHelpText[OH_COUNT] =
    L"Get a consistent list of target vertical CRS in format id:text,id:text,",
    L"Print plain DMS, not in decimal form",
    L"Don't print scale factor in PPM",
-   L"Field separator"
+   L"Field separator",
+   L"Argument: Tolerance in meters of the approximate (interpolated) fast path, checked on samples of each cell (an estimate, not a strict bound), 0 for exact processing",
+   L"Derive inverse shift grids at loading, so that grids are applied against their direction with a single interpolation",
+   L"Argument: Number of threads processing a file (0 for the number of cores, default 1)",
+   L"Operate and write each line of a file as soon as it is read (streams)"
 };
 
 // for user-friendly HMI purposes, all and only angular units between MU_UNDEF and MU_METER
@@ -320,7 +326,9 @@ static const std::string uiFormatText[UF_COUNT] =
 #endif
     "NMEA points",
     "KML points",
-    "GPX points"
+    "GPX points",
+    "GeoJSON",
+    "GeoJSON text sequence"
 };
 
 static const std::string InterfaceElementText[IE_END] =
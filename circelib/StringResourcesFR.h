@@ -112,7 +112,9 @@ static const std::string ErrorMessageText[EM_COUNT] =
     "Echec de la création du champ Name",
     "Echec de la création d'un élément dans la couche",
     "Installez un visionneur de PDF",
-    "Installez un visionneur de CHM"
+    "Installez un visionneur de CHM",
+    "Compression non prise en charge par cette version : ",
+    "Echec de la compression ou de la décompression : "
 };
 
 static const std::string OperationMessageText[OM_COUNT] =
@@ -194,12 +196,12 @@ static const std::wstring OptionsHelpText[OH_COUNT] =
    L"Argument : id des SRC cibles au format GeodeticCRSid.VerticalCRSid",
    L"Argument : id des transfos requises au format idGeodeticTransfo.idVerticalTransfo",
    L"Suivi des valeurs des transformations",
-   L"Argument : format et unite source au format FormatId.LinearUnit.AngularUnit",
-   L"Argument : format et unite cible au format FormatId.LinearUnit.AngularUnit",
+   L"Argument : format et unite source au format FormatId.LinearUnit.AngularUnit[.BINARY]",
+   L"Argument : format et unite cible au format FormatId.LinearUnit.AngularUnit[.BINARY]",
    L"Argument : Epoque source en annee decimale",
    L"Argument : Epoque cible en annee decimale",
-   L"Argument : Chemin complet du fichier source",
-   L"Argument : Chemin complet du fichier cible",
+   L"Argument : Chemin complet du fichier source (- pour l'entrée standard)",
+   L"Argument : Chemin complet du fichier cible (- pour la sortie standard)",
    L"Lancer les tests",
    L"Traiter les SRC multiples",
    L"Silencieux",
@@ -227,7 +229,11 @@ static const std::wstring OptionsHelpText[OH_COUNT] =
    L"Obtenir une liste coherente de SRC verticaux cibles au format id:text,id:text,",
    L"Ecrire les DMS en clair, pas sous forme decimale",
    L"Ne pas afficher le facteur d'échelle en PPM",
-   L"Séparateur de champs"
+   L"Séparateur de champs",
+   L"Argument : Tolérance en mètres du mode approché (interpolé) rapide, contrôlée sur un échantillon de points de chaque cellule (estimation, non une borne stricte), 0 pour un calcul exact",
+   L"Calculer au chargement les grilles inverses, afin d'appliquer les grilles en sens inverse avec une seule interpolation",
+   L"Argument : Nombre de threads traitant un fichier (0 pour le nombre de coeurs, 1 par défaut)",
+   L"Traiter et écrire chaque ligne d'un fichier dès sa lecture (flux)"
 };
 
 // for user-friendly HMI purposes, all and only angular units between MU_UNDEF and MU_METER
@@ -321,7 +327,9 @@ static const std::string uiFormatText[UF_COUNT] =
 #endif
     "NMEA points",
     "KML points",
-    "GPX points"
+    "GPX points",
+    "GeoJSON",
+    "GeoJSON text sequence"
 };
 
 static const std::string InterfaceElementText[IE_END] =
@@ -86,10 +86,18 @@ CatOperation::CatOperation(const CatOperation &B) : CirceObject(B)
     sourceAngularUnitId = B.sourceAngularUnitId;
     targetLinearUnitId = B.targetLinearUnitId;
     targetAngularUnitId = B.targetAngularUnitId;
+    sourceAngularToRadian = B.sourceAngularToRadian;
+    radianToTargetAngular = B.radianToTargetAngular;
+    radianToSecond = B.radianToSecond;
     sourceEpoch = B.sourceEpoch;
     targetEpoch = B.targetEpoch;
     operationOutput = B.operationOutput;
     extraOut = B.extraOut;
+    bHelmertFused = B.bHelmertFused;
+    bHelmertStepDone = B.bHelmertStepDone;
+    for (int k = 0; k < 12; k++) FusedHelmertMatrix[k] = B.FusedHelmertMatrix[k];
+    FusedTargetEC = B.FusedTargetEC;
+    vFusedGeodeticTransfo = B.vFusedGeodeticTransfo;
 }
 
 /**
@@ -123,9 +131,15 @@ void CatOperation::reset()
     SourceGeodeticCRS = TargetGeodeticCRS = SourceVerticalCRS = TargetVerticalCRS = NULL;
     operationMessage = OM_OK;
     sourceLinearUnitId = sourceAngularUnitId = targetLinearUnitId = targetAngularUnitId = MU_UNDEF;
+    InitUnitConversion(MU_UNDEF, MU_UNDEF, &sourceAngularToRadian);
+    InitUnitConversion(MU_UNDEF, MU_UNDEF, &radianToTargetAngular);
+    InitUnitConversion(MU_RADIAN, MU_SECOND, &radianToSecond);
     sourceEpoch = targetEpoch = 0.;
     operationOutput = "";
     extraOut = false;
+    bHelmertFused = bHelmertStepDone = false;
+    for (int k = 0; k < 12; k++) FusedHelmertMatrix[k] = 0.;
+    vFusedGeodeticTransfo.clear();
 }
 
 /**
@@ -780,6 +794,8 @@ void CatOperation::Init(const circeOptions &circopt, GeodeticSet& GS)
         sourceAngularUnitId = (MEASURE_UNIT)getIndex(circopt.sourceOptions.angularUnit,MeasureUnitAttributeText,MU_COUNT);
         targetLinearUnitId = (MEASURE_UNIT)getIndex(circopt.targetOptions.linearUnit,MeasureUnitAttributeText,MU_COUNT);
         targetAngularUnitId = (MEASURE_UNIT)getIndex(circopt.targetOptions.angularUnit,MeasureUnitAttributeText,MU_COUNT);
+        InitUnitConversion(sourceAngularUnitId, MU_RADIAN, &sourceAngularToRadian);
+        InitUnitConversion(MU_RADIAN, targetAngularUnitId, &radianToTargetAngular);
 
         //CRSs
         if (/*circopt.sourceOptions.useGeodeticCRS &&*/ circopt.sourceOptions.geodeticCRSid != "")
@@ -877,15 +893,24 @@ void CatOperation::Init(const circeOptions &circopt, GeodeticSet& GS)
             noTargetVertical = true;
 
         //Initialization of noSourceEllHeight and noTargetEllHeight.
-        //This works only for basic formats ('H' included or not).
-        if (circopt.sourceOptions.subformatId == FF_BASIC && hasEllHeight(circopt.sourceOptions.formatId))
+        //This works only for basic (and binary) formats ('H' included or not).
+        //The third value of a GeoJSON position is an ellipsoidal height unless a vertical CRS is given.
+        if ((circopt.sourceOptions.subformatId == FF_BASIC || circopt.sourceOptions.subformatId == FF_BINARY)
+            && hasEllHeight(circopt.sourceOptions.formatId))
 //         || SourceGeodeticFrame->getSystemDimension() == SD_3D)
             noSourceEllHeight = false;
+        else if ((circopt.sourceOptions.subformatId == FF_GEOJSON || circopt.sourceOptions.subformatId == FF_GEOJSONSEQ)
+                 && noSourceVertical)
+            noSourceEllHeight = false;
         else
             noSourceEllHeight = true;
-        if (circopt.targetOptions.subformatId == FF_BASIC && hasEllHeight(circopt.targetOptions.formatId))
+        if ((circopt.targetOptions.subformatId == FF_BASIC || circopt.targetOptions.subformatId == FF_BINARY)
+            && hasEllHeight(circopt.targetOptions.formatId))
 //         || TargetGeodeticFrame->getSystemDimension() != SD_2D)
             noTargetEllHeight = false;
+        else if ((circopt.targetOptions.subformatId == FF_GEOJSON || circopt.targetOptions.subformatId == FF_GEOJSONSEQ)
+                 && noTargetVertical)
+            noTargetEllHeight = false;
         else
             noTargetEllHeight = true;
 
@@ -969,6 +994,13 @@ void CatOperation::Init(const circeOptions &circopt, GeodeticSet& GS)
 //            itT->setRateFactor(asString(targetEpoch-sourceEpoch));
         }
 
+		//Inverse grids: derived once the application direction and the epochs are known.
+		if (circopt.inverseGrids)
+		{
+			for (itT=vRelevantGeodeticTransfo.begin();itT<vRelevantGeodeticTransfo.end();itT++)
+				itT->InitInverseGrid();
+		}
+
 		//Initialize Geodetic Coordinate Types
 		if (TransfoRequired&T_GEODETIC_REQUIRED)
 		{
@@ -1096,6 +1128,49 @@ std::string CatOperation::followUpTransfos()
 	return str;
 }
 
+/**
+* \brief Accumulates the iteration counts of the grid solver (F_TARGET grids) of the geodetic transformations.
+* \param[in,out] histogram: histogram[n] is incremented by the number of points solved with n interpolations.
+*/
+void CatOperation::getIterationHistogram(std::vector<unsigned int> *histogram) const
+{
+    for (std::vector<Transformation>::const_iterator itT=vRelevantGeodeticTransfo.begin();itT!=vRelevantGeodeticTransfo.end();itT++)
+    {
+        std::vector<unsigned int> h = itT->getIterationHistogram();
+        if (histogram->size() < h.size())
+            histogram->resize(h.size(), 0);
+        for (unsigned int i=0; i<h.size(); i++)
+            (*histogram)[i] += h[i];
+    }
+}
+
+/**
+* \brief Resets the warm start of the grid solver (F_TARGET grids) of the geodetic transformations,
+* so that the next point is operated regardless of the previous ones.
+*/
+void CatOperation::resetWarmStart()
+{
+    for (std::vector<Transformation>::iterator itT=vRelevantGeodeticTransfo.begin();itT!=vRelevantGeodeticTransfo.end();itT++)
+        itT->resetWarmStart();
+}
+
+/**
+* \brief Gathers the round-trip residuals of the inverse grids of the geodetic transformations.
+* \param[in,out] residual: the maximum residual (meters).
+* \param[in,out] count: incremented by the number of inverse grids.
+*/
+void CatOperation::getInverseResidual(double *residual, int *count) const
+{
+    for (std::vector<Transformation>::const_iterator itT=vRelevantGeodeticTransfo.begin();itT!=vRelevantGeodeticTransfo.end();itT++)
+    {
+        if (!itT->hasInverseGrid())
+            continue;
+        (*count)++;
+        if (itT->getInverseResidual() > *residual)
+            *residual = itT->getInverseResidual();
+    }
+}
+
 /**
 * \brief Writes the names of the vertical grids actually used to perform the operation.
 * \return A std::string containing the names of the vertical grids actually used to perform the operation.
@@ -1184,6 +1259,72 @@ std::string CatOperation::displayDescription(const circeOptions &circopt, std::s
     return str;
 }
 
+/**
+* \brief Checks whether the geodetic transformation is a single constant Helmert transformation
+* (3, 7 or 14 parameters, plate motion models excepted) with no vertical transformation, so that
+* it can be fused with the neighbouring steps of a CompoundOperation.
+* \return true if this CatOperation is such a step.
+*/
+bool CatOperation::isHelmertStep() const
+{
+    if (operationMessage != OM_OK || TransfoRequired != T_GEODETIC_REQUIRED || FollowUpTransfos != 0
+     || TargetCRStype1 != CT_GEOCENTRIC || sourceMeridianTranslation != 0. || targetMeridianTranslation != 0.
+     || vRelevantGeodeticTransfo.size() != 1)
+        return false;
+    const Transformation &T = vRelevantGeodeticTransfo[0];
+    //A plate motion model erases its vertical shift, so it isn't a Helmert transformation.
+    return T.getLayout() == L_CONSTANT && T.getIGNid().substr(0,3) != std::string("PMM")
+        && (T.getValuesNumber() == 3 || T.getValuesNumber() == 7 || T.getValuesNumber() == 14);
+}
+
+/**
+* \brief Appends the Helmert transformation of the next step CO (see isHelmertStep) to the geodetic
+* transformation of this CatOperation, which then outputs coordinates in the target frame of CO
+* (expressed in its own target CRS). CO must then skip its geodetic transformation
+* (see setbHelmertStepDone). The boundaries of the transformation of CO are checked with the
+* coordinates of this step.
+* \param[in] CO: Pointer to the next CatOperation.
+*/
+void CatOperation::fuseHelmertStep(CatOperation *CO)
+{
+    if (!bHelmertFused)
+    {
+        const double *M = vRelevantGeodeticTransfo[0].getHelmertMatrix();
+        for (int k = 0; k < 12; k++) FusedHelmertMatrix[k] = M[k];
+        vFusedGeodeticTransfo.clear();
+        bHelmertFused = true;
+    }
+    HelmertCompose(CO->vRelevantGeodeticTransfo[0].getHelmertMatrix(), FusedHelmertMatrix, FusedHelmertMatrix);
+    FusedTargetEC = CO->getTargetConversion()->getEllipsoidContext();
+    vFusedGeodeticTransfo.push_back(CO->vRelevantGeodeticTransfo[0]);
+}
+
+/**
+* \brief Gets the parameters of the geodetic transformations that depend on the epochs, including
+* the fused Helmert matrix (see fuseHelmertStep).
+* \param[out] values: Pointer to the vector receiving the parameters.
+*/
+void CatOperation::getEpochParameters(std::vector<double> *values) const
+{
+    values->clear();
+    for (std::vector<Transformation>::const_iterator itT=vRelevantGeodeticTransfo.begin(); itT<vRelevantGeodeticTransfo.end(); itT++)
+        itT->getEpochParameters(values);
+    values->insert(values->end(), FusedHelmertMatrix, FusedHelmertMatrix+12);
+}
+
+/**
+* \brief Sets the parameters of the geodetic transformations that depend on the epochs, as
+* returned by getEpochParameters for the same operation at another epoch. The loaded grids are kept.
+* \param[in] values: The parameters.
+*/
+void CatOperation::setEpochParameters(const std::vector<double> &values)
+{
+    const double *v = values.data();
+    for (std::vector<Transformation>::iterator itT=vRelevantGeodeticTransfo.begin(); itT<vRelevantGeodeticTransfo.end(); itT++)
+        v = itT->setEpochParameters(v);
+    for (int k = 0; k < 12; k++) FusedHelmertMatrix[k] = v[k];
+}
+
 /**
 * \brief Operates a pt4d from the source CRS to the target CRS.
 * \param p1 (input and output): Pointer to the pt4d to be operated.
@@ -1216,6 +1357,7 @@ OPERATION_MESSAGE CatOperation::Operate(pt4d*p1)
         CRS_TYPE CurrentCRStype = this->CurrentCRStype;
         p1->CRStypeInit = CurrentCRStype;
         p2.id = p1->id;
+        p2.t = p1->t;
 		p2.frmt.n_ang = p1->frmt.n_ang;
 		p2.frmt.n_m = p1->frmt.n_m;
         p2.transfoIndex = p1->transfoIndex;
@@ -1228,8 +1370,8 @@ OPERATION_MESSAGE CatOperation::Operate(pt4d*p1)
             if (!(checkDefinitionDomain(p1->l, CurrentCRStype, sourceAngularUnitId))
              || !(checkDefinitionDomain(p1->p, CurrentCRStype, sourceAngularUnitId)))
                 return OM_POINT_OUTSIDE_CRS_TYPE_DOMAIN;
-            p1->l = UnitConvert(p1->l, sourceAngularUnitId, MU_RADIAN);
-            p1->p = UnitConvert(p1->p, sourceAngularUnitId, MU_RADIAN);
+            p1->l = UnitConvert(p1->l, sourceAngularToRadian);
+            p1->p = UnitConvert(p1->p, sourceAngularToRadian);
         }
         else if (CurrentCRStype == CT_PROJECTED)
         {
@@ -1245,8 +1387,7 @@ OPERATION_MESSAGE CatOperation::Operate(pt4d*p1)
             if (!(checkDefinitionDomain(pow(p1->x,2)+pow(p1->y,2)+pow(p1->z,2), CurrentCRStype, sourceLinearUnitId)))
                 return OM_POINT_OUTSIDE_CRS_TYPE_DOMAIN;
             //Geocentric=>Geographic
-            CartGeo56(p1->x,p1->y,p1->z,SourceConversion->get_a(),
-                                        SourceConversion->get_e2(),&p1->l,&p1->p,&p1->h);
+            CartGeo(SourceConversion->getEllipsoidContext(),p1->x,p1->y,p1->z,&p1->l,&p1->p,&p1->h);
 //            p1->l += sourceMeridianTranslation; //non-zero if (TransfoRequired)
             if (TargetCRStype1 != CT_GEOCENTRIC)
             {
@@ -1267,8 +1408,8 @@ OPERATION_MESSAGE CatOperation::Operate(pt4d*p1)
         {
             if (targetAngularUnitId != MU_UNDEF)
             {
-                p1->l = UnitConvert(p1->l, MU_RADIAN, targetAngularUnitId);
-                p1->p = UnitConvert(p1->p, MU_RADIAN, targetAngularUnitId);
+                p1->l = UnitConvert(p1->l, radianToTargetAngular);
+                p1->p = UnitConvert(p1->p, radianToTargetAngular);
             }
             return OM_POINT_OUTSIDE_SOURCE_GEODETIC_CRS;
         }
@@ -1284,8 +1425,8 @@ OPERATION_MESSAGE CatOperation::Operate(pt4d*p1)
         {
             if (targetAngularUnitId != MU_UNDEF)
             {
-                p1->l = UnitConvert(p1->l, MU_RADIAN, targetAngularUnitId);
-                p1->p = UnitConvert(p1->p, MU_RADIAN, targetAngularUnitId);
+                p1->l = UnitConvert(p1->l, radianToTargetAngular);
+                p1->p = UnitConvert(p1->p, radianToTargetAngular);
             }
             return OM_POINT_OUTSIDE_TARGET_GEODETIC_CRS_IN_SOURCE_GEODETIC_FRAME;
         }
@@ -1320,7 +1461,9 @@ OPERATION_MESSAGE CatOperation::Operate(pt4d*p1)
         {
             //Geographic=>Geocentric
 //            p1->l += sourceMeridianTranslation; //non-zero if (TransfoRequired) [no]
-            GeoCart(SourceConversion->get_a(), SourceConversion->get_e2(),
+            //If the geodetic transformation was done by the previous step, the coordinates are
+            //already in the target frame.
+            GeoCart(bHelmertStepDone ? TargetConversion->getEllipsoidContext() : SourceConversion->getEllipsoidContext(),
                     p1->l,p1->p,p1->h,&p1->x,&p1->y,&p1->z);
             CurrentCRStype = CT_GEOCENTRIC;
         }
@@ -1347,7 +1490,33 @@ OPERATION_MESSAGE CatOperation::Operate(pt4d*p1)
             //transformation at the geocentric level will calculate target geographic coordinates
             //for grid interpolation. They are saved here to avoid a new calculation in case of a
             //grid interpolation (irrelevant if the transformation is constant).
-            if (TargetCRStype1 == CT_GEOCENTRIC)
+            if (TargetCRStype1 == CT_GEOCENTRIC && bHelmertStepDone)
+            {
+                p2.x = p1->x; p2.y = p1->y; p2.z = p1->z;
+                p2.l = p1->l; p2.p = p1->p; p2.h = p1->h;
+                p2.Gprec = vRelevantGeodeticTransfo[0].getPrecisionCodeInit();
+                bGeocentricCoordOK = true;
+            }
+            else if (TargetCRStype1 == CT_GEOCENTRIC && bHelmertFused)
+            {
+                //Consecutive Helmert transformations in a single matrix (see fuseHelmertStep)
+                om = OM_OK;
+                if (!vRelevantGeodeticTransfo[0].isInside(p1->l,p1->p))
+                    om = OM_GEODETIC_TRANSFO_NOT_FOUND_FOR_THIS_POINT;
+                for (std::vector<Transformation>::const_iterator itT=vFusedGeodeticTransfo.begin();itT!=vFusedGeodeticTransfo.end();itT++)
+                    if (!itT->isInside(p1->l,p1->p))
+                        om = OM_GEODETIC_TRANSFO_NOT_FOUND_FOR_THIS_POINT;
+                if (om != OM_OK)
+                {
+                    copyPt4d(p1, p2);
+                    return om;
+                }
+                HelmertCart(FusedHelmertMatrix,p1->x,p1->y,p1->z,&p2.x,&p2.y,&p2.z);
+                p2.Gprec = vRelevantGeodeticTransfo[0].getPrecisionCodeInit();
+                bGeocentricCoordOK = true;
+                CartGeo(FusedTargetEC,p2.x,p2.y,p2.z,&p2.l,&p2.p,&p2.h);
+            }
+            else if (TargetCRStype1 == CT_GEOCENTRIC)
             {
                 om = Transformation::ApplyGeodeticTransformation(p1->l,p1->p,p1->h,p1->x,p1->y,p1->z,
                                             &p2.l,&p2.p,&p2.h,&p2.x,&p2.y,&p2.z,
@@ -1363,8 +1532,7 @@ OPERATION_MESSAGE CatOperation::Operate(pt4d*p1)
                     bGeocentricCoordOK = false;
                 //always need CT_GEOGRAPHIC at least to check isInside()
                 //Geocentric=>Geographic
-                CartGeo56(p2.x,p2.y,p2.z,TargetConversion->get_a(),
-                                                TargetConversion->get_e2(),&p2.l,&p2.p,&p2.h);
+                CartGeo(TargetConversion->getEllipsoidContext(),p2.x,p2.y,p2.z,&p2.l,&p2.p,&p2.h);
             }
             else if (TargetCRStype1 == CT_GEOGRAPHIC)
             {
@@ -1384,8 +1552,8 @@ OPERATION_MESSAGE CatOperation::Operate(pt4d*p1)
             {
                 if (targetAngularUnitId != MU_UNDEF)
                 {
-                    p2.l = UnitConvert(p2.l, MU_RADIAN, targetAngularUnitId);
-                    p2.p = UnitConvert(p2.p, MU_RADIAN, targetAngularUnitId);
+                    p2.l = UnitConvert(p2.l, radianToTargetAngular);
+                    p2.p = UnitConvert(p2.p, radianToTargetAngular);
                 }
                 copyPt4d(p1, p2);
                 return OM_POINT_OUTSIDE_TARGET_GEODETIC_CRS_IN_TARGET_GEODETIC_FRAME;
@@ -1422,7 +1590,7 @@ OPERATION_MESSAGE CatOperation::Operate(pt4d*p1)
             {
                 //Geographic=>Geocentric
                 if (!bGeocentricCoordOK)
-                    GeoCart(TargetConversion->get_a(), TargetConversion->get_e2(),
+                    GeoCart(TargetConversion->getEllipsoidContext(),
                         p2.l,p2.p,p2.h,&p2.x,&p2.y,&p2.z);
                 CurrentCRStype = CT_GEOCENTRIC;
             }
@@ -1457,15 +1625,15 @@ OPERATION_MESSAGE CatOperation::Operate(pt4d*p1)
             p2.CRStypeInit = CurrentCRStype;
             if (targetAngularUnitId != MU_UNDEF)
             {
-                p2.l = UnitConvert(p2.l, MU_RADIAN, targetAngularUnitId);
-                p2.p = UnitConvert(p2.p, MU_RADIAN, targetAngularUnitId);
+                p2.l = UnitConvert(p2.l, radianToTargetAngular);
+                p2.p = UnitConvert(p2.p, radianToTargetAngular);
             }
             if (TargetConversion->getbCalcScaleConv())
             {
-                p2.conv = UnitConvert(p2.conv, MU_RADIAN, targetAngularUnitId);
+                p2.conv = UnitConvert(p2.conv, radianToTargetAngular);
             }
-            p2.xi = UnitConvert(p2.xi, MU_RADIAN, MU_SECOND);
-            p2.eta = UnitConvert(p2.eta, MU_RADIAN, MU_SECOND);
+            p2.xi = UnitConvert(p2.xi, radianToSecond);
+            p2.eta = UnitConvert(p2.eta, radianToSecond);
             //Define TargetGeodeticFrame->setSystemDimension("3D") (from the metadata)
             //somewhere if you really need the ellipsoidal height.
             if (noTargetEllHeight)
@@ -1481,15 +1649,15 @@ OPERATION_MESSAGE CatOperation::Operate(pt4d*p1)
             p1->CRStypeInit = CurrentCRStype;
             if (targetAngularUnitId != MU_UNDEF)
             {
-                p1->l = UnitConvert(p1->l, MU_RADIAN, targetAngularUnitId);
-                p1->p = UnitConvert(p1->p, MU_RADIAN, targetAngularUnitId);
+                p1->l = UnitConvert(p1->l, radianToTargetAngular);
+                p1->p = UnitConvert(p1->p, radianToTargetAngular);
             }
             if (TargetConversion->getbCalcScaleConv())
             {
-                p1->conv = UnitConvert(p1->conv, MU_RADIAN, targetAngularUnitId);
+                p1->conv = UnitConvert(p1->conv, radianToTargetAngular);
             }
-            p1->xi = UnitConvert(p1->xi, MU_RADIAN, MU_SECOND);
-            p1->eta = UnitConvert(p1->eta, MU_RADIAN, MU_SECOND);
+            p1->xi = UnitConvert(p1->xi, radianToSecond);
+            p1->eta = UnitConvert(p1->eta, radianToSecond);
             //Define TargetGeodeticFrame->setSystemDimension("3D") (from the metadata)
             //somewhere if you really need the ellipsoidal height.
             if (noTargetEllHeight)
@@ -1506,5 +1674,245 @@ OPERATION_MESSAGE CatOperation::Operate(pt4d*p1)
     return OM_OK;
 }
 
+/**
+* \brief Checks whether the points can be operated by OperateMany, that is whether the operation is
+* made of conversions, unit changes and at most a constant Helmert transformation (see isHelmertStep),
+* without vertical transformation, meridian translation nor transformation follow-up.
+* \return true if OperateMany applies.
+*/
+bool CatOperation::isBatchable() const
+{
+    if (operationMessage != OM_OK || FollowUpTransfos != 0 || (TransfoRequired & ~T_GEODETIC_REQUIRED) != 0
+     || sourceMeridianTranslation != 0. || targetMeridianTranslation != 0.)
+        return false;
+    if (CurrentCRStype != CT_GEOGRAPHIC && CurrentCRStype != CT_PROJECTED && CurrentCRStype != CT_GEOCENTRIC)
+        return false;
+    return !(TransfoRequired&T_GEODETIC_REQUIRED) || isHelmertStep();
+}
+
+/**
+* \brief Moves the values of rank k to rank m in the arrays of a batch (see CatOperation::OperateMany).
+* \param a: The arrays.
+* \param[in] na: The number of arrays.
+* \param[in] k, m: The ranks.
+*/
+static void moveBatchValues(double *const *a, unsigned int na, unsigned int k, unsigned int m)
+{
+    for (unsigned int j=0; j<na; j++)
+        a[j][m] = a[j][k];
+}
+
+/**
+* \brief Operates np pt4dc from the source CRS to the target CRS with the same results as Operate
+* (see isBatchable), each step being applied to OperateManyBatchSize points at a time with the batch
+* kernels (UnitConvertMany, ApplyInvMany, CartGeoMany, GeoCartMany, ApplyMany).
+* \param[in] np: The number of points.
+* \param vp (input and output): The pt4dc to be operated.
+* \param ok (input and output): On input, non-zero for the points to be operated. On output, non-zero
+* for the points operated; the other ones are left unchanged, and Operate returns their error message.
+*/
+void CatOperation::OperateMany(unsigned int np, pt4dc *vp, char *ok)
+{
+    const unsigned int nb = OperateManyBatchSize, na = 10;
+    unsigned int idx[nb], i, i0, k, m, n;
+    double u[nb], v[nb], l[nb], p[nb], h[nb], x[nb], y[nb], z[nb], e[nb], nn[nb], conv[nb], scfact[nb];
+    double *const a[na] = {l, p, h, x, y, z, e, nn, conv, scfact};
+    if (!isBatchable())
+    {
+        for (i=0; i<np; i++)
+            ok[i] = 0;
+        return;
+    }
+    bool bGeodetic = (TransfoRequired&T_GEODETIC_REQUIRED) != 0;
+    bool bSourceScaleConv = SourceConversion->getbCalcScaleConv();
+    bool bTargetScaleConv = TargetConversion->getbCalcScaleConv();
+    for (i0=0; i0<np; i0+=nb)
+    {
+        CRS_TYPE ct = CurrentCRStype;
+        //Points within the definition domain
+        n = 0;
+        for (i=i0; i<np && i<i0+nb; i++)
+        {
+            if (!ok[i])
+                continue;
+            const pt4dc &pc = vp[i];
+            if (ct == CT_GEOGRAPHIC)
+                ok[i] = checkDefinitionDomain(pc.l, ct, sourceAngularUnitId)
+                     && checkDefinitionDomain(pc.p, ct, sourceAngularUnitId);
+            else if (ct == CT_PROJECTED)
+                ok[i] = checkDefinitionDomain(pc.e, ct, sourceLinearUnitId)
+                     && checkDefinitionDomain(pc.n, ct, sourceLinearUnitId);
+            else
+                ok[i] = checkDefinitionDomain(pow(pc.x,2)+pow(pc.y,2)+pow(pc.z,2), ct, sourceLinearUnitId);
+            if (!ok[i])
+                continue;
+            idx[n] = i;
+            u[n] = ct == CT_GEOGRAPHIC ? pc.l : pc.e;
+            v[n] = ct == CT_GEOGRAPHIC ? pc.p : pc.n;
+            h[n] = noSourceEllHeight ? pc.w : pc.h;
+            x[n] = pc.x;
+            y[n] = pc.y;
+            z[n] = pc.z;
+            e[n] = pc.e;
+            nn[n] = pc.n;
+            conv[n] = pc.conv;
+            scfact[n] = pc.scfact;
+            n++;
+        }
+
+        //Source geographic coordinates
+        if (ct == CT_GEOGRAPHIC)
+        {
+            UnitConvertMany(n, u, l, sourceAngularToRadian);
+            UnitConvertMany(n, v, p, sourceAngularToRadian);
+        }
+        else if (ct == CT_PROJECTED)
+        {
+            if (bSourceScaleConv)
+                SourceConversion->ApplyInvMany(n, u, v, l, p, conv, scfact);
+            else
+            {
+                SourceConversion->ApplyInvMany(n, u, v, l, p, NULL, NULL);
+                for (k=0; k<n; k++)
+                    conv[k] = scfact[k] = 0.;
+            }
+            ct = CT_GEOGRAPHIC;
+        }
+        else
+        {
+            CartGeoMany(SourceConversion->getEllipsoidContext(), n, x, y, z, l, p, h);
+            if (TargetCRStype1 != CT_GEOCENTRIC)
+                ct = CT_GEOGRAPHIC;
+        }
+
+        //Boundaries of the CRS and of the geodetic transformation
+        m = 0;
+        for (k=0; k<n; k++)
+        {
+            bool inside = SourceGeodeticCRS->isInside(l[k],p[k]);
+            if (inside && !bGeodetic)
+                inside = TargetGeodeticCRS->isInside(l[k],p[k]);
+            else if (inside && !bHelmertStepDone)
+            {
+                inside = vRelevantGeodeticTransfo[0].isInside(l[k],p[k]);
+                for (std::vector<Transformation>::const_iterator itT=vFusedGeodeticTransfo.begin();inside && itT!=vFusedGeodeticTransfo.end();itT++)
+                    inside = itT->isInside(l[k],p[k]);
+            }
+            if (!inside)
+            {
+                ok[idx[k]] = 0;
+                continue;
+            }
+            idx[m] = idx[k];
+            moveBatchValues(a, na, k, m++);
+        }
+        n = m;
+
+        if (ct == CT_GEOGRAPHIC && TargetCRStype1 == CT_GEOCENTRIC)
+        {
+            GeoCartMany(bHelmertStepDone ? TargetConversion->getEllipsoidContext() : SourceConversion->getEllipsoidContext(),
+                        n, l, p, h, x, y, z);
+            ct = CT_GEOCENTRIC;
+        }
+        else if (ct == CT_GEOGRAPHIC && TargetCRStype1 == CT_PROJECTED)
+        {
+            if (bTargetScaleConv)
+                TargetConversion->ApplyMany(n, l, p, e, nn, conv, scfact);
+            else
+            {
+                TargetConversion->ApplyMany(n, l, p, e, nn, NULL, NULL);
+                for (k=0; k<n; k++)
+                    conv[k] = scfact[k] = 0.;
+            }
+            ct = CT_PROJECTED;
+        }
+        if (ct != TargetCRStype1)
+        {
+            //shouldn't occur: left to Operate
+            for (k=0; k<n; k++)
+                ok[idx[k]] = 0;
+            n = 0;
+        }
+
+        //Helmert transformation and target geographic coordinates
+        if (bGeodetic)
+        {
+            if (!bHelmertStepDone)
+            {
+                const double *M = bHelmertFused ? FusedHelmertMatrix : vRelevantGeodeticTransfo[0].getHelmertMatrix();
+                for (k=0; k<n; k++)
+                    HelmertCart(M, x[k], y[k], z[k], x+k, y+k, z+k);
+                CartGeoMany(bHelmertFused ? FusedTargetEC : TargetConversion->getEllipsoidContext(), n, x, y, z, l, p, h);
+            }
+            m = 0;
+            for (k=0; k<n; k++)
+            {
+                if (!TargetGeodeticCRS->isInside(l[k],p[k]))
+                {
+                    ok[idx[k]] = 0;
+                    continue;
+                }
+                idx[m] = idx[k];
+                moveBatchValues(a, na, k, m++);
+            }
+            n = m;
+            for (k=0; k<n; k++)
+                e[k] = nn[k] = conv[k] = scfact[k] = 0.;
+            ct = CT_GEOGRAPHIC;
+            if (TargetCRStype2 == CT_GEOCENTRIC)
+                ct = CT_GEOCENTRIC;
+            else if (TargetCRStype2 == CT_PROJECTED)
+            {
+                TargetConversion->ApplyMany(n, l, p, e, nn, bTargetScaleConv ? conv : NULL, bTargetScaleConv ? scfact : NULL);
+                ct = CT_PROJECTED;
+            }
+            if (ct != TargetCRStype2)
+            {
+                for (k=0; k<n; k++)
+                    ok[idx[k]] = 0;
+                n = 0;
+            }
+        }
+
+        //Target units
+        if (targetAngularUnitId != MU_UNDEF)
+        {
+            UnitConvertMany(n, l, l, radianToTargetAngular);
+            UnitConvertMany(n, p, p, radianToTargetAngular);
+        }
+        if (bTargetScaleConv)
+            UnitConvertMany(n, conv, conv, radianToTargetAngular);
+        for (k=0; k<n; k++)
+        {
+            pt4dc &pc = vp[idx[k]];
+            pc.x = x[k];
+            pc.y = y[k];
+            pc.z = z[k];
+            pc.l = l[k];
+            pc.p = p[k];
+            pc.h = noTargetEllHeight ? 0. : h[k];
+            pc.e = e[k];
+            pc.n = nn[k];
+            pc.conv = conv[k];
+            pc.scfact = scfact[k];
+            pc.CRStypeInit = ct;
+            if (bGeodetic)
+            {
+                pc.xi = pc.eta = 0.;
+                pc.Gprec = vRelevantGeodeticTransfo[0].getPrecisionCodeInit();
+                if (noTargetVertical)
+                    pc.Vprec = 0;
+            }
+            else
+            {
+                pc.xi = UnitConvert(pc.xi, radianToSecond);
+                pc.eta = UnitConvert(pc.eta, radianToSecond);
+            }
+            if (noTargetVertical)
+                pc.w = 0.;
+        }
+    }
+}
+
 
 }  //namespace circe
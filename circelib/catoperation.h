@@ -63,6 +63,11 @@ static double definitionDomain[CT_COUNT][MU_COUNT][2] =
     { { 0, 0 }, { 0, 0 }, { 0, 0 }, { 0, 0 }, { 0, 0 }, { 0, 0 }, { 0, 0 }, { -1e12, 1e12 }, { 0, 0 }, { 0, 0 }, { 0, 0 }, { 0, 0 } }
 };
 
+/**
+* \brief Number of points operated together by CatOperation::OperateMany (size of its scratch arrays).
+*/
+static const unsigned int OperateManyBatchSize = 256;
+
 /**
 * \brief This class is used by CompoundOperation
 * to initialize and apply a concatenation of operations.
@@ -86,9 +91,14 @@ private:
     CRS* TargetVerticalCRS;
     OPERATION_MESSAGE operationMessage;
     MEASURE_UNIT sourceLinearUnitId, sourceAngularUnitId, targetLinearUnitId, targetAngularUnitId;
+    unitConversion sourceAngularToRadian, radianToTargetAngular, radianToSecond;
     double sourceEpoch, targetEpoch;
     std::string operationOutput;
     bool extraOut;
+    bool bHelmertFused, bHelmertStepDone;
+    double FusedHelmertMatrix[12];
+    ellipsoidContext FusedTargetEC;
+    std::vector<Transformation> vFusedGeodeticTransfo;
 
 	static bool IsTransfoMatching(std::vector<Transformation>::iterator itT, std::string id1u, std::string id2u, std::string *idG, CRS_TYPE ct);
 	static Conversion* InitConversion(CRS* geodeticCRS);
@@ -103,6 +113,8 @@ public:
     void Init(const circeOptions &circopt, GeodeticSet& GS);
     void reset();
     OPERATION_MESSAGE Operate(pt4d*p1);
+    bool isBatchable() const;
+    void OperateMany(unsigned int np, pt4dc *vp, char *ok);
 	int  getTransfoRequired() const { return TransfoRequired; }
 	int  getFollowUpTransfos() const { return FollowUpTransfos; }
 	std::vector<Transformation> getvRelevantGeodeticTransfo() const { return vRelevantGeodeticTransfo; }
@@ -139,9 +151,19 @@ public:
     double gettargetEpoch() const {return targetEpoch;}
     std::string getoperationOutput() const {return operationOutput;}
     std::string followUpTransfos();
+    void getIterationHistogram(std::vector<unsigned int> *histogram) const;
+    void getInverseResidual(double *residual, int *count) const;
+    void resetWarmStart();
     std::string getVerticalGridNames();
     std::string displayDescription(const circeOptions &circopt, std::string what);
     bool getextraOut() const {return extraOut;}
+    bool isHelmertStep() const;
+    void fuseHelmertStep(CatOperation *CO);
+    void getEpochParameters(std::vector<double> *values) const;
+    void setEpochParameters(const std::vector<double> &values);
+    bool getbHelmertFused() const {return bHelmertFused;}
+    bool getbHelmertStepDone() const {return bHelmertStepDone;}
+    void setbHelmertStepDone(bool _value) {bHelmertStepDone=_value;}
 
     void setoperationMessage(OPERATION_MESSAGE _value) {operationMessage=_value;}
 
@@ -41,6 +41,11 @@ Author:
 #include <vector>
 #include <iomanip> //setprecision
 #include <limits> //numeric_limits
+#include <thread> //process_lattice, ChunkPool
+#include <mutex>
+#include <condition_variable>
+#include <deque>
+#include <memory> //unique_ptr
 #include <sys/stat.h>
 /*#ifdef UNIX
 #include <unistd.h> //getcwd,chdir
@@ -51,6 +56,7 @@ Author:
 #include "parser.h"
 #include "metadata.h"
 #include "files.h"
+#include "compressedstream.h"
 #include "pt4d.h"
 #ifdef WITH_GDAL
 #include "../dependances/gdal/circe_ogr.h"
@@ -63,6 +69,8 @@ Author:
 #elif defined WIN32
 #define NOMINMAX //to avoid collision with std::numeric_limits<std::streamsize>::max()
 #include <windows.h> //InitZoneList()
+#include <io.h> //_setmode
+#include <fcntl.h> //_O_BINARY
 #endif
 
 /**\brief The purpose of namespace circe is the application of operations (conversions and transformations) on sets of single points.*/
@@ -295,6 +303,483 @@ void process_vector_pt4d(circeOptions circopt, std::vector<circe::pt4d>* vPt4d,
     fo.close();
 }
 
+/**
+* \brief Processes a vector of pt4dc (compact points).
+* \param[in] circopt: Processing options in a circeOptions structure.
+* \param[in] vPt4dc: A pointer to the vector of pt4dc, which is also output. The index member of each
+point is set to its rank in the vector and its om member to the resulting OPERATION_MESSAGE.
+* \param[out] vInfo: If not NULL, receives the vertical info of each point (same rank as in vPt4dc).
+* \throw str A std:string containing the error message if any. The message is also written in the log file.
+* \remark A point that can't be operated doesn't stop the process: its om member is set instead.
+A single pt4d instance is reused all along the job so that no string nor display format is handled per point.
+The points are operated by blocks with CompoundOperation::OperateMany, and those it leaves one by one.
+*/
+void process_vector_pt4dc(circeOptions circopt, std::vector<circe::pt4dc>* vPt4dc, std::vector<std::string>* vInfo)
+{
+    process_vector_pt4dc(circopt, vPt4dc, vInfo, NULL);
+}
+
+void process_vector_pt4dc(circeOptions circopt, std::vector<circe::pt4dc>* vPt4dc, std::vector<std::string>* vInfo, GeodeticSet* GS)
+{
+    pt4d p;
+    std::ofstream fo;
+    openLog(&fo, circopt.logPathname);
+    try
+    {
+        InitDefPoint(&p);
+        initFormats(circopt.displayPrecision, circopt.targetOptions.angularUnit, &(p.frmt));
+        if (GS == NULL)
+        {
+            GS = new GeodeticSet();
+            LoadGeodeticSet(circopt.metadataFile, GS, circopt.verbose);
+        }
+        CompoundOperation CO(circopt, *GS);
+        if (CO.getoperationMessage() != OM_OK)
+        {
+            throw (OperationMessageText[CO.getoperationMessage()]);
+        }
+        if (vInfo != NULL)
+            vInfo->assign(vPt4dc->size(), "");
+        //The points operated by OperateMany have no vertical info of their own.
+        p.info.clear();
+        p.info2.clear();
+        writeVerticalInfo(GS,&p);
+        std::string batchInfo = p.info;
+        std::vector<char> ok(OperateManyBatchSize);
+        for (unsigned int i0=0; i0<vPt4dc->size(); i0+=OperateManyBatchSize)
+        {
+            unsigned int n = std::min(OperateManyBatchSize, (unsigned int)vPt4dc->size()-i0);
+            CO.OperateMany(n, &((*vPt4dc)[i0]), &(ok[0]));
+            for (unsigned int i=i0; i<i0+n; i++)
+            {
+                pt4dc& pc = (*vPt4dc)[i];
+                pc.index = i;
+                if (ok[i-i0])
+                {
+                    pc.om = OM_OK;
+                    if (vInfo != NULL)
+                        (*vInfo)[i] = batchInfo;
+                    continue;
+                }
+                copyPt4d(&p, pc);
+                p.info.clear();
+                p.info2.clear();
+                pc.om = CO.Operate(&p);
+                if (pc.om != OM_OK)
+                    continue;
+                copyPt4d(&pc, p);
+                if (vInfo != NULL)
+                {
+                    writeVerticalInfo(GS,&p);
+                    (*vInfo)[i] = p.info;
+                }
+            }
+        }
+    }
+    catch (std::string str)
+    {
+        writeLog(&fo, CIRCE_ERROR);
+        writeLog(&fo, str);
+        fo.close();
+        throw (str);
+    }
+    fo.close();
+}
+
+/**
+* \brief Initializes a latticeDefinition with default values (empty lattice, every node
+* operated, one thread per core).
+* \param lattice: A pointer to a latticeDefinition instance.
+*/
+void InitDefLattice(latticeDefinition *lattice)
+{
+    lattice->origin1 = lattice->origin2 = lattice->step1 = lattice->step2 = 0.;
+    lattice->n1 = lattice->n2 = 0;
+    lattice->h = lattice->w = 0.;
+    lattice->tolerance = 0.;
+    lattice->subsampling = 32;
+    lattice->threads = 0;
+}
+
+/**
+* \brief Operates a node of a lattice.
+* \param[in] CO: The CompoundOperation.
+* \param[in] lattice: The latticeDefinition.
+* \param[in] ct: The source CRS type.
+* \param[in] i, j: The indices of the node.
+* \param p: A pointer to a scratch pt4d, which receives the operated node.
+* \param[out] pc: A pointer to the output pt4dc.
+*/
+void operateLatticeNode(CompoundOperation *CO, const latticeDefinition &lattice, CRS_TYPE ct,
+                        unsigned int i, unsigned int j, pt4d *p, pt4dc *pc)
+{
+    p->info.clear();
+    p->info2.clear();
+    p->conv = p->scfact = p->xi = p->eta = 0.;
+    if (ct == CT_GEOGRAPHIC)
+    {
+        p->l = lattice.origin1 + i*lattice.step1;
+        p->p = lattice.origin2 + j*lattice.step2;
+    }
+    else
+    {
+        p->e = lattice.origin1 + i*lattice.step1;
+        p->n = lattice.origin2 + j*lattice.step2;
+    }
+    p->h = lattice.h;
+    p->w = lattice.w;
+    pc->index = j*lattice.n1+i;
+    pc->om = CO->Operate(p);
+    copyPt4d(pc, *p);
+}
+
+/**
+* \brief Initializes a node of a lattice to be operated by CompoundOperation::OperateMany.
+* \param[in] lattice: The latticeDefinition.
+* \param[in] ct: The source CRS type.
+* \param[in] i, j: The indices of the node.
+* \param[out] pc: A pointer to the pt4dc.
+*/
+void initLatticeNode(const latticeDefinition &lattice, CRS_TYPE ct, unsigned int i, unsigned int j, pt4dc *pc)
+{
+    InitDefPoint(pc);
+    if (ct == CT_GEOGRAPHIC)
+    {
+        pc->l = lattice.origin1 + i*lattice.step1;
+        pc->p = lattice.origin2 + j*lattice.step2;
+    }
+    else
+    {
+        pc->e = lattice.origin1 + i*lattice.step1;
+        pc->n = lattice.origin2 + j*lattice.step2;
+    }
+    pc->h = lattice.h;
+    pc->w = lattice.w;
+    pc->index = j*lattice.n1+i;
+}
+
+/**
+* \brief Interpolates the numeric members of three pt4dc with a polynomial of degree 2.
+* \param[in] a, m, b: The pt4dc at both ends and inside the segment.
+* \param[in] tm: The position of m (0 for a, 1 for b).
+* \param[in] t: The position of the interpolated pt4dc.
+* \param[out] pc: A pointer to the interpolated pt4dc (its index is left unchanged).
+*/
+void interpolatePt4dc(const pt4dc &a, const pt4dc &m, const pt4dc &b, double tm, double t, pt4dc *pc)
+{
+    double wa = (t-tm)*(t-1.)/tm, wm = t*(t-1.)/(tm*(tm-1.)), wb = t*(t-tm)/(1.-tm);
+    pc->x = wa*a.x+wm*m.x+wb*b.x;
+    pc->y = wa*a.y+wm*m.y+wb*b.y;
+    pc->z = wa*a.z+wm*m.z+wb*b.z;
+    pc->l = wa*a.l+wm*m.l+wb*b.l;
+    pc->p = wa*a.p+wm*m.p+wb*b.p;
+    pc->h = wa*a.h+wm*m.h+wb*b.h;
+    pc->e = wa*a.e+wm*m.e+wb*b.e;
+    pc->n = wa*a.n+wm*m.n+wb*b.n;
+    pc->w = wa*a.w+wm*m.w+wb*b.w;
+    pc->conv = wa*a.conv+wm*m.conv+wb*b.conv;
+    pc->scfact = wa*a.scfact+wm*m.scfact+wb*b.scfact;
+    pc->xi = wa*a.xi+wm*m.xi+wb*b.xi;
+    pc->eta = wa*a.eta+wm*m.eta+wb*b.eta;
+    pc->CRStypeInit = a.CRStypeInit;
+    pc->Gprec = a.Gprec;
+    pc->Vprec = a.Vprec;
+    pc->transfoIndex = a.transfoIndex;
+    pc->om = a.om;
+}
+
+/**
+* \brief Interpolates the numeric members of nine pt4dc with a polynomial of degree 2 in each direction.
+* \param[in] tile: The tile buffer (row by row, width w).
+* \param[in] w: The width of the tile buffer.
+* \param[in] iu, jv: The buffer indices of the nodes at both ends and inside the cell in each direction.
+* \param[in] u, v: The positions of the interpolated pt4dc (0 at the first node, 1 at the last one).
+* \param[out] pc: A pointer to the interpolated pt4dc (its index is left unchanged).
+*/
+void interpolatePt4dc(const std::vector<pt4dc> &tile, unsigned int w, const unsigned int iu[3], const unsigned int jv[3],
+                      double u, double v, pt4dc *pc)
+{
+    pt4dc col[3];
+    double um = double(iu[1]-iu[0])/(iu[2]-iu[0]), vm = double(jv[1]-jv[0])/(jv[2]-jv[0]);
+    for (int k=0; k<3; k++)
+        interpolatePt4dc(tile[jv[k]*w+iu[0]], tile[jv[k]*w+iu[1]], tile[jv[k]*w+iu[2]], um, u, &(col[k]));
+    interpolatePt4dc(col[0], col[1], col[2], vm, v, pc);
+}
+
+/**
+* \brief Operates or interpolates the nodes of a cell of a lattice tile whose corners are already known.
+* The middles of the edges and the center are operated, and so are the 16 other nodes of the 5x5 pattern
+* made of the corners, middles and quarters. These are compared with the degree 2 interpolation
+* of the 9 first ones: if they agree within the tolerance (with the same precision codes), the remaining
+* nodes are interpolated, else the four quarters of the cell are processed the same way. Cells too small
+* to be split are operated.
+* \param[in] CO: The CompoundOperation.
+* \param[in] lattice: The latticeDefinition.
+* \param[in] ct: The source CRS type.
+* \param[in] ti, tj: The lattice indices of the first node of the tile.
+* \param[in] w: The width of the tile buffer.
+* \param[in] i0, i1, j0, j1: The buffer indices of the corners of the cell.
+* \param p, q: Pointers to scratch pt4d.
+* \param tile: The tile buffer (row by row).
+* \param known: Flags set for the nodes of the tile buffer already operated or interpolated.
+*/
+void processLatticeCell(CompoundOperation *CO, const latticeDefinition &lattice, CRS_TYPE ct,
+                        unsigned int ti, unsigned int tj, unsigned int w,
+                        unsigned int i0, unsigned int i1, unsigned int j0, unsigned int j1, pt4d *p, pt4d *q,
+                        std::vector<pt4dc> *tile, std::vector<char> *known)
+{
+    if (i1-i0 < 4 || j1-j0 < 4)
+    {
+        for (unsigned int j=j0; j<=j1; j++)
+        for (unsigned int i=i0; i<=i1; i++)
+            if (!(*known)[j*w+i])
+            {
+                operateLatticeNode(CO, lattice, ct, ti+i, tj+j, p, &((*tile)[j*w+i]));
+                (*known)[j*w+i] = 1;
+            }
+        return;
+    }
+    unsigned int iu[3] = {i0, (i0+i1)/2, i1}, jv[3] = {j0, (j0+j1)/2, j1};
+    unsigned int iq[5] = {i0, (i0+iu[1])/2, iu[1], (iu[1]+i1)/2, i1};
+    unsigned int jq[5] = {j0, (j0+jv[1])/2, jv[1], (jv[1]+j1)/2, j1};
+    const pt4dc &c = (*tile)[j0*w+i0];
+    bool ok = true;
+    for (int pass=0; pass<2; pass++)
+    for (int l=0; l<5; l++)
+    for (int k=0; k<5; k++)
+    {
+        //first pass: the 9 interpolation nodes, second pass: the 16 check nodes
+        if ((k%2 == 0 && l%2 == 0) != (pass == 0))
+            continue;
+        unsigned int n = jq[l]*w+iq[k];
+        pt4dc &pc = (*tile)[n];
+        if (!(*known)[n])
+        {
+            operateLatticeNode(CO, lattice, ct, ti+iq[k], tj+jq[l], p, &pc);
+            (*known)[n] = 1;
+        }
+        if (!ok)
+            continue;
+        ok = pc.om == OM_OK && pc.Gprec == c.Gprec && pc.Vprec == c.Vprec;
+        if (!ok || pass == 0)
+            continue;
+        pt4dc interp = pc;
+        interpolatePt4dc(*tile, w, iu, jv, double(iq[k]-i0)/(i1-i0), double(jq[l]-j0)/(j1-j0), &interp);
+        copyPt4d(p, pc);
+        copyPt4d(q, interp);
+        ok = CO->Distance(p, q) <= lattice.tolerance;
+    }
+    if (ok)
+    {
+        for (unsigned int j=j0; j<=j1; j++)
+        for (unsigned int i=i0; i<=i1; i++)
+            if (!(*known)[j*w+i])
+            {
+                pt4dc &pc = (*tile)[j*w+i];
+                interpolatePt4dc(*tile, w, iu, jv, double(i-i0)/(i1-i0), double(j-j0)/(j1-j0), &pc);
+                pc.index = (tj+j)*lattice.n1+ti+i;
+                (*known)[j*w+i] = 1;
+            }
+        return;
+    }
+    for (int l=0; l<2; l++)
+    for (int k=0; k<2; k++)
+        processLatticeCell(CO, lattice, ct, ti, tj, w, iu[k], iu[k+1], jv[l], jv[l+1], p, q, tile, known);
+}
+
+/**
+* \brief Operates the tile rows first, first+stride, first+2*stride ... of a lattice.
+* A tile row is made of lattice.subsampling rows (one row without interpolation), split into tiles of
+* lattice.subsampling columns. Each tile is processed in its own buffer, which includes the last row
+* and column shared with the next tiles, and only the nodes it owns are copied to the output, so that
+* each node is computed exactly once whatever the number of threads. Without interpolation, each row is
+* operated with CompoundOperation::OperateMany, and the nodes it leaves one by one.
+* \param[in] CO: The CompoundOperation (one instance per thread).
+* \param[in] lattice: The latticeDefinition.
+* \param[in] ct: The source CRS type.
+* \param[in] bInterpolate: If false, every node is operated.
+* \param[in] first, stride: The tile rows to be processed.
+* \param vPt4dc: The output vector.
+* \param[out] error: Receives the error message if any.
+*/
+void processLatticeRows(CompoundOperation *CO, const latticeDefinition &lattice, CRS_TYPE ct, bool bInterpolate,
+                        unsigned int first, unsigned int stride, std::vector<pt4dc> *vPt4dc, std::string *error)
+{
+    pt4d p, q;
+    unsigned int step = bInterpolate && lattice.subsampling > 1 ? lattice.subsampling : 1;
+    try
+    {
+        InitDefPoint(&p);
+        InitDefPoint(&q);
+        if (step == 1)
+        {
+            std::vector<char> ok(lattice.n1);
+            for (unsigned int j=first; j<lattice.n2; j+=stride)
+            {
+                pt4dc *row = &((*vPt4dc)[j*lattice.n1]);
+                for (unsigned int i=0; i<lattice.n1; i++)
+                    initLatticeNode(lattice, ct, i, j, &(row[i]));
+                CO->OperateMany(lattice.n1, row, &(ok[0]));
+                for (unsigned int i=0; i<lattice.n1; i++)
+                {
+                    if (ok[i])
+                    {
+                        row[i].om = OM_OK;
+                        continue;
+                    }
+                    copyPt4d(&p, row[i]);
+                    operateLatticeNode(CO, lattice, ct, i, j, &p, &(row[i]));
+                }
+            }
+            return;
+        }
+        std::vector<pt4dc> tile((step+1)*(step+1));
+        std::vector<char> known((step+1)*(step+1));
+        for (unsigned int tj=first*step; tj==0 || tj<lattice.n2-1; tj+=stride*step)
+        {
+            unsigned int h = std::min(step, lattice.n2-1-tj);
+            for (unsigned int ti=0; ti==0 || ti<lattice.n1-1; ti+=step)
+            {
+                unsigned int w = std::min(step, lattice.n1-1-ti);
+                std::fill(known.begin(), known.end(), 0);
+                for (unsigned int j=0; j<=h; j+=h>0?h:1)
+                for (unsigned int i=0; i<=w; i+=w>0?w:1)
+                {
+                    operateLatticeNode(CO, lattice, ct, ti+i, tj+j, &p, &(tile[j*(w+1)+i]));
+                    known[j*(w+1)+i] = 1;
+                }
+                processLatticeCell(CO, lattice, ct, ti, tj, w+1, 0, w, 0, h, &p, &q, &tile, &known);
+                unsigned int jn = tj+h == lattice.n2-1 ? h+1 : h, in = ti+w == lattice.n1-1 ? w+1 : w;
+                for (unsigned int j=0; j<jn; j++)
+                for (unsigned int i=0; i<in; i++)
+                    (*vPt4dc)[(tj+j)*lattice.n1+ti+i] = tile[j*(w+1)+i];
+            }
+        }
+    }
+    catch (std::string str)
+    {
+        *error = str;
+    }
+}
+
+/**
+* \brief Processes a regular lattice of points (raster or DEM nodes).
+* \param[in] circopt: Processing options in a circeOptions structure.
+* \param[in] lattice: The latticeDefinition, in the source CRS (geographic or projected).
+* \param[out] vPt4dc: A pointer to the vector of pt4dc receiving the n1*n2 operated nodes, row by row.
+The om member of each node is set to the resulting OPERATION_MESSAGE.
+* \throw str A std:string containing the error message if any. The message is also written in the log file.
+* \remark The lattice is split into tiles of lattice.subsampling x lattice.subsampling steps whose corners
+are operated. Inside each tile, the nodes are interpolated with a polynomial of degree 2 in both directions
+through the corners, the middles of the edges and the center as long as the interpolation error at the
+16 other nodes of the 5x5 pattern of corners, middles and quarters is within lattice.tolerance (in meters),
+with the same precision codes; otherwise the tile is split into four cells processed the same way,
+down to cells of less than 4 steps which are operated. The error control is thus a sampled estimate:
+since the error is only checked at these nodes (the change of slope of a grid between them may be missed),
+the tolerance is not a strict bound. Interpolation is disabled with a null tolerance or DMS and DM units.
+The rows of tiles are shared between lattice.threads threads, each of them operating its own copy of the
+CompoundOperation; the result does not depend on the number of threads.
+*/
+void process_lattice(circeOptions circopt, const latticeDefinition &lattice, std::vector<pt4dc> *vPt4dc)
+{
+    process_lattice(circopt, lattice, vPt4dc, NULL);
+}
+
+void process_lattice(circeOptions circopt, const latticeDefinition &lattice, std::vector<pt4dc> *vPt4dc, GeodeticSet* GS)
+{
+    std::ofstream fo;
+    openLog(&fo, circopt.logPathname);
+    try
+    {
+        if (GS == NULL)
+        {
+            GS = new GeodeticSet();
+            LoadGeodeticSet(circopt.metadataFile, GS, circopt.verbose);
+        }
+        //The lattice is interpolated its own way.
+        circopt.approxTolerance = 0.;
+        CompoundOperation CO(circopt, *GS);
+        if (CO.getoperationMessage() != OM_OK)
+        {
+            throw (OperationMessageText[CO.getoperationMessage()]);
+        }
+        CRS_TYPE ct = CO.getSourceCRStype();
+        if (ct != CT_GEOGRAPHIC && ct != CT_PROJECTED)
+            throw (std::string("process_lattice: ")+ErrorMessageText[EM_NOT_VALID]);
+        MEASURE_UNIT su = (MEASURE_UNIT)getIndex(circopt.sourceOptions.angularUnit,MeasureUnitAttributeText,MU_COUNT);
+        MEASURE_UNIT tu = (MEASURE_UNIT)getIndex(circopt.targetOptions.angularUnit,MeasureUnitAttributeText,MU_COUNT);
+        bool bInterpolate = lattice.tolerance > 0.
+                         && !(ct == CT_GEOGRAPHIC && (su == MU_DMS || su == MU_DM))
+                         && tu != MU_DMS && tu != MU_DM;
+        vPt4dc->resize(lattice.n1*lattice.n2);
+        if (vPt4dc->size() == 0)
+            return;
+        unsigned int nt = lattice.threads;
+        if (nt == 0)
+            nt = std::thread::hardware_concurrency();
+        if (nt == 0)
+            nt = 1;
+        unsigned int step = bInterpolate && lattice.subsampling > 1 ? lattice.subsampling : 1;
+        unsigned int nRows = step == 1 ? lattice.n2 : std::max(1u, (lattice.n2+step-2)/step);
+        if (nt > nRows)
+            nt = nRows;
+        std::vector<std::string> vError(nt, "");
+        if (nt == 1)
+            processLatticeRows(&CO, lattice, ct, bInterpolate, 0, 1, vPt4dc, &(vError[0]));
+        else
+        {
+            std::vector<CompoundOperation> vCO(nt, CO);
+            std::vector<std::thread> vThread;
+            for (unsigned int t=0; t<nt; t++)
+                vThread.push_back(std::thread(processLatticeRows, &(vCO[t]), std::cref(lattice), ct,
+                                              bInterpolate, t, nt, vPt4dc, &(vError[t])));
+            for (unsigned int t=0; t<nt; t++)
+                vThread[t].join();
+        }
+        for (unsigned int t=0; t<nt; t++)
+            if (vError[t] != "")
+                throw (vError[t]);
+    }
+    catch (std::string str)
+    {
+        writeLog(&fo, CIRCE_ERROR);
+        writeLog(&fo, str);
+        fo.close();
+        throw (str);
+    }
+    fo.close();
+}
+
+/**
+* \brief Processes a regular lattice of points into a height correction raster.
+* \param[in] circopt: Processing options in a circeOptions structure.
+* \param[in] lattice: The latticeDefinition, in the source CRS (geographic or projected).
+* \param[out] vHeight: A pointer to the vector receiving the n1*n2 height corrections, row by row:
+the target height (vertical if the target format has one, else ellipsoidal) minus the source height
+(ellipsoidal if the source format has one, else vertical). Nodes that can't be operated are set to NaN.
+* \throw str A std:string containing the error message if any. The message is also written in the log file.
+*/
+void process_lattice_height(circeOptions circopt, const latticeDefinition &lattice, std::vector<double> *vHeight)
+{
+    process_lattice_height(circopt, lattice, vHeight, NULL);
+}
+
+void process_lattice_height(circeOptions circopt, const latticeDefinition &lattice, std::vector<double> *vHeight, GeodeticSet* GS)
+{
+    std::vector<pt4dc> vPt4dc;
+    process_lattice(circopt, lattice, &vPt4dc, GS);
+    bool bTargetVertical = hasVertical(circopt.targetOptions.formatId);
+    double h0 = hasEllHeight(circopt.sourceOptions.formatId) ? lattice.h : lattice.w;
+    vHeight->resize(vPt4dc.size());
+    for (unsigned int i=0; i<vPt4dc.size(); i++)
+    {
+        if (vPt4dc[i].om != OM_OK)
+            (*vHeight)[i] = std::numeric_limits<double>::quiet_NaN();
+        else
+            (*vHeight)[i] = (bTargetVertical ? vPt4dc[i].w : vPt4dc[i].h) - h0;
+    }
+}
+
 /**
 * \brief Processes a vector of double precision reals.
 * \param[in] circopt: Processing options in a circeOptions structure.
@@ -402,6 +887,301 @@ void process_double_array(circeOptions circopt, double* points, GeodeticSet* GS)
     fo.close();
 }
 
+/**
+* \brief Number of data lines of a chunk of a basic file operated by processInputLines (not above
+BinaryChunkMaxSize, a chunk of a binary target file being written per chunk of data lines).
+*/
+static const unsigned int IFStreamChunkSize = 4096;
+
+/**
+* \brief A data line read from a basic (or binary) file, to be operated by processInputLines.
+*/
+struct inputLine
+{
+    DATA_VALIDATION dv;
+    unsigned int nl, idt;
+    int status;     // status read from a binary file, the point is not operated if not 0
+    pt4d p;
+};
+
+/**
+* \brief Operates a chunk of data lines read from a basic file and writes them in order.
+* \param[in] CO: The CompoundOperation (one instance per thread).
+* \param[in] GS: The GeodeticSet.
+* \param[in] circopt: Processing options in a circeOptions structure.
+* \param vLine: A pointer to the lines, operated in place.
+* \param bw: The basicWriter of the thread (basic target format).
+* \param bnw: The binaryWriter of the thread (binary target format), the chunk being written at once.
+* \param[out] oss, oss_fut: The output and follow-up streams of the chunk.
+* \param[out] ns: Incremented by the number of points successfully operated.
+* \param[out] error: The error message if any.
+* \remark The warm start of the grid solvers is reset at the beginning of the chunk, so that the
+output does not depend on the number of threads.
+*/
+void processInputLines(CompoundOperation *CO, GeodeticSet *GS, const circeOptions &circopt,
+                       std::vector<inputLine> *vLine, basicWriter *bw, binaryWriter *bnw,
+                       std::ostringstream *oss, std::ostringstream *oss_fut, unsigned int *ns, std::string *error)
+{
+    OPERATION_MESSAGE om;
+    std::string errMess;
+    bool bBinary = (circopt.targetOptions.subformatId == FF_BINARY);
+    try
+    {
+        CO->resetWarmStart();
+        // flags of the new output stream of the chunk
+        bw->left = false;
+        bw->floatfield = 'f';
+        for (std::vector<inputLine>::iterator itL=vLine->begin(); itL!=vLine->end(); itL++)
+        {
+            if (hasIdentifier(circopt.targetOptions.formatId))
+                errMess = "*"+itL->p.id+" ";
+            else
+                errMess = "*";
+            if (itL->dv != DV_OK)
+            {
+                errMess += asString(itL->nl) + ":" + asString(itL->idt + 1) + ":" + circe::DataValidationText[itL->dv] + "\n";
+                if (bBinary)
+                    appendBinaryPoint(bnw, itL->p, -(int)itL->dv);
+                else
+                    *oss << errMess;
+                continue;
+            }
+            if (itL->status != 0)
+            {
+                // error passed on by a binary file
+                if (bBinary)
+                    appendBinaryPoint(bnw, itL->p, itL->status);
+                else if (itL->status > 0 && itL->status < OM_COUNT)
+                    *oss << errMess << " " << OperationMessageText[itL->status] << std::endl;
+                else if (itL->status < 0 && -itL->status < DV_COUNT)
+                    *oss << errMess << asString(itL->nl) << ":" << circe::DataValidationText[-itL->status] << std::endl;
+                else
+                    *oss << errMess << asString(itL->nl) << ":" << asString(itL->status) << std::endl;
+                continue;
+            }
+            // Operate single point
+            om = CO->Operate(&(itL->p));
+            writeVerticalInfo(GS,&(itL->p));
+            // Output
+            if (om != OM_OK && bBinary)
+                appendBinaryPoint(bnw, itL->p, om);
+            else if (om != OM_OK)
+                *oss << errMess << " " << OperationMessageText[om] << std::endl;
+            else
+            {
+                if (bBinary)
+                    appendBinaryPoint(bnw, itL->p, 0);
+                else if (circopt.targetOptions.subformatId == FF_BASIC)
+                {
+                    bw->buf.clear();
+                    writeBasicLine(bw, itL->p);
+                    bw->buf += '\n';
+                    oss->write(bw->buf.data(), bw->buf.size());
+                }
+                else
+                    writeOutputLine(oss, circopt, itL->p, &(itL->idt));
+                (*ns)++;
+                if (circopt.followUpTransfos)
+                    *oss_fut << CO->followUpTransfos() << std::endl;
+            }
+        }
+        if (bBinary)
+            writeBinaryChunk(bnw, oss);
+    }
+    catch (std::string str)
+    {
+        *error = str;
+    }
+}
+
+/**
+* \brief A chunk of data lines read from a basic (or binary) file, and its output once operated.
+*/
+struct inputChunk
+{
+    std::vector<inputLine> vLine;
+    std::ostringstream oss, oss_fut;
+    unsigned int ns;
+    std::string error;
+    bool done;
+};
+
+/**
+* \brief Pool of threads operating the chunks of data lines of a basic file while the next ones are
+* read. Each thread operates its own CompoundOperation from start to end (copies sharing the loaded
+* grids). The output of the chunks is written in the reading order, so that it does not depend on the
+* number of threads, and at most two chunks per thread are kept in memory. With a single
+* CompoundOperation, there is no thread: the chunks are operated as soon as they are pushed.
+*/
+class ChunkPool
+{
+private:
+    std::vector<CompoundOperation*> vCO;
+    GeodeticSet *GS;
+    const circeOptions &circopt;
+    basicWriter bw;
+    binaryWriter bnw;
+    std::ostream *os, *os_fut;
+    std::deque<std::unique_ptr<inputChunk> > qChunk;  // in the reading order, operated or not
+    std::deque<inputChunk*> qTodo;                     // not taken by a thread yet
+    bool closed;
+    std::mutex mtx;
+    std::condition_variable cvTodo, cvDone;
+    std::vector<std::thread> vThread;
+    unsigned int ns;
+    void work(CompoundOperation *CO);
+    void write(size_t maxChunks);
+    void stop();
+public:
+    ChunkPool(const std::vector<CompoundOperation*> &_vCO, GeodeticSet *_GS, const circeOptions &_circopt,
+              const basicWriter &_bw, const binaryWriter &_bnw, std::ostream *_os, std::ostream *_os_fut);
+    ~ChunkPool();
+    void push(std::vector<inputLine> *vLine);
+    void finish(unsigned int *_ns);
+};
+
+/**
+* \brief Constructor, starting one thread per CompoundOperation if there are several of them.
+* \param[in] _vCO: The CompoundOperation instances (one per thread).
+* \param[in] _GS: The GeodeticSet.
+* \param[in] _circopt: Processing options in a circeOptions structure.
+* \param[in] _bw, _bnw: The initialized basicWriter and binaryWriter, copied for each thread.
+* \param _os, _os_fut: The output and follow-up streams.
+*/
+ChunkPool::ChunkPool(const std::vector<CompoundOperation*> &_vCO, GeodeticSet *_GS, const circeOptions &_circopt,
+                     const basicWriter &_bw, const binaryWriter &_bnw, std::ostream *_os, std::ostream *_os_fut)
+    : vCO(_vCO), GS(_GS), circopt(_circopt), bw(_bw), bnw(_bnw), os(_os), os_fut(_os_fut)
+{
+    closed = false;
+    ns = 0;
+    if (vCO.size() > 1)
+        for (unsigned int t=0; t<vCO.size(); t++)
+            vThread.push_back(std::thread(&ChunkPool::work, this, vCO[t]));
+}
+
+/**
+* \brief Destructor. The chunks not operated yet are dropped (on error).
+*/
+ChunkPool::~ChunkPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        qTodo.clear();
+    }
+    stop();
+}
+
+/**
+* \brief Operates the queued chunks until the pool is stopped (thread function).
+* \param[in] CO: The CompoundOperation of the thread.
+*/
+void ChunkPool::work(CompoundOperation *CO)
+{
+    basicWriter bwt = bw;
+    binaryWriter bnwt = bnw;
+    inputChunk *ch;
+    std::unique_lock<std::mutex> lock(mtx);
+    while (true)
+    {
+        cvTodo.wait(lock, [this]{return qTodo.size() > 0 || closed;});
+        if (qTodo.size() == 0)
+            return;
+        ch = qTodo.front();
+        qTodo.pop_front();
+        lock.unlock();
+        processInputLines(CO, GS, circopt, &(ch->vLine), &bwt, &bnwt, &(ch->oss), &(ch->oss_fut), &(ch->ns), &(ch->error));
+        lock.lock();
+        ch->done = true;
+        cvDone.notify_all();
+    }
+}
+
+/**
+* \brief Stops the threads once the queued chunks are operated.
+*/
+void ChunkPool::stop()
+{
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        closed = true;
+    }
+    cvTodo.notify_all();
+    for (unsigned int t=0; t<vThread.size(); t++)
+        vThread[t].join();
+    vThread.clear();
+}
+
+/**
+* \brief Writes the operated chunks at the beginning of the queue, in the reading order.
+* \param[in] maxChunks: The first chunks are waited for until at most maxChunks remain in the queue.
+* \throw str A std:string containing the error message of a chunk if any.
+*/
+void ChunkPool::write(size_t maxChunks)
+{
+    std::unique_ptr<inputChunk> ch;
+    while (true)
+    {
+        {
+            std::unique_lock<std::mutex> lock(mtx);
+            if (qChunk.size() == 0 || (!qChunk.front()->done && qChunk.size() <= maxChunks))
+                return;
+            cvDone.wait(lock, [this]{return qChunk.front()->done;});
+            ch = std::move(qChunk.front());
+            qChunk.pop_front();
+        }
+        if (ch->error != "")
+            throw (ch->error);
+        *os << ch->oss.str();
+        if (circopt.followUpTransfos)
+            *os_fut << ch->oss_fut.str();
+        ns += ch->ns;
+        os->flush();
+    }
+}
+
+/**
+* \brief Queues a chunk of data lines (or operates it if there is no thread), and writes the chunks
+* already operated.
+* \param vLine: A pointer to the lines, moved to the pool.
+* \throw str A std:string containing the error message of a chunk if any.
+*/
+void ChunkPool::push(std::vector<inputLine> *vLine)
+{
+    std::unique_ptr<inputChunk> ch(new inputChunk);
+    ch->vLine.swap(*vLine);
+    ch->ns = 0;
+    ch->done = false;
+    initBasicOstream(&(ch->oss));
+    initBasicOstream(&(ch->oss_fut));
+    if (vThread.size() == 0)
+    {
+        processInputLines(vCO[0], GS, circopt, &(ch->vLine), &bw, &bnw, &(ch->oss), &(ch->oss_fut), &(ch->ns), &(ch->error));
+        ch->done = true;
+        qChunk.push_back(std::move(ch));
+        write(0);
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        qTodo.push_back(ch.get());
+        qChunk.push_back(std::move(ch));
+    }
+    cvTodo.notify_one();
+    write(2*vThread.size());
+}
+
+/**
+* \brief Writes all the chunks once operated, and stops the threads.
+* \param[out] _ns: Incremented by the number of points successfully operated.
+* \throw str A std:string containing the error message of a chunk if any.
+*/
+void ChunkPool::finish(unsigned int *_ns)
+{
+    write(0);
+    stop();
+    *_ns += ns;
+}
+
 /**
 * \brief Processes basic file.
 * \param[in] circopt: Processing options in a circeOptions structure.
@@ -422,6 +1202,20 @@ std::string processIFStream(const circeOptions& circopt, GeodeticSet* GS, swain
 * \param[in] circopt: Processing options in a circeOptions structure.
 * \param[out] vPt4d: The vector of pt4d to write the result to.
 * \throw str A std:string containing the error message if any. The message is also written in the log file.
+* \remark The data lines are operated by chunks of IFStreamChunkSize lines, by a pool of circopt.threads
+threads (0: number of cores) fed by the reader, each of them operating its own copy of the CompoundOperation
+(see ChunkPool). The output is the same whatever the number of threads. The approximate mode, the vector
+modes and \-\-followUpTransfos use a single thread, the reader operating the chunks.
+A binary source or target file (\-\-sourceFormat=ILPH.METERS.DEGREES.BINARY) is read and written by
+chunks of columns instead of lines.
+The output (and follow-up) of the chunks is written as soon as they are operated, so that the memory
+used does not depend on the size of the file.
+A source (target) pathname "-" stands for the standard input (output), so that Circe can be used in a shell
+pipeline. The messages usually written to std::cout are then written to std::cerr. With \-\-lineBuffered,
+each line is operated and written as soon as it is read, using a single thread.
+A gzip or zstd compressed source file (recognized from its first bytes) is decompressed, and a target file
+whose pathname ends with .gz or .zst is compressed, by threads of their own (see compressedstream.h), so
+that no uncompressed copy is needed.
 * \remark This function is reachable using these kind of options:
 - \-\-sourceCRS=NTFLAMB3. \-\-sourceFormat=EN.METERS. \-\-targetCRS=RGF93G. \-\-targetFormat=LP.METERS.DEGREES \-\-metadataFile="data/DataFRnew.xml" \-\-logPathname="circe.log" \-\-sourcePathname="./datafile.txt" \-\-targetPathname="./outfile.txt"
 - \-\-sourceCRS=NTFLAMB3. \-\-sourceFormat=IEN.METERS. \-\-targetCRS=WGS84G. \-\-targetFormat=ILP.METERS.DEGREES \-\-metadataFile="data/IGNF.xml" \-\-sourcePathname="./datafile.txt" \-\-targetPathname="./outfile_IGNF.txt"
@@ -430,15 +1224,24 @@ std::string processIFStream(const circeOptions& circopt, std::vector<circe::pt4d
                             GeodeticSet* GS, swain *swn)
 {
     pt4d p;
-    OPERATION_MESSAGE om;
     time_t timer;
     DATA_VALIDATION dv;
-    unsigned int idt, nl=0, ns=0;
-    std::ifstream *fi;
-    std::ofstream *ofs;
-    std::ostringstream oss, oss_fut;
+    unsigned int idt, nl=0, ns=0, nt=1;
+    int status = 0;
+    std::istream *fi;
+    std::ifstream *ifs = NULL;
+    std::ostream *os = NULL;
+    std::ofstream *ofs = NULL, ofs_fut;
+    std::ostringstream oss;
+    COMPRESSION sourceCompression = CP_NONE, targetCompression = CP_NONE;
+    std::unique_ptr<CompressedIstream> cis;
+    std::unique_ptr<CompressedOstream> cos;
     bool bProcessVector = (vPt4d!=NULL && circopt.processAsVector);
     bool loadAsVector = (vPt4d!=NULL && circopt.loadAsVector);
+    bool bStdIn = (circopt.sourceOptions.pathname == "-" && (swn == NULL || swn->fi == NULL));
+    bool bStdOut = (circopt.targetOptions.pathname == "-" && (swn == NULL || swn->fo == NULL));
+    std::streambuf *coutBuf = std::cout.rdbuf();
+    std::ostream stdOut(coutBuf);
     std::ofstream fo;
     std::string errMess, ret;
 	openLog(&fo, circopt.logPathname);
@@ -446,22 +1249,46 @@ std::string processIFStream(const circeOptions& circopt, std::vector<circe::pt4d
     {
         time(&timer);
 		initFormats(circopt.displayPrecision, circopt.targetOptions.angularUnit, &(p.frmt));
+        // Data only on the standard output
+        if (bStdOut)
+            std::cout.rdbuf(std::cerr.rdbuf());
+#ifdef WIN32
+        if (bStdIn && circopt.sourceOptions.subformatId == FF_BINARY)
+            _setmode(_fileno(stdin), _O_BINARY);
+        if (bStdOut && circopt.targetOptions.subformatId == FF_BINARY)
+            _setmode(_fileno(stdout), _O_BINARY);
+#endif
 
         // Open input file
-        if (swn == NULL || swn->fi == NULL)
+        if (bStdIn)
+            fi = &std::cin;
+        else
         {
-            fi = new std::ifstream();
-            fi->open(circopt.sourceOptions.pathname.data(),std::ifstream::in);
+            if (swn == NULL || swn->fi == NULL)
+            {
+                sourceCompression = getFileCompression(circopt.sourceOptions.pathname);
+                ifs = new std::ifstream();
+                if (circopt.sourceOptions.subformatId == FF_BINARY || sourceCompression != CP_NONE)
+                    ifs->open(circopt.sourceOptions.pathname.data(),std::ifstream::in|std::ifstream::binary);
+                else
+                    ifs->open(circopt.sourceOptions.pathname.data(),std::ifstream::in);
+            }
+            else
+                ifs = swn->fi;
+        //    if (!fi.good())
+        //    {
+        //        fi.close();
+        //        return;
+        //    }
+            if (!(ifs->is_open()))
+                throw ErrorMessageText[EM_CANNOT_OPEN]+circopt.sourceOptions.pathname;
+            fi = ifs;
+            if (sourceCompression != CP_NONE)
+            {
+                cis.reset(new CompressedIstream(ifs, sourceCompression));
+                fi = cis.get();
+            }
         }
-        else
-            fi = swn->fi;
-    //    if (!fi.good())
-    //    {
-    //        fi.close();
-    //        return;
-    //    }
-        if (!(fi->is_open()))
-            throw ErrorMessageText[EM_CANNOT_OPEN]+circopt.sourceOptions.pathname;
 
         // Load metadata
         if (GS == NULL)
@@ -489,18 +1316,64 @@ std::string processIFStream(const circeOptions& circopt, std::vector<circe::pt4d
 		}
 		else
 		{
-			initBasicOstream(&oss);
-            if (circopt.followUpTransfos)
-                initBasicOstream(&oss_fut);
-            if (swn == NULL || swn->fo == NULL)
-                ofs = new std::ofstream();
+            if (bStdOut)
+            {
+                os = &stdOut;
+                writeOutputHeader(os, circopt, CO.displayDescription(circopt,"all"), CO.getTransfoRequired());
+            }
+            else if ((swn == NULL || swn->fo == NULL)
+                     && (targetCompression = getPathnameCompression(circopt.targetOptions.pathname)) != CP_NONE)
+            {
+                ofs = new std::ofstream(circopt.targetOptions.pathname.data(),std::ofstream::out|std::ofstream::binary);
+                if (!(ofs->is_open()))
+                    throw(DataValidationText[DV_CANNOT_OPEN_OUTPUT])+": "+circopt.targetOptions.pathname;
+                cos.reset(new CompressedOstream(ofs, targetCompression));
+                os = cos.get();
+                writeOutputHeader(os, circopt, CO.displayDescription(circopt,"all"), CO.getTransfoRequired());
+            }
             else
-                ofs = swn->fo;
-            openOutputFile(ofs, circopt, CO.displayDescription(circopt,"all"), CO.getTransfoRequired());
+            {
+                if (swn == NULL || swn->fo == NULL)
+                    ofs = new std::ofstream();
+                else
+                    ofs = swn->fo;
+                openOutputFile(ofs, circopt, CO.displayDescription(circopt,"all"), CO.getTransfoRequired());
+                os = ofs;
+            }
+            if (circopt.followUpTransfos)
+            {
+                ofs_fut.open((circopt.targetOptions.pathname+"_transfos").data(),std::ofstream::out);
+                initBasicOstream(&ofs_fut);
+            }
+            if (circopt.threads > 1)
+                nt = circopt.threads;
+            else if (circopt.threads == 0)
+                nt = std::thread::hardware_concurrency();
+            // The follow-up of the vertical transformations accumulates over the points operated
+            // by a CompoundOperation: it would depend on the number of threads.
+            if (nt == 0 || CO.getuseApprox() || circopt.lineBuffered || circopt.followUpTransfos)
+                nt = 1;
         }
+        std::vector<CompoundOperation> vCOcopy(nt-1, CO);
+        std::vector<CompoundOperation*> vCO(1, &CO);
+        for (unsigned int t=0; t<nt-1; t++)
+            vCO.push_back(&(vCOcopy[t]));
+        std::vector<inputLine> vLine;
+        inputLine iL;
+        basicReader br;
+        binaryReader bnr;
+        if (circopt.sourceOptions.subformatId == FF_BINARY)
+            initBinaryReader(&bnr, fi, circopt);
+        else
+            initBasicReader(&br, fi, circopt, circopt.sourceOptions.formatId);
+        basicWriter bw;
+        initBasicWriter(&bw, circopt, circopt.targetOptions.formatId);
+        binaryWriter bnw;
+        initBinaryWriter(&bnw, circopt, CO.getTransfoRequired());
+        ChunkPool pool(vCO, GS, circopt, bw, bnw, os, &ofs_fut);
 
         // Process input data
-        while (!fi->eof())
+        while (circopt.sourceOptions.subformatId == FF_BINARY ? !eofBinaryReader(bnr) : !eofBasicReader(br))
         {
             // Read
             //if ((++nl)%1000==0) std::cout << "\r"+asString(nl);
@@ -509,10 +1382,11 @@ std::string processIFStream(const circeOptions& circopt, std::vector<circe::pt4d
             switch (circopt.sourceOptions.subformatId)
             {
             case FF_BASIC:
-                if (getSeparator(circopt.separator)==' ')
-                    dv = readBasicLine(fi, circopt, circopt.sourceOptions.formatId, &p, &idt);
-                else
-                    dv = readBasicLine2(fi, circopt, circopt.sourceOptions.formatId, &p, &idt);
+                dv = readBasicLine(&br, &p, &idt);
+                break;
+            case FF_BINARY:
+                dv = readBinaryPoint(&bnr, &p, &status);
+                idt = 0;
                 break;
             case FF_NMEA_POINT:
                 //dv = readNMEAline(&fi, &p, &idt);
@@ -534,40 +1408,27 @@ std::string processIFStream(const circeOptions& circopt, std::vector<circe::pt4d
                 nl--;
                 continue;
             }
-            if (dv != DV_OK)
-            {
-                //errMess = std::string("::") + circopt.sourceOptions.pathname + std::string("::") + asString(nl) + std::string("::") + asString(idt + 1) + "::" + circe::DataValidationText[dv] + "::\n";
-                //writeLog(&fo, errMess);
-                //writeLog(&fo, displayDuration(circopt, timer)+"\n");
-                errMess += asString(nl) + ":" + asString(idt + 1) + ":" + circe::DataValidationText[dv] + "\n";
-                oss << errMess;
-				//ofs << oss.str();
-				//closeOutputFile(&ofs, circopt);
-				//return;
-			}
-            else if (bProcessVector || loadAsVector)
+            if (bProcessVector || loadAsVector)
             {
-                vPt4d->push_back(p);
+                if (dv != DV_OK)
+                {
+                    errMess += asString(nl) + ":" + asString(idt + 1) + ":" + circe::DataValidationText[dv] + "\n";
+                    oss << errMess;
+                }
+                else if (status == 0)
+                    vPt4d->push_back(p);
             }
             else
             {
-                // Operate single point
-                om = CO.Operate(&p);
-                writeVerticalInfo(GS,&p);
-                // Output
-                if (om != OM_OK)
-                    oss << errMess << " " << OperationMessageText[om] << std::endl;
-                else
-                {
-                    //writeOutputLine(&oss, circopt, p, &idt, true);
-                    writeOutputLine(&oss, circopt, p, &idt);
-                    ns++;
-                    if (circopt.followUpTransfos)
-                    {
-                        //writeOutputLine(&oss_fut, circopt, p, &idt, true);
-                        oss_fut << CO.followUpTransfos() << std::endl;
-                    }
-                }
+                // Operated (and errors written) by chunks, in order
+                iL.dv = dv;
+                iL.nl = nl;
+                iL.idt = idt;
+                iL.status = status;
+                iL.p = p;
+                vLine.push_back(iL);
+                if (vLine.size() == IFStreamChunkSize || circopt.lineBuffered)
+                    pool.push(&vLine);
             }
             if (nl%1000==0)
             {
@@ -577,24 +1438,41 @@ std::string processIFStream(const circeOptions& circopt, std::vector<circe::pt4d
                     std::cout << "\r"+asString(nl);
             }
         }
-        fi->close();
+        if (vLine.size() > 0)
+            pool.push(&vLine);
+        pool.finish(&ns);
+        if (ifs != NULL)
+            ifs->close();
         if (bProcessVector)
         {
             process_vector_pt4d(circopt,vPt4d);
-            writeVectorPt4d(circopt, *vPt4d);
+            writeVectorPt4d(circopt, *vPt4d, bStdOut ? &stdOut : NULL);
         }
         else if (!loadAsVector)
         {
-            *ofs << oss.str();
-            closeOutputFile(ofs,circopt);
-            if (circopt.followUpTransfos)
+            if (bStdOut)
             {
-                std::ofstream ofs_fut;
-                ofs_fut.open((circopt.targetOptions.pathname+"_transfos").data(),std::ofstream::out);
-                ofs_fut << oss_fut.str();
-                ofs_fut.close();
+                writeOutputTail(os, circopt);
+                os->flush();
+            }
+            else if (cos)
+            {
+                writeOutputTail(os, circopt);
+                cos->close();
+                ofs->close();
             }
+            else
+                closeOutputFile(ofs,circopt);
+            if (circopt.followUpTransfos)
+                ofs_fut.close();
         }
+        if (circopt.verbose)
+        {
+            writeLog(&fo, CO.displayIterationHistogram(&vCOcopy));
+            writeLog(&fo, CO.displayInverseGridReport());
+        }
+        if (CO.getuseApprox())
+            writeLog(&fo, CO.displayApproxReport());
         endProcess(&fo, circopt, timer, nl);
     }
     catch (std::string str)
@@ -602,11 +1480,13 @@ std::string processIFStream(const circeOptions& circopt, std::vector<circe::pt4d
         writeLog(&fo, CIRCE_ERROR);
         writeLog(&fo, str);
         fo.close();
+        std::cout.rdbuf(coutBuf);
         throw (str);
     }
     fo.close();
     if (GS->mb==NULL)
         std::cout << "\r" << std::setw(asString(nl).length()) << " " << "\r";
+    std::cout.rdbuf(coutBuf);
     return displayOutput(circopt, OperationMessageText[circe::OM_NB_PROCESSED_POINTS]+": "+asString(ns)+"/"+asString(nl), "{", "}", true);
 }
 
@@ -616,12 +1496,63 @@ std::string processIFStream(const circeOptions& circopt, std::vector<circe::pt4d
 \-\-sourceCRS=WGS84G. \-\-sourceFormat=KML.METERS.DEGREES \-\-targetCRS=WGS84. \-\-targetFormat=GPX.METERS.DEGREES \-\-metadataFile="data/DataFRnew.txt" \-\-logPathname="circe.log" \-\-sourcePathname="./test_FR_NTF_L2e_alter.kml" \-\-targetPathname="./test_test_FR_NTF_L2e_alter.gpx"
 \-\-sourceCRS=WGS84G. \-\-sourceFormat=GPX.METERS.DEGREES \-\-targetCRS=WGS84G. \-\-targetFormat=ILPH.METERS.DEGREES \-\-metadataFile="data/DataFRnew.txt" \-\-logPathname="circe.log" \-\-sourcePathname="./test_test_FR_NTF_L2e_alter.gpx" \-\-targetPathname="./test_test_FR_NTF_L2e_alter.geo"
  */
+/**
+* \brief Operates a point read from a XML (KML or GPX) file, and writes it unless the document is passed through.
+* \param[in] CO: The CompoundOperation.
+* \param[in] GS: The GeodeticSet.
+* \param[in] circopt: Processing options in a circeOptions structure.
+* \param[in] dv: The DATA_VALIDATION code returned when the point was read.
+* \param p: A pointer to the pt4d.
+* \param[in] passThrough: true if the document is passed through (its coordinates being rewritten by the caller).
+* \param os: The output stream.
+* \param nl, ns: Pointers to the numbers of points read and successfully operated.
+* \return true if the point was successfully operated.
+*/
+static bool processXMLpoint(CompoundOperation *CO, GeodeticSet* GS, const circeOptions &circopt, DATA_VALIDATION dv,
+                            pt4d *p, bool passThrough, std::ostream *os, unsigned int *nl, unsigned int *ns)
+{
+    OPERATION_MESSAGE om = OM_OK;
+    unsigned int idt;
+    if ((++(*nl))%1000==0)
+    {
+        if (GS->mb!=NULL)
+            GS->mb->messageEdit(asString(*nl));
+        else
+            std::cout << "\r"+asString(*nl);
+    }
+    if (dv != DV_OK)
+    {
+        if (!passThrough)
+            *os << DataValidationText[dv] << std::endl;
+        return false;
+    }
+    om = CO->Operate(p);
+    if (!passThrough)
+        writeVerticalInfo(GS,p);
+    if (om != OM_OK)
+    {
+        if (!passThrough)
+            *os << OperationMessageText[om] << std::endl;
+        return false;
+    }
+    if (!passThrough)
+        writeOutputLine(os, circopt, *p, &idt);
+    (*ns)++;
+    return true;
+}
+
 /**
 * \brief Processes a XML (KML or GPX) point file.
 * \param[in] circopt: Processing options in a circeOptions structure.
 * \throw str A std:string containing the error message if any. The message is also written in the log file.
+* \remark The document is read as a stream of tokens (see nextXMLtoken), so that the memory used does not depend
+on its size. The points are the tuples of the KML coordinates elements (the Placemark name being their
+identifier) and the GPX wpt, trkpt and rtept elements.
+If the target format is the source format, the document is passed through unchanged except for these
+horizontal coordinates (heights are not operated with these formats, and a point that cannot be operated is
+left as it is). Otherwise the points are written in the
+target format.
 */
-//KML files simple point format. This is mainly intended to process KML files created by circe.
 std::string processXMLdoc(const circeOptions &circopt)
 {
     return processXMLdoc(circopt, NULL,NULL);
@@ -630,16 +1561,20 @@ std::string processXMLdoc(const circeOptions &circopt)
 std::string processXMLdoc(const circeOptions &circopt, GeodeticSet* GS, swain *swn)
 {
     pt4d p;
-    OPERATION_MESSAGE om;
+    DATA_VALIDATION dv;
     time_t timer;
+    std::ifstream ifs;
+    std::istream *fi;
     std::ofstream ofs;
-    std::ostringstream oss;
-    std::string rootTag, pointTag, message;
-    unsigned int idt, nl=0, ns=0;
-    //OteAccents(Fichier, Fichier+"_tmp");
-    tinyxml2::XMLDocument XMLdoc;
-    tinyxml2::XMLElement *XMLroot, *XMLelem;
-    tinyxml2::XMLError err_load;
+    std::string rootTag, token, tag, placemarkName, coordinates;
+    std::vector<std::string> vToken; // current GPX point element
+    unsigned int nl=0, ns=0;
+    int depth = 0, pointDepth = 0, placemarkDepth = -1, dim;
+    size_t i, j, k, l;
+    char type;
+    bool passThrough = (circopt.targetOptions.subformatId == circopt.sourceOptions.subformatId);
+    bool bRoot = false, bName = false, bCoordinates = false;
+    xmlReader xr;
 	std::ofstream fo;
 	openLog(&fo, circopt.logPathname);
 	try
@@ -651,36 +1586,24 @@ std::string processXMLdoc(const circeOptions &circopt, GeodeticSet* GS, swain *s
         {
         case FF_KML_POINT:
             rootTag = "kml";
-            pointTag = "Placemark";
             break;
         case FF_GPX_POINT:
             rootTag = "gpx";
-            pointTag = "wpt";
             break;
         default:
             throw std::string("not a circe XML file.")+"\n";
             break;
         }
 
-        err_load = XMLdoc.LoadFile(circopt.sourceOptions.pathname.data());
-        if (err_load)
-        {
-            message.assign(XMLdoc.ErrorName());
-            throw std::string(":::")+message+":::\n";
-        }
-        XMLroot = XMLdoc.FirstChildElement(rootTag.data());
-        if (!XMLroot)
-            throw std::string(":::")+circe::DataValidationText[DV_TAG_NOT_FOUND]+":::\n";
-
-        //Just to be not too strict with KML format, but KML is far more complex than that.
-        //Here we accept some sub-tags ...
-        if ((circopt.sourceOptions.subformatId) == FF_KML_POINT)
+        if (swn == NULL || swn->fi == NULL)
         {
-            if (XMLroot->FirstChildElement("Document"))
-                XMLroot = XMLroot->FirstChildElement("Document");
-            if (XMLroot->FirstChildElement("Folder"))
-                XMLroot = XMLroot->FirstChildElement("Folder");
+            ifs.open(circopt.sourceOptions.pathname.data(),std::ifstream::in);
+            if (!ifs.is_open())
+                throw ErrorMessageText[EM_CANNOT_OPEN]+circopt.sourceOptions.pathname;
+            fi = &ifs;
         }
+        else
+            fi = swn->fi;
 
 		if (GS == NULL)
 		{
@@ -690,8 +1613,17 @@ std::string processXMLdoc(const circeOptions &circopt, GeodeticSet* GS, swain *s
 //        CatOperation CO(circopt, *GS);
         CompoundOperation CO(circopt, *GS);
 
-        initBasicOstream(&oss);
-        openOutputFile(&ofs, circopt, "", CO.getTransfoRequired());
+        if (passThrough)
+        {
+            ofs.open(circopt.targetOptions.pathname.data(),std::ofstream::out);
+            if (!ofs.is_open())
+                throw(DataValidationText[DV_CANNOT_OPEN_OUTPUT])+": "+circopt.targetOptions.pathname;
+        }
+        else
+        {
+            initBasicOstream(&ofs);
+            openOutputFile(&ofs, circopt, "", CO.getTransfoRequired());
+        }
 
         if (CO.getoperationMessage() != OM_OK)
         {
@@ -699,36 +1631,401 @@ std::string processXMLdoc(const circeOptions &circopt, GeodeticSet* GS, swain *s
             throw (OperationMessageText[CO.getoperationMessage()]);
         }
 
-        for (XMLelem = XMLroot->FirstChildElement(pointTag.data());
-             XMLelem ;
-             XMLelem = XMLelem->NextSiblingElement(pointTag.data()) )
+        initXMLReader(&xr, fi);
+        while (nextXMLtoken(&xr, &token))
         {
-//            if ((dv = readKMLline(XMLelem, &p)) != DV_OK)
-//                std::cout << DataValidationText[dv] << std::endl;
-            if ((circopt.sourceOptions.subformatId) == FF_KML_POINT)
-                readKMLline(XMLelem, &p);
-            else if ((circopt.sourceOptions.subformatId) == FF_GPX_POINT)
-                readGPXline(XMLelem, &p);
-            om = CO.Operate(&p);
-            writeVerticalInfo(GS,&p);
-            if (om != OM_OK)
-                oss << OperationMessageText[om] << std::endl;
+            tag = XMLtagName(token, &type);
+            if (!bRoot && type != 0)
+            {
+                if (tag != rootTag)
+                    throw std::string(":::")+circe::DataValidationText[DV_TAG_NOT_FOUND]+":::\n";
+                bRoot = true;
+            }
+            if (type == 's')
+                depth++;
+            else if (type == 'e')
+                depth--;
+
+            // GPX point element, kept until its end tag
+            if (circopt.sourceOptions.subformatId == FF_GPX_POINT
+             && (vToken.size() > 0 || ((type == 's' || type == 'a')
+                                       && (tag == "wpt" || tag == "trkpt" || tag == "rtept"))))
+            {
+                if (vToken.size() == 0)
+                    pointDepth = (type == 's' ? depth-1 : depth);
+                vToken.push_back(token);
+                if (depth > pointDepth)
+                    continue;
+                dv = readGPXpoint(vToken, &p);
+                if (processXMLpoint(&CO, GS, circopt, dv, &p, passThrough, &ofs, &nl, &ns) && passThrough)
+                    writeGPXpoint(&vToken, p);
+                if (passThrough)
+                    for (i=0; i<vToken.size(); i++)
+                        ofs << vToken[i];
+                vToken.clear();
+                continue;
+            }
+
+            // KML coordinates element, made of white space separated tuples
+            if (circopt.sourceOptions.subformatId == FF_KML_POINT)
+            {
+                if (type == 's' && tag == "Placemark")
+                {
+                    placemarkDepth = depth;
+                    placemarkName = "";
+                }
+                else if (type == 'e' && tag == "Placemark")
+                    placemarkDepth = -1;
+                else if (type == 's' && tag == "name" && depth == placemarkDepth+1)
+                    bName = true;
+                else if (type == 'e' && tag == "name")
+                    bName = false;
+                else if (type == 's' && tag == "coordinates")
+                    bCoordinates = true;
+                else if (type == 'e' && tag == "coordinates")
+                    bCoordinates = false;
+                else if (type == 0 && token[0] != '<' && bName)
+                    placemarkName += decodeXMLtext(token);
+                else if (type == 0 && token[0] != '<' && bCoordinates)
+                {
+                    coordinates.clear();
+                    for (i=0; i<token.size(); i=k)
+                    {
+                        for (j=i; j<token.size() && isspace((unsigned char)token[j]); j++);
+                        coordinates.append(token, i, j-i);
+                        for (k=j; k<token.size() && !isspace((unsigned char)token[k]); k++);
+                        if (k == j)
+                            break;
+                        p.id = placemarkName;
+                        p.info = "";
+                        dv = readKMLtuple(token.data()+j, token.data()+k, &p, &dim);
+                        if (processXMLpoint(&CO, GS, circopt, dv, &p, passThrough, &ofs, &nl, &ns))
+                        {
+                            coordinates += writeKMLtuple(p);
+                            if (dim > 2)
+                            {
+                                l = token.rfind(',', k-1);
+                                coordinates.append(token, l, k-l);
+                            }
+                        }
+                        else
+                            coordinates.append(token, j, k-j);
+                    }
+                    if (passThrough)
+                        ofs << coordinates;
+                    continue;
+                }
+            }
+            if (passThrough)
+                ofs << token;
+        }
+        if (!bRoot)
+            throw std::string(":::")+circe::DataValidationText[DV_TAG_NOT_FOUND]+":::\n";
+        if (passThrough)
+            ofs.close();
+        else
+            closeOutputFile(&ofs,circopt);
+        endProcess(&fo, circopt, timer, 1);
+    }
+    catch (std::string str)
+    {
+        writeLog(&fo, CIRCE_ERROR);
+        writeLog(&fo, str);
+        fo.close();
+        throw (str);
+    }
+    fo.close();
+    if (GS->mb==NULL)
+        std::cout << "\r" << std::setw(asString(nl).length()) << " " << "\r";
+    return displayOutput(circopt, OperationMessageText[circe::OM_NB_PROCESSED_POINTS]+": "+asString(ns)+"/"+asString(nl), "{", "}", true);
+}
+
+
+/**
+* \brief Adds a token to a GeoJSON text being transformed, and operates the position it completes (if any).
+* \param[in] CO: The CompoundOperation.
+* \param gs: A pointer to the geojsonScanner.
+* \param[in] token: A token read from the GeoJSON text.
+* \param out: A pointer to the output text.
+* \param nl, ns: Pointers to the numbers of positions read and successfully operated.
+* \remark A position that cannot be operated is left as it is.
+*/
+static void processGeoJSONtoken(CompoundOperation *CO, geojsonScanner *gs, const std::string& token,
+                                std::string *out, unsigned int *nl, unsigned int *ns)
+{
+    pt4d p;
+    if (!addGeoJSONtoken(gs, token, out))
+        return;
+    (*nl)++;
+    if (readGeoJSONposition(*gs, &p) == DV_OK && CO->Operate(&p) == OM_OK)
+    {
+        writeGeoJSONposition(gs, &p, out);
+        (*ns)++;
+    }
+    else
+        writeGeoJSONposition(gs, NULL, out);
+}
+
+/**
+* \brief Operates a chunk of lines of a GeoJSON text sequence (one GeoJSON text per line).
+* \param[in] CO: The CompoundOperation (one instance per thread).
+* \param[in] gs0: The initialized geojsonScanner.
+* \param[in] vLine: The lines.
+* \param[in] bCollection: true if the output is a FeatureCollection, the lines being separated by commas.
+* \param[out] out: The output of the chunk.
+* \param[out] nl, ns: Incremented by the numbers of positions read and successfully operated.
+* \param[out] error: The error message if any.
+*/
+static void processGeoJSONlines(CompoundOperation *CO, const geojsonScanner &gs0, const std::vector<std::string> *vLine,
+                                bool bCollection, std::string *out, unsigned int *nl, unsigned int *ns, std::string *error)
+{
+    geojsonScanner gs = gs0;
+    size_t n;
+    const char *b, *e;
+    try
+    {
+        CO->resetWarmStart();
+        for (std::vector<std::string>::const_iterator itL=vLine->begin(); itL!=vLine->end(); itL++)
+        {
+            b = itL->data();
+            e = b+itL->size();
+            // record separators of RFC 8142 and blank lines
+            while (b < e && (isspace((unsigned char)*b) || *b == '\x1e'))
+                b++;
+            if (b == e)
+                continue;
+            if (bCollection)
+            {
+                while (isspace((unsigned char)e[-1]))
+                    e--;
+                out->append(",\n");
+            }
             else
+                out->append(itL->data(), b-itL->data());
+            resetGeoJSONscanner(&gs);
+            while (b < e)
             {
-                writeOutputLine(&oss, circopt, p, &idt);
-                ns++;
+                if ((n = scanJSONtoken(b, e, true)) == 0)
+                    throw std::string(":::")+DataValidationText[DV_BAD_FORMAT]+":::\n";
+                processGeoJSONtoken(CO, &gs, std::string(b, n), out, nl, ns);
+                b += n;
             }
-            if ((++nl)%1000==0)
+            if (!bCollection)
+                out->append("\n");
+        }
+    }
+    catch (std::string str)
+    {
+        *error = str;
+    }
+}
+
+/**
+* \brief Processes a GeoJSON file or a GeoJSON text sequence (newline-delimited GeoJSON) file.
+* \param[in] circopt: Processing options in a circeOptions structure.
+* \throw str A std:string containing the error message if any. The message is also written in the log file.
+* \remark The file is read as a stream of tokens (see nextJSONtoken), so that the memory used does not depend
+on its size. The positions (the innermost arrays of the coordinates members of the geometries, including
+those of the Multi* geometries and GeometryCollections) are operated with a single CompoundOperation, all
+the other tokens (the properties and any foreign member included) being written as they are. The values of a
+position beyond the third one are left unchanged, as well as a position that cannot be operated.
+The third value is an ellipsoidal height unless a vertical CRS is defined.
+The lines of a GeoJSON text sequence are operated by chunks of IFStreamChunkSize lines, shared between
+circopt.threads threads (0: number of cores), each of them operating its own copy of the CompoundOperation.
+The features of a FeatureCollection are written one per line to a GeoJSON text sequence, and conversely.
+The target format must be GEOJSON or GEOJSONSEQ. Compressed files are read and written as with
+processIFStream.
+* \remark This function is reachable using these kind of options:
+- \-\-sourceCRS=RGF93v2bG. \-\-sourceFormat=GEOJSON.METERS.DEGREES \-\-targetCRS=RGF93LAMB93. \-\-targetFormat=GEOJSON.METERS. \-\-metadataFile="data/DataFRnew.txt" \-\-sourcePathname="./datafile.geojson" \-\-targetPathname="./outfile.geojson"
+*/
+std::string processGeoJSON(const circeOptions &circopt)
+{
+    return processGeoJSON(circopt, NULL, NULL);
+}
+
+std::string processGeoJSON(const circeOptions &circopt, GeodeticSet* GS, swain *swn)
+{
+    time_t timer;
+    std::ifstream ifs;
+    std::istream *fi;
+    std::ofstream ofs;
+    std::ostream *os = &ofs;
+    COMPRESSION sourceCompression = CP_NONE, targetCompression;
+    std::unique_ptr<CompressedIstream> cis;
+    std::unique_ptr<CompressedOstream> cos;
+    std::string token, out, line;
+    unsigned int nl=0, ns=0, nt=1, t;
+    bool bSourceSeq = (circopt.sourceOptions.subformatId == FF_GEOJSONSEQ);
+    bool bTargetSeq = (circopt.targetOptions.subformatId == FF_GEOJSONSEQ);
+    bool bFeature, bFeatures = false;
+    CRS *crs;
+    CRS_TYPE sourceCRStype = CT_GEOGRAPHIC, targetCRStype = CT_GEOGRAPHIC;
+    displayFormat frmt;
+    geojsonScanner gs;
+    jsonReader jr;
+	std::ofstream fo;
+	openLog(&fo, circopt.logPathname);
+	try
+    {
+        time(&timer);
+		initFormats(circopt.displayPrecision, circopt.targetOptions.angularUnit, &frmt);
+        if (circopt.targetOptions.subformatId != FF_GEOJSON && !bTargetSeq)
+            throw ArgumentValidationText[AV_INVALID_ARGUMENT]+": "+circopt.targetOptions.formatId;
+
+        if (swn == NULL || swn->fi == NULL)
+        {
+            sourceCompression = getFileCompression(circopt.sourceOptions.pathname);
+            if (sourceCompression != CP_NONE)
+                ifs.open(circopt.sourceOptions.pathname.data(),std::ifstream::in|std::ifstream::binary);
+            else
+                ifs.open(circopt.sourceOptions.pathname.data(),std::ifstream::in);
+            if (!ifs.is_open())
+                throw ErrorMessageText[EM_CANNOT_OPEN]+circopt.sourceOptions.pathname;
+            fi = &ifs;
+        }
+        else
+            fi = swn->fi;
+        if (sourceCompression != CP_NONE)
+        {
+            cis.reset(new CompressedIstream(fi, sourceCompression));
+            fi = cis.get();
+        }
+
+		if (GS == NULL)
+		{
+			GS = new GeodeticSet();
+			LoadGeodeticSet(circopt.metadataFile, GS, circopt.verbose);
+		}
+        CompoundOperation CO(circopt, *GS);
+        if (CO.getoperationMessage() != OM_OK)
+            throw (OperationMessageText[CO.getoperationMessage()]);
+
+        if ((crs = GS->getCRS(circopt.sourceOptions.geodeticCRSid)) != NULL)
+            sourceCRStype = crs->getCRStype();
+        if ((crs = GS->getCRS(circopt.targetOptions.geodeticCRSid)) != NULL)
+            targetCRStype = crs->getCRStype();
+        initGeoJSONscanner(&gs, sourceCRStype, circopt.sourceOptions.verticalCRSid != "",
+                           targetCRStype, circopt.targetOptions.verticalCRSid != "", frmt, !bSourceSeq && bTargetSeq);
+
+        targetCompression = getPathnameCompression(circopt.targetOptions.pathname);
+        if (targetCompression != CP_NONE)
+            ofs.open(circopt.targetOptions.pathname.data(),std::ofstream::out|std::ofstream::binary);
+        else
+            ofs.open(circopt.targetOptions.pathname.data(),std::ofstream::out);
+        if (!ofs.is_open())
+            throw(DataValidationText[DV_CANNOT_OPEN_OUTPUT])+": "+circopt.targetOptions.pathname;
+        if (targetCompression != CP_NONE)
+        {
+            cos.reset(new CompressedOstream(&ofs, targetCompression));
+            os = cos.get();
+        }
+
+        if (bSourceSeq)
+        {
+            if (circopt.threads > 1)
+                nt = circopt.threads;
+            else if (circopt.threads == 0)
+                nt = std::thread::hardware_concurrency();
+            if (nt == 0 || CO.getuseApprox())
+                nt = 1;
+            std::vector<CompoundOperation> vCOcopy(nt-1, CO);
+            std::vector<CompoundOperation*> vCO(1, &CO);
+            for (t=0; t<nt-1; t++)
+                vCO.push_back(&(vCOcopy[t]));
+            std::vector<std::vector<std::string> > vChunk(nt);
+            std::vector<std::string> vOut(nt), vError(nt);
+            std::vector<unsigned int> vNl(nt), vNs(nt);
+            bool bEOF = false;
+            if (!bTargetSeq)
+                *os << "{\"type\":\"FeatureCollection\",\"features\":[";
+            while (!bEOF)
             {
+                for (t=0; t<nt; t++)
+                {
+                    vChunk[t].clear();
+                    while (vChunk[t].size() < IFStreamChunkSize && !bEOF)
+                    {
+                        if (std::getline(*fi, line))
+                            vChunk[t].push_back(line);
+                        else
+                            bEOF = true;
+                    }
+                    vOut[t].clear();
+                    vError[t].clear();
+                    vNl[t] = vNs[t] = 0;
+                }
+                if (nt == 1)
+                    processGeoJSONlines(vCO[0], gs, &(vChunk[0]), !bTargetSeq, &(vOut[0]),
+                                        &(vNl[0]), &(vNs[0]), &(vError[0]));
+                else
+                {
+                    std::vector<std::thread> vThread;
+                    for (t=0; t<nt; t++)
+                        vThread.push_back(std::thread(processGeoJSONlines, vCO[t], std::cref(gs), &(vChunk[t]),
+                                                      !bTargetSeq, &(vOut[t]), &(vNl[t]), &(vNs[t]), &(vError[t])));
+                    for (t=0; t<nt; t++)
+                        vThread[t].join();
+                }
+                for (t=0; t<nt; t++)
+                {
+                    if (vError[t] != "")
+                        throw (vError[t]);
+                    // the first feature of a FeatureCollection is not preceded by a comma
+                    if (!bTargetSeq && !bFeatures && vOut[t].size() > 0)
+                    {
+                        vOut[t].erase(0, 1);
+                        bFeatures = true;
+                    }
+                    *os << vOut[t];
+                    nl += vNl[t];
+                    ns += vNs[t];
+                }
                 if (GS->mb!=NULL)
                     GS->mb->messageEdit(asString(nl));
                 else
                     std::cout << "\r"+asString(nl);
             }
+            if (!bTargetSeq)
+                *os << "\n]}\n";
         }
-        ofs << oss.str();
-        closeOutputFile(&ofs,circopt);
-        endProcess(&fo, circopt, timer, 1);
+        else
+        {
+            initJSONReader(&jr, fi);
+            while (nextJSONtoken(&jr, &token))
+            {
+                if (!bTargetSeq)
+                {
+                    processGeoJSONtoken(&CO, &gs, token, &out, &nl, &ns);
+                    if (out.size() >= (1<<16))
+                    {
+                        *os << out;
+                        out.clear();
+                    }
+                    continue;
+                }
+                // features written one per line, without the FeatureCollection
+                bFeature = (gs.features > 0 && ((int)gs.vType.size() > gs.features
+                                             || ((int)gs.vType.size() == gs.features && token[0] == '{')));
+                processGeoJSONtoken(&CO, &gs, token, bFeature ? &line : &out, &nl, &ns);
+                if (gs.features > 0)
+                    bFeatures = true;
+                if (bFeature && (int)gs.vType.size() == gs.features && token[0] == '}')
+                {
+                    *os << line << "\n";
+                    line.clear();
+                }
+            }
+            if (gs.vType.size() > 0 || gs.vToken.size() > 0)
+                throw std::string(":::")+DataValidationText[DV_BAD_FORMAT]+":::\n";
+            if (!bTargetSeq)
+                *os << out;
+            else if (!bFeatures)
+                *os << out << "\n";    // a single Feature or geometry on one line
+        }
+        if (cos)
+            cos->close();
+        ofs.close();
+        endProcess(&fo, circopt, timer, nl);
     }
     catch (std::string str)
     {
@@ -743,7 +2040,6 @@ std::string processXMLdoc(const circeOptions &circopt, GeodeticSet* GS, swain *s
     return displayOutput(circopt, OperationMessageText[circe::OM_NB_PROCESSED_POINTS]+": "+asString(ns)+"/"+asString(nl), "{", "}", true);
 }
 
-
 /**
 * \brief Processes automatic tests or operates a set of points from one CRS to various CRSs.
 * \param[in] testPathname: Path to the file containing the list of files to process.
@@ -1296,6 +2592,9 @@ std::string processOptions(circeOptions circopt, GeodeticSet* GS, swain *s)
 		else if (circopt.sourceOptions.subformatId == FF_KML_POINT
 			|| circopt.sourceOptions.subformatId == FF_GPX_POINT)
             return processXMLdoc(circopt, GS,s);
+		else if (circopt.sourceOptions.subformatId == FF_GEOJSON
+			|| circopt.sourceOptions.subformatId == FF_GEOJSONSEQ)
+            return processGeoJSON(circopt, GS,s);
 		else if (circopt.sourceOptions.pathname == "")
 			processPt4d(circopt, GS);
         else if (circopt.processAsVector) //here for test purpose
@@ -68,6 +68,23 @@ Author:
 
 namespace circe
 {
+/**
+* \brief Regular lattice of points in the source CRS, operated by process_lattice.
+Node (i,j) has the source coordinates origin1+i*step1, origin2+j*step2 (longitude and latitude or
+easting and northing, in the source units) and the heights h and w. The nodes are stored row by row
+(rank j*n1+i).
+*/
+struct latticeDefinition
+{
+    double origin1, origin2, step1, step2;
+    unsigned int n1, n2;
+    double h, w;
+    double tolerance; //!< maximum interpolation error in meters (0: every node is operated)
+    unsigned int subsampling; //!< number of steps between two operated nodes of a row or column (tile size)
+    unsigned int threads; //!< number of threads (0: number of cores)
+};
+
+void InitDefLattice(latticeDefinition *lattice);
 bool setFormatDefaults(geodeticOptions *go, GeodeticSet *GS);
 std::string displayDuration(const circeOptions& circopt, time_t timer_beginning);
 void endProcess(std::ofstream *fo, const circeOptions &circopt, time_t timer, unsigned int nl);
@@ -95,10 +112,18 @@ circe::pt4d process_pt4d(circeOptions circopt);
 circe::pt4d process_pt4d(circeOptions circopt, GeodeticSet* GS);
 void process_vector_pt4d(circeOptions circopt, std::vector<pt4d> *vPt4d);
 void process_vector_pt4d(circeOptions circopt, std::vector<pt4d> *vPt4d, GeodeticSet* GS);
+void process_vector_pt4dc(circeOptions circopt, std::vector<pt4dc> *vPt4dc, std::vector<std::string> *vInfo);
+void process_vector_pt4dc(circeOptions circopt, std::vector<pt4dc> *vPt4dc, std::vector<std::string> *vInfo, GeodeticSet* GS);
+void process_lattice(circeOptions circopt, const latticeDefinition &lattice, std::vector<pt4dc> *vPt4dc);
+void process_lattice(circeOptions circopt, const latticeDefinition &lattice, std::vector<pt4dc> *vPt4dc, GeodeticSet* GS);
+void process_lattice_height(circeOptions circopt, const latticeDefinition &lattice, std::vector<double> *vHeight);
+void process_lattice_height(circeOptions circopt, const latticeDefinition &lattice, std::vector<double> *vHeight, GeodeticSet* GS);
 void processPt4d(circeOptions circopt);
 void processPt4d(circeOptions circopt, GeodeticSet* GS);
 std::string processXMLdoc(const circeOptions& circopt);
 std::string processXMLdoc(const circeOptions& circopt, GeodeticSet* GS, swain *swn);
+std::string processGeoJSON(const circeOptions& circopt);
+std::string processGeoJSON(const circeOptions& circopt, GeodeticSet* GS, swain *swn);
 
 std::string getCRSList(circeOptions circopt) /*throw(std::string)*/;
 std::string getGeodeticSubset(operationSubset *OS, circeOptions *CO) /*throw(std::string)*/;
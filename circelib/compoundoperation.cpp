@@ -38,9 +38,17 @@ Author:
 * \brief Implementation of the CompoundOperation class.
 */
 #include "compoundoperation.h"
+#include <mutex>
 
 namespace circe
 {
+/**
+* \brief Serializes the evaluations of the epoch parameters (see getEpochParameters): building
+* an operation modifies the GeodeticSet, which is shared by the copies of a CompoundOperation
+* operated by several threads.
+*/
+static std::mutex epochGSmutex;
+
 /**
 * \brief Destructor.
 */
@@ -67,6 +75,8 @@ CompoundOperation::CompoundOperation(const CompoundOperation &B) : CirceObject(B
     operationMessage = B.operationMessage;
     useCO1only = B.useCO1only;
     useCO2 = B.useCO2;
+    useHelmertFusion = B.useHelmertFusion;
+    fusedCO2Gprec = B.fusedCO2Gprec;
     Description = B.Description;
     TransfoRequired = B.TransfoRequired;
     CurrentCRStype = B.CurrentCRStype;
@@ -75,6 +85,28 @@ CompoundOperation::CompoundOperation(const CompoundOperation &B) : CirceObject(B
     targetLinearUnitId = B.targetLinearUnitId;
     targetAngularUnitId = B.targetAngularUnitId;
     TargetConversion = B.TargetConversion;
+    useApprox = B.useApprox;
+    approxTolerance = B.approxTolerance;
+    approxMaxError = B.approxMaxError;
+    approxSourceCRStype = B.approxSourceCRStype;
+    approxTargetCRStype = B.approxTargetCRStype;
+    approxSourceUnitId = B.approxSourceUnitId;
+    approxLinearUnitId = B.approxLinearUnitId;
+    approxAngularUnitId = B.approxAngularUnitId;
+    approxFields = B.approxFields;
+    vApproxCell = B.vApproxCell;
+    mApproxRoot = B.mApproxRoot;
+    approxRootSize = B.approxRootSize;
+    approxRadius = B.approxRadius;
+    nApproxPoints = B.nApproxPoints;
+    nExactPoints = B.nExactPoints;
+    useEpochCache = B.useEpochCache;
+    epochTargetFollows = B.epochTargetFollows;
+    sourceEpochKey = B.sourceEpochKey;
+    currentEpochKey = B.currentEpochKey;
+    copyOptions(&epochOptions, B.epochOptions);
+    epochGS = B.epochGS;
+    mEpochParameters = B.mEpochParameters;
 }
 
 /**
@@ -88,7 +120,8 @@ void CompoundOperation::reset()
     CO3.reset();
     operationMessage = OM_OK;
     useCO1only = true;
-    useCO2 = false;
+    useCO2 = useHelmertFusion = false;
+    fusedCO2Gprec = 0;
     Description = "";
     TransfoRequired = 0;
     CurrentCRStype = CT_UNDEF;
@@ -97,6 +130,19 @@ void CompoundOperation::reset()
     targetLinearUnitId = MU_UNDEF;
     targetAngularUnitId = MU_UNDEF;
     TargetConversion = NULL;
+    useApprox = false;
+    approxTolerance = approxMaxError = 0.;
+    approxSourceCRStype = approxTargetCRStype = CT_UNDEF;
+    approxSourceUnitId = approxLinearUnitId = approxAngularUnitId = MU_UNDEF;
+    approxFields = "";
+    vApproxCell.clear();
+    mApproxRoot.clear();
+    approxRootSize = approxRadius = 0.;
+    nApproxPoints = nExactPoints = 0;
+    useEpochCache = epochTargetFollows = false;
+    sourceEpochKey = currentEpochKey = 0;
+    epochGS = NULL;
+    mEpochParameters.clear();
 }
 
 /**
@@ -136,6 +182,15 @@ CompoundOperation::CompoundOperation(const circeOptions &circopt, GeodeticSet& G
     circeOptions circopt1, circopt2, circopt3;
 
     std::string idGp = GS.getKeyGeodeticFrame();
+    useCO2 = useHelmertFusion = false;
+    fusedCO2Gprec = 0;
+    TransfoRequired = 0;
+    useApprox = false;
+    approxMaxError = 0.;
+    nApproxPoints = nExactPoints = 0;
+    useEpochCache = epochTargetFollows = false;
+    sourceEpochKey = currentEpochKey = 0;
+    epochGS = NULL;
     CO1.Init(circopt, GS);
     if (CO1.getoperationMessage() == OM_OK)
     {
@@ -152,6 +207,11 @@ CompoundOperation::CompoundOperation(const circeOptions &circopt, GeodeticSet& G
     {
         operationMessage = CO1.getoperationMessage();
         useCO1only = true;
+        if (operationMessage == OM_OK)
+        {
+            initApprox(circopt);
+            initEpochCache(circopt, GS);
+        }
         return;
     }
     // Here the CRS ids are valid (if not, the function has already returned) so the following lines must work !
@@ -249,6 +309,20 @@ CompoundOperation::CompoundOperation(const circeOptions &circopt, GeodeticSet& G
             useCO2 = true;
         }
 
+        //source => hub [=> hub] => target made of constant Helmert transformations only: they are
+        //fused into a single matrix applied by CO1, and the hub coordinates are never calculated.
+        useHelmertFusion = CO1.isHelmertStep() && CO3.isHelmertStep() && (!useCO2 || CO2.isHelmertStep());
+        if (useHelmertFusion)
+        {
+            if (useCO2)
+            {
+                CO1.fuseHelmertStep(&CO2);
+                fusedCO2Gprec = CO2.getvRelevantGeodeticTransfo()[0].getPrecisionCodeInit();
+            }
+            CO1.fuseHelmertStep(&CO3);
+            CO3.setbHelmertStepDone(true);
+        }
+
 /*    }
     else if (CO1.getTransfoRequired()&T_VERTICAL_REQUIRED)
     {
@@ -293,6 +367,8 @@ CompoundOperation::CompoundOperation(const circeOptions &circopt, GeodeticSet& G
     else
         Description = CO1.displayDescription(circopt1,"source")+CO3.displayDescription(circopt3,"via_source");
     operationMessage = OM_OK;
+    initApprox(circopt);
+    initEpochCache(circopt, GS);
     return;
 }
 
@@ -319,11 +395,206 @@ int combinePrecision(int prec1, int prec2)
 * \return An OPERATION_MESSAGE which is a code for an error message if it is not OM_OK.
 */
 OPERATION_MESSAGE CompoundOperation::Operate(pt4d*p1)
+{
+    if (useEpochCache)
+        return OperateAtEpoch(p1);
+    if (useApprox)
+        return OperateApprox(p1);
+    return OperateExact(p1);
+}
+
+/**
+* \brief Operates np pt4dc like Operate, with the batch kernels if the operation is a single batchable
+* CatOperation or a fusion of Helmert transformations (see CatOperation::isBatchable), and without the
+* approximate mode nor per-point epochs.
+* \param[in] np: The number of points.
+* \param vp (input and output): The pt4dc to be operated.
+* \param[out] ok: Non-zero for the points operated (OM_OK). The other ones are left unchanged and must be
+* operated by Operate, which also returns their error message.
+*/
+void CompoundOperation::OperateMany(unsigned int np, pt4dc *vp, char *ok)
+{
+    unsigned int i;
+    for (i=0; i<np; i++)
+        ok[i] = 0;
+    if (operationMessage != OM_OK || useEpochCache || useApprox)
+        return;
+    if (useCO1only)
+    {
+        if (!CO1.isBatchable())
+            return;
+        for (i=0; i<np; i++)
+            ok[i] = 1;
+        CO1.OperateMany(np, vp, ok);
+        for (i=0; i<np; i++)
+            if (ok[i])
+                vp[i].transfoIndex = TransfoRequired;
+        getCurrentState(&CO1);
+        return;
+    }
+    if (!useHelmertFusion || !CO1.isBatchable() || !CO3.isBatchable())
+        return;
+    //See OperateExact
+    std::vector<pt4dc> vq(vp, vp+np);
+    std::vector<int> vGprec(np), vVprec(np);
+    for (i=0; i<np; i++)
+        ok[i] = 1;
+    CO1.OperateMany(np, vq.data(), ok);
+    for (i=0; i<np; i++)
+    {
+        vGprec[i] = useCO2 ? combinePrecision(fusedCO2Gprec,vq[i].Gprec) : vq[i].Gprec;
+        vVprec[i] = vq[i].Vprec;
+    }
+    CO3.OperateMany(np, vq.data(), ok);
+    for (i=0; i<np; i++)
+    {
+        if (!ok[i])
+            continue;
+        pt4dc &pc = vq[i];
+        if (TransfoRequired&T_GEODETIC_REQUIRED)
+        {
+            pc.Gprec = combinePrecision(pc.Gprec,vGprec[i]);
+            pc.Vprec = combinePrecision(pc.Vprec,vVprec[i]);
+        }
+        else
+        {
+            if (vVprec[i] == 0)
+                pc.Vprec = combinePrecision(pc.Vprec,vGprec[i]);
+            else
+                pc.Vprec = combinePrecision(pc.Gprec,vVprec[i]);
+            pc.Gprec = 0;
+        }
+        pc.transfoIndex = TransfoRequired;
+        vp[i] = pc;
+    }
+    getCurrentState(&CO3);
+}
+
+/**
+* \brief Initializes the per-point epoch processing (a 'T' field in the source data format).
+* It only applies to a 4D source frame. The epoch of a point replaces the source epoch of
+* the job and, if the job has the same source and target epochs, the target epoch too.
+* \param[in] circopt: The circeOptions used to build the CompoundOperation.
+* \param[in] GS: The GeodeticSet used to build the CompoundOperation (kept to evaluate the
+* parameters at other epochs, it must outlive the CompoundOperation).
+*/
+void CompoundOperation::initEpochCache(const circeOptions &circopt, GeodeticSet& GS)
+{
+    mEpochParameters.clear();
+    useEpochCache = false;
+    if (circopt.sourceOptions.formatId.find_first_of('T') == std::string::npos)
+        return;
+    if (((GeodeticReferenceFrame*)(GS.getCRS(circopt.sourceOptions.geodeticCRSid)->getReferenceFrame()))->getSystemDimension() != SD_4D)
+        return;
+    useEpochCache = true;
+    epochTargetFollows = circopt.targetOptions.epoch == circopt.sourceOptions.epoch;
+    currentEpochKey = sourceEpochKey = llround(circopt.sourceOptions.epoch/EPOCH_CACHE_RESOLUTION);
+    copyOptions(&epochOptions, circopt);
+    // Only the parameters are taken from the operations built at other epochs: the grids
+    // are neither loaded nor inverted again, and no approximation is built.
+    epochOptions.gridLoading = LoadingTypeText[LD_HEADER];
+    epochOptions.inverseGrids = false;
+    epochOptions.approxTolerance = 0.;
+    epochGS = &GS;
+    epochParameters &ep = mEpochParameters[sourceEpochKey];
+    ep.om = OM_OK;
+    ep.useCO2 = useCO2;
+    CO1.getEpochParameters(&(ep.values[0]));
+    CO2.getEpochParameters(&(ep.values[1]));
+    CO3.getEpochParameters(&(ep.values[2]));
+}
+
+/**
+* \brief Evaluates the parameters of the operation at another epoch. An operation is built at
+* this epoch with the grid headers only, and it must be made of the same steps. It is thread-safe
+* (the copies of this operation share epochGS).
+* \param[in] key: The epoch (in EPOCH_CACHE_RESOLUTION units).
+* \param[out] ep: Pointer to the epochParameters.
+*/
+void CompoundOperation::getEpochParameters(long long key, epochParameters *ep)
+{
+    circeOptions circopt;
+    copyOptions(&circopt, epochOptions);
+    circopt.sourceOptions.epoch = key*EPOCH_CACHE_RESOLUTION;
+    if (epochTargetFollows)
+        circopt.targetOptions.epoch = circopt.sourceOptions.epoch;
+    std::lock_guard<std::mutex> lock(epochGSmutex);
+    CompoundOperation EO(circopt, *epochGS);
+    ep->om = EO.operationMessage;
+    ep->useCO2 = EO.useCO2;
+    if (ep->om != OM_OK)
+        return;
+    EO.CO1.getEpochParameters(&(ep->values[0]));
+    EO.CO2.getEpochParameters(&(ep->values[1]));
+    EO.CO3.getEpochParameters(&(ep->values[2]));
+    // No epoch change between the hub frames (CO2) is the only structural difference accepted.
+    const epochParameters &ep0 = mEpochParameters[sourceEpochKey];
+    if (EO.useCO1only != useCO1only || EO.useHelmertFusion != useHelmertFusion || (EO.useCO2 && !useCO2)
+     || ep->values[0].size() != ep0.values[0].size() || ep->values[2].size() != ep0.values[2].size()
+     || (EO.useCO2 && ep->values[1].size() != ep0.values[1].size()))
+        ep->om = OM_SOURCE_EPOCH_FRAME_NOT_VALID;
+}
+
+/**
+* \brief Sets the parameters of the operation for an epoch (see getEpochParameters).
+* \param[in] ep: The epochParameters.
+*/
+void CompoundOperation::setEpochParameters(const epochParameters &ep)
+{
+    CO1.setEpochParameters(ep.values[0]);
+    if (ep.useCO2)
+        CO2.setEpochParameters(ep.values[1]);
+    CO3.setEpochParameters(ep.values[2]);
+    useCO2 = ep.useCO2;
+}
+
+/**
+* \brief Operates a pt4d with an epoch (the source epoch of the job if it is null).
+* The transformation parameters depend on the epoch (rates, motion models). They are
+* evaluated once per distinct epoch (rounded to EPOCH_CACHE_RESOLUTION), kept in a cache
+* and set in this operation, whose loaded grids are shared by all the epochs.
+* \param p1 (input and output): Pointer to the pt4d to be operated.
+* \return An OPERATION_MESSAGE which is a code for an error message if it is not OM_OK.
+*/
+OPERATION_MESSAGE CompoundOperation::OperateAtEpoch(pt4d*p1)
+{
+    long long key = p1->t != 0. ? llround(p1->t/EPOCH_CACHE_RESOLUTION) : sourceEpochKey;
+    if (key != currentEpochKey)
+    {
+        std::map<long long,epochParameters>::iterator itEP = mEpochParameters.find(key);
+        if (itEP == mEpochParameters.end())
+        {
+            // Points are usually sorted by epoch: the cache is simply emptied when full
+            // (except the parameters at the source epoch of the job).
+            if (mEpochParameters.size() >= EPOCH_CACHE_MAX)
+            {
+                epochParameters ep0 = mEpochParameters[sourceEpochKey];
+                mEpochParameters.clear();
+                mEpochParameters[sourceEpochKey] = ep0;
+            }
+            itEP = mEpochParameters.insert(std::make_pair(key, epochParameters())).first;
+            getEpochParameters(key, &(itEP->second));
+        }
+        if (itEP->second.om != OM_OK)
+            return itEP->second.om;
+        setEpochParameters(itEP->second);
+        currentEpochKey = key;
+    }
+    // The approximation is built at the source epoch of the job.
+    if (useApprox && key == sourceEpochKey)
+        return OperateApprox(p1);
+    return OperateExact(p1);
+}
+
+/**
+* \brief Operates a pt4d from the source CRS to the target CRS with the full processing chain.
+* \param p1 (input and output): Pointer to the pt4d to be operated.
+* \return An OPERATION_MESSAGE which is a code for an error message if it is not OM_OK.
+*/
+OPERATION_MESSAGE CompoundOperation::OperateExact(pt4d*p1)
 {
     OPERATION_MESSAGE om;
-    pt4d p2;
     p1->transfoIndex = TransfoRequired;
-    copyPt4d(&p2, *p1);
     if ( (om = operationMessage) != OM_OK || ((om = CO1.Operate(p1)) != OM_OK) || useCO1only )
     {
         getCurrentState(&CO1);
@@ -331,7 +602,9 @@ OPERATION_MESSAGE CompoundOperation::Operate(pt4d*p1)
     }
     int Gprecode = p1->Gprec;
     int Vprecode = p1->Vprec;
-    if (useCO2)
+    if (useCO2 && useHelmertFusion)
+        Gprecode = combinePrecision(fusedCO2Gprec,Gprecode);
+    else if (useCO2)
     {
         if ((om = CO2.Operate(p1)) != OM_OK)
         {
@@ -359,6 +632,399 @@ OPERATION_MESSAGE CompoundOperation::Operate(pt4d*p1)
     return om;
 }
 
+/**
+* \brief Initializes the approximate mode (--approx option).
+* The approximation is only used for geographic or projected source coordinates, without
+* any extra output (convergence, scale factor, deflection) nor transformation follow-up,
+* and not with DMS or DM units whose coded values are not continuous.
+* The target coordinates compared by Distance() are also initialized here.
+* \param[in] circopt: The circeOptions used to build the CompoundOperation.
+*/
+void CompoundOperation::initApprox(const circeOptions &circopt)
+{
+    const CatOperation &COt = useCO1only ? CO1 : CO3;
+    approxTolerance = circopt.approxTolerance;
+    approxMaxError = 0.;
+    vApproxCell.clear();
+    mApproxRoot.clear();
+    nApproxPoints = nExactPoints = 0;
+    useApprox = approxTolerance > 0. && !circopt.extraOut && !circopt.followUpTransfos;
+    approxSourceCRStype = CO1.getCurrentCRStype();
+    approxTargetCRStype = COt.getTargetGeodeticCRS()->getCRStype();
+    approxLinearUnitId = COt.getTargetLinearUnitId();
+    approxAngularUnitId = COt.getTargetAngularUnitId();
+    approxRadius = COt.getTargetConversion() ? COt.getTargetConversion()->get_a() : 6378137.;
+    // The quadtree roots are 1 degree or 100 km wide.
+    if (approxSourceCRStype == CT_GEOGRAPHIC)
+    {
+        approxSourceUnitId = CO1.getSourceAngularUnitId();
+        if (approxSourceUnitId == MU_DMS || approxSourceUnitId == MU_DM)
+            useApprox = false;
+        else
+            approxRootSize = UnitConvert(1., MU_DEGREE, approxSourceUnitId);
+    }
+    else if (approxSourceCRStype == CT_PROJECTED)
+    {
+        approxSourceUnitId = CO1.getSourceLinearUnitId();
+        approxRootSize = UnitConvert(100000., MU_METER, approxSourceUnitId);
+    }
+    else
+        useApprox = false;
+    if (approxTargetCRStype == CT_GEOCENTRIC)
+        approxFields = "XYZHV";
+    else if (approxTargetCRStype == CT_GEOGRAPHIC)
+    {
+        approxFields = "LPHV";
+        if (approxAngularUnitId == MU_DMS || approxAngularUnitId == MU_DM)
+            useApprox = false;
+    }
+    else if (approxTargetCRStype == CT_PROJECTED)
+        approxFields = "ENHV";
+    else
+    {
+        approxFields = "";
+        useApprox = false;
+    }
+}
+
+/**
+* \brief Gets a pointer to a coordinate of a pt4d.
+* \param[in] p: Pointer to the pt4d.
+* \param[in] c: The coordinate as a format character (V for the vertical coordinate).
+* \return A pointer to the coordinate.
+*/
+double* approxField(pt4d *p, char c)
+{
+    switch (c)
+    {
+    case 'X': return &(p->x);
+    case 'Y': return &(p->y);
+    case 'Z': return &(p->z);
+    case 'L': return &(p->l);
+    case 'P': return &(p->p);
+    case 'E': return &(p->e);
+    case 'N': return &(p->n);
+    case 'H': return &(p->h);
+    default: return &(p->w);
+    }
+}
+
+/**
+* \brief Computes the Lagrange basis polynomials of the approximation nodes.
+* \param[in] s: Normalized coordinate in the cell (0 to 1).
+* \param[out] L: The APPROX_DEGREE+1 values of the basis polynomials at s.
+*/
+void approxBasis(double s, double *L)
+{
+    for (int i=0; i<=APPROX_DEGREE; i++)
+    {
+        L[i] = 1.;
+        for (int m=0; m<=APPROX_DEGREE; m++)
+            if (m != i)
+                L[i] *= (s*APPROX_DEGREE-m)/(i-m);
+    }
+}
+
+/**
+* \brief Interpolates the operated coordinates in an approximation cell.
+* \param[in] cell: The fitted approxCell.
+* \param[in] nf: Number of coordinates.
+* \param[in] s, t: Normalized horizontal coordinates in the cell (0 to 1).
+* \param[in] dh, dw: Ellipsoidal and vertical heights relative to APPROX_HEIGHT_MAX.
+* \param[out] val: The nf interpolated coordinates.
+*/
+void approxEvaluate(const approxCell &cell, int nf, double s, double t, double dh, double dw, double *val)
+{
+    double Ls[APPROX_DEGREE+1], Lt[APPROX_DEGREE+1], c;
+    const double *nd = cell.nodes.data();
+    approxBasis(s, Ls);
+    approxBasis(t, Lt);
+    for (int k=0; k<nf; k++)
+        val[k] = 0.;
+    for (int j=0; j<=APPROX_DEGREE; j++)
+    for (int i=0; i<=APPROX_DEGREE; i++)
+    {
+        int n = j*(APPROX_DEGREE+1)+i;
+        c = Ls[i]*Lt[j];
+        for (int k=0; k<nf; k++)
+            val[k] += c*(nd[(3*k)*APPROX_NODES+n] + dh*nd[(3*k+1)*APPROX_NODES+n]
+                                                  + dw*nd[(3*k+2)*APPROX_NODES+n]);
+    }
+}
+
+/**
+* \brief Operates a sample point of an approximation cell with the full processing chain.
+* \param[in] u, v: Horizontal source coordinates.
+* \param[in] h, w: Ellipsoidal and vertical source heights.
+* \param[out] val: The operated coordinates listed in approxFields.
+* \param[in,out] cell: The approxCell, whose precision codes and vertical info are set from the first sample.
+* \param[in] first: true for the first sample of the cell.
+* \return false if the operation failed or gave precision codes or vertical info different from those of the cell.
+*/
+bool CompoundOperation::sampleApprox(double u, double v, double h, double w, double *val, approxCell *cell, bool first)
+{
+    pt4d p;
+    InitDefPoint(&p);
+    if (approxSourceCRStype == CT_GEOGRAPHIC)
+    {
+        p.l = u;
+        p.p = v;
+    }
+    else
+    {
+        p.e = u;
+        p.n = v;
+    }
+    p.h = h;
+    p.w = w;
+    if (OperateExact(&p) != OM_OK)
+        return false;
+    for (unsigned int k=0; k<approxFields.size(); k++)
+        val[k] = *approxField(&p, approxFields[k]);
+    if (first)
+    {
+        cell->Gprec = p.Gprec;
+        cell->Vprec = p.Vprec;
+        cell->CRStypeInit = p.CRStypeInit;
+        cell->info = p.info;
+        cell->info2 = p.info2;
+        return true;
+    }
+    return p.Gprec == cell->Gprec && p.Vprec == cell->Vprec
+        && p.info == cell->info && p.info2 == cell->info2;
+}
+
+/**
+* \brief Computes the distance in meters between two sets of operated coordinates.
+* Angular differences are converted to meters on the target ellipsoid.
+* \return The maximum absolute difference in meters.
+*/
+double CompoundOperation::approxDistance(const double *val1, const double *val2) const
+{
+    double d, dmax = 0.;
+    for (unsigned int k=0; k<approxFields.size(); k++)
+    {
+        d = fabs(val1[k]-val2[k]);
+        if (approxFields[k] == 'L' || approxFields[k] == 'P')
+            d = UnitConvert(d, approxAngularUnitId, MU_RADIAN)*approxRadius;
+        else if (approxLinearUnitId != MU_UNDEF)
+            d = UnitConvert(d, approxLinearUnitId, MU_METER);
+        if (d > dmax || d != d)
+            dmax = d;
+    }
+    return dmax;
+}
+
+/**
+* \brief Computes the distance in meters between two operated pt4d.
+* Only the coordinates of the target CRS type and the heights are compared.
+* \return The maximum absolute difference in meters.
+*/
+double CompoundOperation::Distance(pt4d *p1, pt4d *p2) const
+{
+    double val1[8], val2[8];
+    for (unsigned int k=0; k<approxFields.size(); k++)
+    {
+        val1[k] = *approxField(p1, approxFields[k]);
+        val2[k] = *approxField(p2, approxFields[k]);
+    }
+    return approxDistance(val1, val2);
+}
+
+/**
+* \brief Initializes an approximation cell, not built yet.
+* \param cell: A pointer to the approxCell.
+* \param[in] u0, v0: The lower corner of the cell.
+* \param[in] size: The size of the cell.
+* \param[in] level: The depth of the cell in the quadtree.
+*/
+static void initApproxCell(approxCell *cell, double u0, double v0, double size, int level)
+{
+    cell->u0 = u0;
+    cell->v0 = v0;
+    cell->size = size;
+    cell->level = level;
+    for (int q=0; q<4; q++)
+        cell->child[q] = -1;
+    cell->state = AC_UNBUILT;
+    cell->maxError = 0.;
+    cell->Gprec = cell->Vprec = 0;
+    cell->CRStypeInit = CT_UNDEF;
+}
+
+/**
+* \brief Builds an approximation cell.
+* The operated coordinates are sampled at the interpolation nodes, at null height and at
+* APPROX_HEIGHT_MAX for each height, then checked against the full processing chain on a
+* twice denser grid ((2*APPROX_DEGREE+1)^2 points), at null heights and at both height bounds.
+* The cell is fitted if the maximum error on these samples is within the tolerance, else it
+* is split (or processed exactly beyond APPROX_MAX_LEVEL or if no node can be operated).
+* This is a sampled error estimate, not a strict bound: the error between the samples is
+* not checked.
+* \param[in] ic: Index of the cell in vApproxCell.
+*/
+void CompoundOperation::buildApproxCell(unsigned int ic)
+{
+    approxCell cell = vApproxCell[ic];
+    const int nf = approxFields.size();
+    const double H = APPROX_HEIGHT_MAX;
+    double val[3][8], ref[8], chk[8], u, v, err, maxError = 0.;
+    int nOK = 0, n;
+    bool ok = true;
+
+    cell.nodes.resize(3*nf*APPROX_NODES);
+    for (int j=0; j<=APPROX_DEGREE; j++)
+    for (int i=0; i<=APPROX_DEGREE; i++)
+    {
+        n = j*(APPROX_DEGREE+1)+i;
+        u = cell.u0 + cell.size*i/APPROX_DEGREE;
+        v = cell.v0 + cell.size*j/APPROX_DEGREE;
+        if (!sampleApprox(u, v, 0., 0., val[0], &cell, nOK == 0 && ok)
+         || !sampleApprox(u, v, H, 0., val[1], &cell, false)
+         || !sampleApprox(u, v, 0., H, val[2], &cell, false))
+        {
+            ok = false;
+            continue;
+        }
+        nOK++;
+        for (int k=0; k<nf; k++)
+        {
+            cell.nodes[(3*k)*APPROX_NODES+n] = val[0][k];
+            cell.nodes[(3*k+1)*APPROX_NODES+n] = val[1][k]-val[0][k];
+            cell.nodes[(3*k+2)*APPROX_NODES+n] = val[2][k]-val[0][k];
+        }
+    }
+    for (int j=0; j<=2*APPROX_DEGREE && ok; j++)
+    for (int i=0; i<=2*APPROX_DEGREE && ok; i++)
+    for (int ih=-1; ih<=1 && ok; ih++)
+    {
+        // The nodes are exact at null heights.
+        if (ih == 0 && i%2 == 0 && j%2 == 0)
+            continue;
+        u = cell.u0 + cell.size*i/(2*APPROX_DEGREE);
+        v = cell.v0 + cell.size*j/(2*APPROX_DEGREE);
+        if (!sampleApprox(u, v, ih*H, ih*H, ref, &cell, false))
+        {
+            ok = false;
+            break;
+        }
+        approxEvaluate(cell, nf, double(i)/(2*APPROX_DEGREE), double(j)/(2*APPROX_DEGREE), ih, ih, chk);
+        err = approxDistance(ref, chk);
+        if (err > maxError || err != err)
+            maxError = err;
+        if (!(maxError <= approxTolerance))
+            ok = false;
+    }
+    if (ok)
+    {
+        cell.state = AC_FITTED;
+        cell.maxError = maxError;
+        if (maxError > approxMaxError)
+            approxMaxError = maxError;
+    }
+    else
+    {
+        cell.nodes.clear();
+        if (nOK == 0 || cell.level >= APPROX_MAX_LEVEL)
+            cell.state = AC_EXACT;
+        else
+        {
+            cell.state = AC_SPLIT;
+            for (int q=0; q<4; q++)
+            {
+                approxCell child;
+                initApproxCell(&child, cell.u0 + (q%2)*cell.size/2., cell.v0 + (q/2)*cell.size/2.,
+                               cell.size/2., cell.level+1);
+                cell.child[q] = vApproxCell.size();
+                vApproxCell.push_back(child);
+            }
+        }
+    }
+    vApproxCell[ic] = cell;
+}
+
+/**
+* \brief Operates a pt4d from the source CRS to the target CRS in the approximate mode.
+* The cell of the quadtree containing the point is built on first use. Points in cells
+* which could not be fitted, and points whose heights are beyond APPROX_HEIGHT_MAX,
+* are operated with the full processing chain.
+* \param p1 (input and output): Pointer to the pt4d to be operated.
+* \return An OPERATION_MESSAGE which is a code for an error message if it is not OM_OK.
+*/
+OPERATION_MESSAGE CompoundOperation::OperateApprox(pt4d*p1)
+{
+    double u, v, val[8];
+    if (approxSourceCRStype == CT_GEOGRAPHIC)
+    {
+        u = p1->l;
+        v = p1->p;
+    }
+    else
+    {
+        u = p1->e;
+        v = p1->n;
+    }
+    if (!(fabs(p1->h) <= APPROX_HEIGHT_MAX && fabs(p1->w) <= APPROX_HEIGHT_MAX
+       && fabs(u) < 1e6*approxRootSize && fabs(v) < 1e6*approxRootSize))
+    {
+        nExactPoints++;
+        return OperateExact(p1);
+    }
+    std::pair<int,int> key((int)floor(u/approxRootSize), (int)floor(v/approxRootSize));
+    std::map<std::pair<int,int>,int>::iterator itR = mApproxRoot.find(key);
+    unsigned int ic;
+    if (itR != mApproxRoot.end())
+        ic = itR->second;
+    else
+    {
+        approxCell root;
+        initApproxCell(&root, key.first*approxRootSize, key.second*approxRootSize, approxRootSize, 0);
+        ic = vApproxCell.size();
+        vApproxCell.push_back(root);
+        mApproxRoot[key] = ic;
+    }
+    while (true)
+    {
+        if (vApproxCell[ic].state == AC_UNBUILT)
+            buildApproxCell(ic);
+        const approxCell &cell = vApproxCell[ic];
+        if (cell.state != AC_SPLIT)
+            break;
+        ic = cell.child[(u >= cell.u0+cell.size/2.) + 2*(v >= cell.v0+cell.size/2.)];
+    }
+    const approxCell &cell = vApproxCell[ic];
+    if (cell.state == AC_EXACT)
+    {
+        nExactPoints++;
+        return OperateExact(p1);
+    }
+    approxEvaluate(cell, approxFields.size(), (u-cell.u0)/cell.size, (v-cell.v0)/cell.size,
+                   p1->h/APPROX_HEIGHT_MAX, p1->w/APPROX_HEIGHT_MAX, val);
+    for (unsigned int k=0; k<approxFields.size(); k++)
+        *approxField(p1, approxFields[k]) = val[k];
+    p1->transfoIndex = TransfoRequired;
+    p1->CRStypeInit = cell.CRStypeInit;
+    p1->Gprec = cell.Gprec;
+    p1->Vprec = cell.Vprec;
+    p1->info = cell.info;
+    p1->info2 = cell.info2;
+    nApproxPoints++;
+    return OM_OK;
+}
+
+/**
+* \brief Displays the outcome of the approximate mode.
+* \return The tolerance, the maximum error estimated on the samples of the cells used,
+* and the numbers of interpolated and exactly operated points, empty if the mode is off.
+*/
+std::string CompoundOperation::displayApproxReport() const
+{
+    if (!useApprox)
+        return "";
+    return "Approximation: tolerance " + asString(approxTolerance) + " m, max sampled error "
+         + asString(approxMaxError) + " m, " + asString(nApproxPoints) + " interpolated / "
+         + asString(nExactPoints) + " exact points, " + asString((unsigned int)vApproxCell.size()) + " cells\n";
+}
 
 /**
 * \brief Writes the values of the transformations actually used to perform the operation.
@@ -377,6 +1043,80 @@ std::string CompoundOperation::followUpTransfos()
     return str;
 }
 
+/**
+* \brief Accumulates the iteration counts of the grid solver (F_TARGET grids).
+* \param[in,out] histogram: histogram[n] is incremented by the number of points solved with n interpolations.
+*/
+void CompoundOperation::getIterationHistogram(std::vector<unsigned int> *histogram) const
+{
+    CO1.getIterationHistogram(histogram);
+    if (!useCO1only)
+    {
+        if (useCO2)
+            CO2.getIterationHistogram(histogram);
+        CO3.getIterationHistogram(histogram);
+    }
+}
+
+/**
+* \brief Resets the warm start of the grid solver (F_TARGET grids), so that the next point
+* is operated regardless of the previous ones.
+*/
+void CompoundOperation::resetWarmStart()
+{
+    CO1.resetWarmStart();
+    CO2.resetWarmStart();
+    CO3.resetWarmStart();
+}
+
+/**
+* \brief Displays the histogram of the number of grid interpolations per point required by
+* the grid transformations expressed in the target frame (F_TARGET).
+* \param[in] vCO: copies of this operation (processing threads) whose histograms are added, if not NULL.
+* \return The histogram as a std::string, empty if no such grid was used.
+*/
+std::string CompoundOperation::displayIterationHistogram(const std::vector<CompoundOperation> *vCO) const
+{
+    std::vector<unsigned int> histogram;
+    unsigned int n = 0, sum = 0;
+    std::string str = "";
+    getIterationHistogram(&histogram);
+    if (vCO != NULL)
+        for (unsigned int i=0; i<vCO->size(); i++)
+            (*vCO)[i].getIterationHistogram(&histogram);
+    for (unsigned int i=0; i<histogram.size(); i++)
+    {
+        if (histogram[i] == 0)
+            continue;
+        str += " " + asString(i) + ":" + asString(histogram[i]);
+        n += histogram[i];
+        sum += i*histogram[i];
+    }
+    if (n == 0)
+        return "";
+    return "Grid solver iterations:" + str + " (mean " + asString(double(sum)/n, 2) + ")\n";
+}
+
+/**
+* \brief Displays the inverse grids derived at loading (see Transformation::InitInverseGrid).
+* \return The number of inverse grids and their maximum round-trip residual, empty if there is none.
+*/
+std::string CompoundOperation::displayInverseGridReport() const
+{
+    double residual = 0.;
+    int count = 0;
+    CO1.getInverseResidual(&residual, &count);
+    if (!useCO1only)
+    {
+        if (useCO2)
+            CO2.getInverseResidual(&residual, &count);
+        CO3.getInverseResidual(&residual, &count);
+    }
+    if (count == 0)
+        return "";
+    return "Inverse grids: " + asString(count) + ", max residual " + asString(residual) + " m\n";
+}
+
 /**
 * \brief Displays the description of the source, hub and target CRSs.
 * \return The description.
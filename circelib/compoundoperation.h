@@ -41,10 +41,60 @@ Author:
 #define COMPOUNDOPERATION_H
 
 #include "catoperation.h"
+#include <map>
 
 namespace circe
 {
 
+/** \brief Degree of the interpolating polynomials of the approximate mode.*/
+#define APPROX_DEGREE 3
+/** \brief Number of interpolation nodes of an approximation cell.*/
+#define APPROX_NODES ((APPROX_DEGREE+1)*(APPROX_DEGREE+1))
+/** \brief Maximum subdivision level of the approximation quadtree.*/
+#define APPROX_MAX_LEVEL 10
+/** \brief Heights (in the source linear unit) bounding the validity of the approximation.*/
+#define APPROX_HEIGHT_MAX 5000.
+
+/** \brief Resolution (in decimal years) of the point epochs keying the epoch cache.*/
+#define EPOCH_CACHE_RESOLUTION 1e-4
+/** \brief Maximum number of epochs kept in the epoch cache.*/
+#define EPOCH_CACHE_MAX 64
+
+/** \brief State of an approximation cell.*/
+enum APPROX_CELL_STATE
+{
+    AC_UNBUILT,
+    AC_FITTED,
+    AC_SPLIT,
+    AC_EXACT
+};
+
+/**
+* \brief Cell of the quadtree used by the approximate mode of CompoundOperation.
+* The operated coordinates are interpolated on the cell by a tensor product of Lagrange
+* polynomials, for null heights and for a unit change of each height (ellipsoidal and vertical).
+*/
+struct approxCell
+{
+    double u0, v0, size, maxError;     // maxError: estimated on the check samples
+    int level, child[4];
+    APPROX_CELL_STATE state;
+    std::vector<double> nodes;
+    int Gprec, Vprec;
+    CRS_TYPE CRStypeInit;
+    std::string info, info2;
+};
+
+/**
+* \brief Parameters of a CompoundOperation that depend on the epoch of the points (see OperateAtEpoch).
+*/
+struct epochParameters
+{
+    OPERATION_MESSAGE om;
+    bool useCO2;
+    std::vector<double> values[3]; // CO1, CO2, CO3 (see CatOperation::getEpochParameters)
+};
+
 /**
 * \brief This class is directly used by Circe API, high-level and convenience functions to initialize and apply a composition of concatenated operations.
 */
@@ -53,12 +103,38 @@ class CompoundOperation : public CirceObject
 private:
     CatOperation CO1, CO2, CO3;
     OPERATION_MESSAGE operationMessage;
-    bool useCO1only, useCO2;
+    bool useCO1only, useCO2, useHelmertFusion;
+    int fusedCO2Gprec;
     std::string Description;
     int TransfoRequired;
     CRS_TYPE CurrentCRStype, TargetCRStype1, TargetCRStype2;
     MEASURE_UNIT targetLinearUnitId, targetAngularUnitId;
     Conversion *TargetConversion;
+    bool useApprox;
+    double approxTolerance, approxMaxError;
+    CRS_TYPE approxSourceCRStype, approxTargetCRStype;
+    MEASURE_UNIT approxSourceUnitId, approxLinearUnitId, approxAngularUnitId;
+    std::string approxFields;
+    std::vector<approxCell> vApproxCell;
+    std::map<std::pair<int,int>,int> mApproxRoot;
+    double approxRootSize, approxRadius;
+    unsigned int nApproxPoints, nExactPoints;
+    bool useEpochCache, epochTargetFollows;
+    long long sourceEpochKey, currentEpochKey;
+    circeOptions epochOptions;
+    GeodeticSet *epochGS;
+    std::map<long long,epochParameters> mEpochParameters;
+
+    void initApprox(const circeOptions &circopt);
+    void initEpochCache(const circeOptions &circopt, GeodeticSet& GS);
+    void getEpochParameters(long long key, epochParameters *ep);
+    void setEpochParameters(const epochParameters &ep);
+    OPERATION_MESSAGE OperateAtEpoch(pt4d*p1);
+    OPERATION_MESSAGE OperateExact(pt4d*p1);
+    OPERATION_MESSAGE OperateApprox(pt4d*p1);
+    void buildApproxCell(unsigned int ic);
+    bool sampleApprox(double u, double v, double h, double w, double *val, approxCell *cell, bool first);
+    double approxDistance(const double *val1, const double *val2) const;
 public:
     CompoundOperation();
     ~CompoundOperation();
@@ -68,8 +144,15 @@ public:
     CompoundOperation(const circeOptions &circopt, GeodeticSet& GS);
     void reset();
     OPERATION_MESSAGE Operate(pt4d*p1);
+    void OperateMany(unsigned int np, pt4dc *vp, char *ok);
 //    void CompoundOperation::defineHubOptions(geodeticOptions *go, GeodeticSet *GS, const std::string &idGp);
     std::string followUpTransfos();
+    std::string displayIterationHistogram(const std::vector<CompoundOperation> *vCO = NULL) const;
+    void getIterationHistogram(std::vector<unsigned int> *histogram) const;
+    void resetWarmStart();
+    std::string displayInverseGridReport() const;
+    std::string displayApproxReport() const;
+    double Distance(pt4d *p1, pt4d *p2) const;
     std::string displayDescription(const circeOptions &circopt, std::string what);
     void getCurrentState(CatOperation *CO);
     CatOperation getCO1() const {return CO1;}
@@ -78,14 +161,19 @@ public:
     OPERATION_MESSAGE getoperationMessage() const {return operationMessage;}
     bool getuseCO1only() const {return useCO1only;}
     bool getuseCO2() const {return useCO2;}
+    bool getuseHelmertFusion() const {return useHelmertFusion;}
     std::string getDescription() const {return Description;}
     int getTransfoRequired() const {return TransfoRequired;}
     CRS_TYPE getCurrentCRStype() const {return CurrentCRStype;}
+    CRS_TYPE getSourceCRStype() const {return CO1.getCurrentCRStype();}
     CRS_TYPE getTargetCRStype1() const {return TargetCRStype1;}
     CRS_TYPE getTargetCRStype2() const {return TargetCRStype2;}
     MEASURE_UNIT getTargetLinearUnitId() const {return targetLinearUnitId;}
     MEASURE_UNIT getTargetAngularUnitId() const {return targetAngularUnitId;}
     Conversion* getTargetConversion() const {return TargetConversion;}
+    bool getuseApprox() const {return useApprox;}
+    bool getuseEpochCache() const {return useEpochCache;}
+    double getApproxMaxError() const {return approxMaxError;}
     void changeEpochs(CatOperation *CO, double *source_epoch, double *target_epoch);
 };
 
@@ -0,0 +1,497 @@
+/***********************************************************************
+
+This file is part of the Circé project source files.
+
+Circé is a computer program whose purpose is the transformation of
+4D+1 point coordinates between Coordinate Reference Systems.
+
+Homepage:
+
+   https://github.com/IGNF/circe
+
+Copyright:
+
+    Institut National de l'Information Géographique et Forestière (2018)
+
+Author:
+
+    Samuel Branchu
+
+
+    Circé is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published
+    by the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Circé is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Circé.  If not, see
+    <https://www.gnu.org/licenses/gpl-3.0.html#license-text>.
+
+***********************************************************************/
+/**
+* \file compressedstream.cpp
+* \brief Implementation of compressed (gzip or zstd) file input and output.
+*/
+
+#include "compressedstream.h"
+#include <cstring> //memset
+#include <fstream>
+#include <algorithm> //transform
+#ifdef WITH_ZLIB
+#include <zlib.h>
+#endif
+#ifdef WITH_ZSTD
+#include <zstd.h>
+#endif
+
+namespace circe
+{
+/**
+* \brief Size of the blocks of compressed data read or written at once.
+*/
+static const size_t CompressedBlockSize = 1<<18;
+
+/**
+* \brief Size of the blocks of uncompressed data passed between the threads.
+*/
+static const size_t UncompressedBlockSize = 1<<20;
+
+/**
+* \brief Number of blocks queued between the threads (a flat memory use).
+*/
+static const size_t MaxQueuedBlocks = 4;
+
+/**
+* \brief Gets the compression of a file from its extension (.gz or .zst).
+* \param[in] pathname: The pathname of the file.
+* \return A COMPRESSION code.
+*/
+COMPRESSION getPathnameCompression(const std::string& pathname)
+{
+    size_t i = pathname.find_last_of("./\\");
+    if (i == std::string::npos || pathname[i] != '.')
+        return CP_NONE;
+    std::string ext = pathname.substr(i+1);
+    std::transform(ext.begin(), ext.end(), ext.begin(), ::tolower);
+    if (ext == "gz")
+        return CP_GZIP;
+    if (ext == "zst")
+        return CP_ZSTD;
+    return CP_NONE;
+}
+
+/**
+* \brief Gets the compression of an existing file from its first bytes (magic numbers), or from its extension
+if they cannot be read.
+* \param[in] pathname: The pathname of the file.
+* \return A COMPRESSION code.
+*/
+COMPRESSION getFileCompression(const std::string& pathname)
+{
+    unsigned char magic[4];
+    std::ifstream fi(pathname.data(), std::ifstream::in|std::ifstream::binary);
+    if (!fi.is_open())
+        return getPathnameCompression(pathname);
+    fi.read((char*)magic, 4);
+    if (fi.gcount() >= 2 && magic[0] == 0x1f && magic[1] == 0x8b)
+        return CP_GZIP;
+    if (fi.gcount() == 4 && magic[0] == 0x28 && magic[1] == 0xb5 && magic[2] == 0x2f && magic[3] == 0xfd)
+        return CP_ZSTD;
+    if (fi.gcount() < 2)
+        return getPathnameCompression(pathname);
+    return CP_NONE;
+}
+
+/**
+* \brief Checks that a compression is supported by this build (WITH_ZLIB, WITH_ZSTD).
+* \param[in] compression: A COMPRESSION code.
+* \throw a std:string containing the error message (if any).
+*/
+static void checkCompression(COMPRESSION compression)
+{
+#ifndef WITH_ZLIB
+    if (compression == CP_GZIP)
+        throw ErrorMessageText[EM_UNSUPPORTED_COMPRESSION]+"gzip";
+#endif
+#ifndef WITH_ZSTD
+    if (compression == CP_ZSTD)
+        throw ErrorMessageText[EM_UNSUPPORTED_COMPRESSION]+"zstd";
+#endif
+}
+
+BlockQueue::BlockQueue(size_t _maxBlocks)
+{
+    maxBlocks = _maxBlocks;
+    closed = aborted = false;
+}
+
+/**
+* \brief Appends a block to the queue, waiting for room if needed.
+* \param block: A pointer to the block, moved to the queue.
+* \return false if the queue is aborted.
+*/
+bool BlockQueue::push(std::vector<char> *block)
+{
+    std::unique_lock<std::mutex> lock(mtx);
+    cvPush.wait(lock, [this]{return vBlock.size() < maxBlocks || aborted;});
+    if (aborted)
+        return false;
+    vBlock.push_back(std::move(*block));
+    cvPop.notify_one();
+    return true;
+}
+
+/**
+* \brief Removes the first block of the queue, waiting for it if needed.
+* \param[out] block: A pointer to the block.
+* \return false if the queue is closed and empty, or aborted.
+*/
+bool BlockQueue::pop(std::vector<char> *block)
+{
+    std::unique_lock<std::mutex> lock(mtx);
+    cvPop.wait(lock, [this]{return vBlock.size() > 0 || closed || aborted;});
+    if (aborted || vBlock.size() == 0)
+        return false;
+    *block = std::move(vBlock.front());
+    vBlock.pop_front();
+    cvPush.notify_one();
+    return true;
+}
+
+/**
+* \brief Closes the queue: no block is appended any more.
+*/
+void BlockQueue::close()
+{
+    std::lock_guard<std::mutex> lock(mtx);
+    closed = true;
+    cvPop.notify_all();
+}
+
+/**
+* \brief Aborts the queue: both ends stop waiting.
+*/
+void BlockQueue::abort()
+{
+    std::lock_guard<std::mutex> lock(mtx);
+    aborted = true;
+    cvPush.notify_all();
+    cvPop.notify_all();
+}
+
+/**
+* \brief Moves the n first bytes of a block to a queue and makes a new block.
+* \return false if the queue is aborted.
+*/
+static bool pushBlock(BlockQueue *queue, std::vector<char> *block, size_t n)
+{
+    bool b = true;
+    block->resize(n);
+    if (n > 0)
+        b = queue->push(block);
+    block->resize(UncompressedBlockSize);
+    return b;
+}
+
+DecompressionBuffer::DecompressionBuffer(std::istream *_source, COMPRESSION _compression) : queue(MaxQueuedBlocks)
+{
+    checkCompression(_compression);
+    source = _source;
+    compression = _compression;
+    setg(NULL, NULL, NULL);
+    worker = std::thread(&DecompressionBuffer::decompress, this);
+}
+
+DecompressionBuffer::~DecompressionBuffer()
+{
+    queue.abort();
+    if (worker.joinable())
+        worker.join();
+}
+
+/**
+* \brief Decompresses the source by blocks (worker thread). Concatenated gzip members and zstd frames are
+decompressed one after the other.
+*/
+void DecompressionBuffer::decompress()
+{
+    std::vector<char> in(CompressedBlockSize), out(UncompressedBlockSize);
+    bool pending = false; // output block filled, the decompressor may hold more data
+    bool complete = true;
+    try
+    {
+#ifdef WITH_ZLIB
+        if (compression == CP_GZIP)
+        {
+            z_stream zs;
+            int ret = Z_OK;
+            memset(&zs, 0, sizeof(zs));
+            if (inflateInit2(&zs, 15+32) != Z_OK)
+                throw ErrorMessageText[EM_COMPRESSION_FAILED]+"gzip";
+            zs.next_out = (Bytef*)out.data();
+            zs.avail_out = out.size();
+            while (true)
+            {
+                if (zs.avail_in == 0 && !pending)
+                {
+                    source->read(in.data(), in.size());
+                    if (source->gcount() == 0)
+                        break;
+                    zs.next_in = (Bytef*)in.data();
+                    zs.avail_in = source->gcount();
+                }
+                ret = inflate(&zs, Z_NO_FLUSH);
+                if (ret != Z_OK && ret != Z_STREAM_END && ret != Z_BUF_ERROR)
+                {
+                    inflateEnd(&zs);
+                    throw ErrorMessageText[EM_COMPRESSION_FAILED]+"gzip";
+                }
+                complete = (ret == Z_STREAM_END);
+                pending = (zs.avail_out == 0 && !complete);
+                if (zs.avail_out == 0)
+                {
+                    if (!pushBlock(&queue, &out, out.size()))
+                        break;
+                    zs.next_out = (Bytef*)out.data();
+                    zs.avail_out = out.size();
+                }
+                // next member
+                if (complete)
+                    inflateReset(&zs);
+            }
+            inflateEnd(&zs);
+            pushBlock(&queue, &out, out.size()-zs.avail_out);
+        }
+#endif
+#ifdef WITH_ZSTD
+        if (compression == CP_ZSTD)
+        {
+            ZSTD_DCtx *dctx = ZSTD_createDCtx();
+            ZSTD_inBuffer zin = {in.data(), 0, 0};
+            ZSTD_outBuffer zout = {out.data(), out.size(), 0};
+            size_t ret = 0;
+            while (true)
+            {
+                if (zin.pos == zin.size && !pending)
+                {
+                    source->read(in.data(), in.size());
+                    if (source->gcount() == 0)
+                        break;
+                    zin.size = source->gcount();
+                    zin.pos = 0;
+                }
+                ret = ZSTD_decompressStream(dctx, &zout, &zin);
+                if (ZSTD_isError(ret))
+                {
+                    ZSTD_freeDCtx(dctx);
+                    throw ErrorMessageText[EM_COMPRESSION_FAILED]+"zstd: "+ZSTD_getErrorName(ret);
+                }
+                complete = (ret == 0);
+                pending = (zout.pos == zout.size && !complete);
+                if (zout.pos == zout.size)
+                {
+                    if (!pushBlock(&queue, &out, out.size()))
+                        break;
+                    zout.dst = out.data();
+                    zout.pos = 0;
+                }
+            }
+            ZSTD_freeDCtx(dctx);
+            pushBlock(&queue, &out, zout.pos);
+        }
+#endif
+        // truncated file
+        if (!complete)
+            throw ErrorMessageText[EM_COMPRESSION_FAILED]+(compression == CP_ZSTD ? "zstd" : "gzip");
+    }
+    catch (std::string str)
+    {
+        error = str;
+    }
+    queue.close();
+}
+
+/**
+* \brief Gets the next decompressed block.
+* \throw a std:string containing the decompression error message (if any).
+*/
+DecompressionBuffer::int_type DecompressionBuffer::underflow()
+{
+    if (gptr() < egptr())
+        return traits_type::to_int_type(*gptr());
+    if (!queue.pop(&current))
+    {
+        if (error != "")
+            throw error;
+        return traits_type::eof();
+    }
+    setg(current.data(), current.data(), current.data()+current.size());
+    return traits_type::to_int_type(*gptr());
+}
+
+CompressionBuffer::CompressionBuffer(std::ostream *_destination, COMPRESSION _compression) : queue(MaxQueuedBlocks)
+{
+    checkCompression(_compression);
+    destination = _destination;
+    compression = _compression;
+    finished = false;
+    current.resize(UncompressedBlockSize);
+    setp(current.data(), current.data()+current.size());
+    worker = std::thread(&CompressionBuffer::compress, this);
+}
+
+CompressionBuffer::~CompressionBuffer()
+{
+    try
+    {
+        finish();
+    }
+    catch (std::string str)
+    {
+    }
+}
+
+/**
+* \brief Compresses the blocks of the queue into the destination (worker thread).
+*/
+void CompressionBuffer::compress()
+{
+    std::vector<char> in, out(CompressedBlockSize);
+    bool failed = false;
+#ifdef WITH_ZLIB
+    if (compression == CP_GZIP)
+    {
+        z_stream zs;
+        int ret = Z_OK;
+        memset(&zs, 0, sizeof(zs));
+        // fastest level, so that the compression keeps up with the transformation
+        failed = (deflateInit2(&zs, Z_BEST_SPEED, Z_DEFLATED, 15+16, 8, Z_DEFAULT_STRATEGY) != Z_OK);
+        while (queue.pop(&in))
+        {
+            zs.next_in = (Bytef*)in.data();
+            zs.avail_in = in.size();
+            while (!failed && zs.avail_in > 0)
+            {
+                zs.next_out = (Bytef*)out.data();
+                zs.avail_out = out.size();
+                failed = (deflate(&zs, Z_NO_FLUSH) == Z_STREAM_ERROR);
+                destination->write(out.data(), out.size()-zs.avail_out);
+            }
+        }
+        while (!failed && ret != Z_STREAM_END)
+        {
+            zs.next_out = (Bytef*)out.data();
+            zs.avail_out = out.size();
+            ret = deflate(&zs, Z_FINISH);
+            failed = (ret == Z_STREAM_ERROR);
+            destination->write(out.data(), out.size()-zs.avail_out);
+        }
+        deflateEnd(&zs);
+    }
+#endif
+#ifdef WITH_ZSTD
+    if (compression == CP_ZSTD)
+    {
+        ZSTD_CCtx *cctx = ZSTD_createCCtx();
+        ZSTD_outBuffer zout;
+        size_t ret = 1;
+        while (queue.pop(&in))
+        {
+            ZSTD_inBuffer zin = {in.data(), in.size(), 0};
+            while (!failed && zin.pos < zin.size)
+            {
+                zout = {out.data(), out.size(), 0};
+                failed = ZSTD_isError(ZSTD_compressStream2(cctx, &zout, &zin, ZSTD_e_continue));
+                destination->write(out.data(), zout.pos);
+            }
+        }
+        ZSTD_inBuffer zin = {NULL, 0, 0};
+        while (!failed && ret != 0)
+        {
+            zout = {out.data(), out.size(), 0};
+            ret = ZSTD_compressStream2(cctx, &zout, &zin, ZSTD_e_end);
+            failed = ZSTD_isError(ret);
+            destination->write(out.data(), zout.pos);
+        }
+        ZSTD_freeCCtx(cctx);
+    }
+#endif
+    destination->flush();
+    if (failed || !destination->good())
+        error = ErrorMessageText[EM_COMPRESSION_FAILED]+(compression == CP_ZSTD ? "zstd" : "gzip");
+}
+
+/**
+* \brief Moves the current block to the queue and makes a new one.
+*/
+bool CompressionBuffer::pushCurrent()
+{
+    bool b = pushBlock(&queue, &current, pptr()-pbase());
+    setp(current.data(), current.data()+current.size());
+    return b;
+}
+
+CompressionBuffer::int_type CompressionBuffer::overflow(int_type c)
+{
+    if (finished || !pushCurrent())
+        return traits_type::eof();
+    if (!traits_type::eq_int_type(c, traits_type::eof()))
+    {
+        *pptr() = traits_type::to_char_type(c);
+        pbump(1);
+    }
+    return traits_type::not_eof(c);
+}
+
+int CompressionBuffer::sync()
+{
+    if (finished || !pushCurrent())
+        return -1;
+    return 0;
+}
+
+/**
+* \brief Compresses the remaining data and ends the compressed stream.
+* \throw a std:string containing the compression error message (if any).
+*/
+void CompressionBuffer::finish()
+{
+    if (finished)
+        return;
+    pushCurrent();
+    finished = true;
+    queue.close();
+    worker.join();
+    if (error != "")
+        throw error;
+}
+
+CompressedIstream::CompressedIstream(std::istream *source, COMPRESSION compression)
+    : std::istream(NULL), buffer(source, compression)
+{
+    rdbuf(&buffer);
+    exceptions(std::ios::badbit);
+}
+
+CompressedOstream::CompressedOstream(std::ostream *destination, COMPRESSION compression)
+    : std::ostream(NULL), buffer(destination, compression)
+{
+    rdbuf(&buffer);
+}
+
+/**
+* \brief Writes the remaining data (see CompressionBuffer::finish).
+* \throw a std:string containing the compression error message (if any).
+*/
+void CompressedOstream::close()
+{
+    flush();
+    buffer.finish();
+}
+
+}
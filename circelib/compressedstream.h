@@ -0,0 +1,160 @@
+/***********************************************************************
+
+This file is part of the Circé project source files.
+
+Circé is a computer program whose purpose is the transformation of
+4D+1 point coordinates between Coordinate Reference Systems.
+
+Homepage:
+
+   https://github.com/IGNF/circe
+
+Copyright:
+
+    Institut National de l'Information Géographique et Forestière (2018)
+
+Author:
+
+    Samuel Branchu
+
+
+    Circé is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published
+    by the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Circé is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Circé.  If not, see
+    <https://www.gnu.org/licenses/gpl-3.0.html#license-text>.
+
+***********************************************************************/
+/**
+* \file compressedstream.h
+* \brief Definition of compressed (gzip or zstd) file input and output.
+*/
+
+#ifndef COMPRESSEDSTREAM_H
+#define COMPRESSEDSTREAM_H
+#include <string>
+#include <vector>
+#include <deque>
+#include <iostream>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#ifdef UI_LANGUAGE_FRENCH
+#include "StringResourcesFR.h"
+#else
+#include "StringResourcesEN.h"
+#endif
+
+namespace circe
+{
+/**\brief Codes for file compression.*/
+enum COMPRESSION
+{
+    CP_NONE,
+    CP_GZIP,
+    CP_ZSTD
+};
+
+COMPRESSION getPathnameCompression(const std::string& pathname);
+COMPRESSION getFileCompression(const std::string& pathname);
+
+/**
+* \brief Queue of data blocks passed from a thread to another one, holding a bounded number of blocks.
+*/
+class BlockQueue
+{
+private:
+    std::deque<std::vector<char> > vBlock;
+    size_t maxBlocks;
+    bool closed, aborted;
+    std::mutex mtx;
+    std::condition_variable cvPush, cvPop;
+public:
+    BlockQueue(size_t _maxBlocks);
+    bool push(std::vector<char> *block);
+    bool pop(std::vector<char> *block);
+    void close();
+    void abort();
+};
+
+/**
+* \brief std::streambuf reading a compressed std::istream. The blocks of the input are decompressed by a
+thread of their own, overlapping their use by the reader.
+*/
+class DecompressionBuffer : public std::streambuf
+{
+private:
+    std::istream *source;
+    COMPRESSION compression;
+    BlockQueue queue;
+    std::vector<char> current;
+    std::string error;
+    std::thread worker;
+    void decompress();
+protected:
+    int_type underflow();
+public:
+    DecompressionBuffer(std::istream *_source, COMPRESSION _compression);
+    ~DecompressionBuffer();
+};
+
+/**
+* \brief std::streambuf writing a compressed std::ostream. The blocks of the output are compressed by a
+thread of their own, overlapping their writing by the caller.
+*/
+class CompressionBuffer : public std::streambuf
+{
+private:
+    std::ostream *destination;
+    COMPRESSION compression;
+    BlockQueue queue;
+    std::vector<char> current;
+    std::string error;
+    std::thread worker;
+    bool finished;
+    void compress();
+    bool pushCurrent();
+protected:
+    int_type overflow(int_type c);
+    int sync();
+public:
+    CompressionBuffer(std::ostream *_destination, COMPRESSION _compression);
+    ~CompressionBuffer();
+    void finish();
+};
+
+/**
+* \brief std::istream decompressing another std::istream (see DecompressionBuffer). A decompression error is
+thrown as a std::string.
+*/
+class CompressedIstream : public std::istream
+{
+private:
+    DecompressionBuffer buffer;
+public:
+    CompressedIstream(std::istream *source, COMPRESSION compression);
+};
+
+/**
+* \brief std::ostream compressing into another std::ostream (see CompressionBuffer), which is complete once
+close has been called.
+*/
+class CompressedOstream : public std::ostream
+{
+private:
+    CompressionBuffer buffer;
+public:
+    CompressedOstream(std::ostream *destination, COMPRESSION compression);
+    void close();
+};
+
+}
+#endif // COMPRESSEDSTREAM_H
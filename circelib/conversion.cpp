@@ -40,6 +40,8 @@ Author:
 
 #include "conversion.h"
 #include "stringtools.h"
+#include <fstream> //testApplyMany
+#include <iomanip> //testApplyMany
 
 namespace circe
 {
@@ -49,7 +51,8 @@ namespace circe
 */
 Conversion::Conversion()
 {
-
+    a = e2 = 0.;
+    InitEllipsoidContext(a, e2, &ellContext);
 }
 
 /**
@@ -59,6 +62,7 @@ Conversion::Conversion(const Conversion &B) : Operation(B)
 {
 	a = B.a;
 	e2 = B.e2;
+	ellContext = B.ellContext;
 	fromGreenwich = B.fromGreenwich;
 	lambda0 = B.lambda0;
 	phi0 = B.phi0;
@@ -84,6 +88,7 @@ Conversion::Conversion(const Conversion &B, double _a, double _e2) : Operation(B
 {
 	a = _a;
 	e2 = _e2;
+	InitEllipsoidContext(a, e2, &ellContext);
 	fromGreenwich = B.fromGreenwich;
     lambda0 = B.lambda0;
     phi0 = B.phi0;
@@ -122,6 +127,7 @@ void Conversion::reset()
 {
     Operation::reset();
     a = e2 = fromGreenwich = lambda0 = phi0 = phi1 = phi2 = k0 = x0 = y0 = 0.;
+    InitEllipsoidContext(a, e2, &ellContext);
     initParamMethodId = applicationMethodId = applicationInvMethodId = sourceCRSid = targetCRSid = primeMeridianId = "";
     addFromGreenwich = bCalcScaleConv = false;
 }
@@ -166,6 +172,50 @@ void Conversion::setAddFromGreenwich(bool _value)
 	//if (addFromGreenwich) lambda0 += fromGreenwich;
 }
 
+/**
+* \brief Geographic to Projected coordinates of np points stored in contiguous arrays.
+* \param[in] np: The number of points.
+* \param[in] l, p: The geographic coordinates (radians).
+* \param[out] x, y: The projected coordinates.
+* \param[out] conv, scfact: The convergence and scale factor, each one only filled if not NULL.
+* \remark This generic version calls Apply for each point. Child classes override it with a
+* loop over their own kernels, which avoids a virtual call per point.
+*/
+void Conversion::ApplyMany(unsigned int np, const double *l, const double *p, double *x, double *y, double *conv, double *scfact)
+{
+    bool b = bCalcScaleConv;
+    double cv, sf;
+    bCalcScaleConv = (conv || scfact);
+    for (unsigned int i=0; i<np; i++)
+    {
+        Apply(l[i], p[i], x+i, y+i, &cv, &sf);
+        if (conv) conv[i] = cv;
+        if (scfact) scfact[i] = sf;
+    }
+    bCalcScaleConv = b;
+}
+/**
+* \brief Projected to Geographic coordinates of np points stored in contiguous arrays.
+* \param[in] np: The number of points.
+* \param[in] x, y: The projected coordinates.
+* \param[out] l, p: The geographic coordinates (radians).
+* \param[out] conv, scfact: The convergence and scale factor, each one only filled if not NULL.
+* \remark This generic version calls ApplyInv for each point.
+*/
+void Conversion::ApplyInvMany(unsigned int np, const double *x, const double *y, double *l, double *p, double *conv, double *scfact)
+{
+    bool b = bCalcScaleConv;
+    double cv, sf;
+    bCalcScaleConv = (conv || scfact);
+    for (unsigned int i=0; i<np; i++)
+    {
+        ApplyInv(x[i], y[i], l+i, p+i, &cv, &sf);
+        if (conv) conv[i] = cv;
+        if (scfact) scfact[i] = sf;
+    }
+    bCalcScaleConv = b;
+}
+
 /**
 * \brief Constructor.
 */
@@ -234,12 +284,50 @@ void ProjectionLCC::Apply(double l, double p, double *x, double *y, double *conv
 /**\brief Projected to Geographic coordinates.*/
 void ProjectionLCC::ApplyInv(double x, double y, double *l, double *p, double *conv, double *scfact)
 {
-    LambertGeo(e2, n, c, lambdac, xs, ys, l, p, x, y);
+    LambertGeo(ellContext, n, c, lambdac, xs, ys, l, p, x, y);
     if (bCalcScaleConv)
         ScaleConvLamb(*l, *p, a, e2, n, c, lambda0, conv, scfact);
     else
         *conv = *scfact = 0.;
 }
+/**
+* \brief Geographic to Projected coordinates of np points stored in contiguous arrays.
+* \param[in] np: The number of points.
+* \param[in] l, p: The geographic coordinates (radians).
+* \param[out] x, y: The projected coordinates.
+* \param[out] conv, scfact: The convergence and scale factor, each one only filled if not NULL.
+*/
+void ProjectionLCC::ApplyMany(unsigned int np, const double *l, const double *p, double *x, double *y, double *conv, double *scfact)
+{
+    GeoLambertMany(e2, n, c, lambdac, xs, ys, np, l, p, x, y);
+    if (conv || scfact)
+        for (unsigned int i=0; i<np; i++)
+        {
+            double cv, sf;
+            ScaleConvLamb(l[i], p[i], a, e2, n, c, lambda0, &cv, &sf);
+            if (conv) conv[i] = cv;
+            if (scfact) scfact[i] = sf;
+        }
+}
+/**
+* \brief Projected to Geographic coordinates of np points stored in contiguous arrays.
+* \param[in] np: The number of points.
+* \param[in] x, y: The projected coordinates.
+* \param[out] l, p: The geographic coordinates (radians).
+* \param[out] conv, scfact: The convergence and scale factor, each one only filled if not NULL.
+*/
+void ProjectionLCC::ApplyInvMany(unsigned int np, const double *x, const double *y, double *l, double *p, double *conv, double *scfact)
+{
+    LambertGeoMany(e2, n, c, lambdac, xs, ys, np, l, p, x, y);
+    if (conv || scfact)
+        for (unsigned int i=0; i<np; i++)
+        {
+            double cv, sf;
+            ScaleConvLamb(l[i], p[i], a, e2, n, c, lambda0, &cv, &sf);
+            if (conv) conv[i] = cv;
+            if (scfact) scfact[i] = sf;
+        }
+}
 
 /**
 * \brief Constructor.
@@ -255,6 +343,8 @@ void ProjectionTMerc::reset()
 {
     Conversion::reset();
     lambdac = n = c = xs = ys = 0.;
+    for (int i=0; i<=DEGRE; i++)
+        cDir[i] = cInv[i] = 0.;
 }
 
 /**
@@ -275,6 +365,11 @@ ProjectionTMerc::ProjectionTMerc(const ProjectionTMerc &B) : Conversion(B)
     c = B.c;
     xs = B.xs;
     ys = B.ys;
+    for (int i=0; i<=DEGRE; i++)
+    {
+        cDir[i] = B.cDir[i];
+        cInv[i] = B.cInv[i];
+    }
 }
 
 /**
@@ -299,11 +394,15 @@ void ProjectionTMerc::InitParam(std::string IPMid, std::string AMid, std::string
 	//EPSG 9807 9808 ?
     else if (getInitParamMethodId()==UTMSID)
         CoefProjMercTr(a, e2, lambda0, phi0, k0, x0, y0, &lambdac, &n, &xs, &ys);
+
+    //The series coefficients only depend on the ellipsoid.
+    CoefProjMercTrDir(e2, cDir);
+    CoefProjMercTrInv(e2, cInv);
 }
 /**\brief Geographic to Projected coordinates.*/
 void ProjectionTMerc::Apply(double l, double p, double *x, double *y, double *conv, double *scfact)
 {
-    GeoMercTr(lambda0, n, xs, ys, e2, l, p, x, y);
+    GeoMercTr(lambda0, n, xs, ys, e2, cDir, l, p, x, y);
     if (bCalcScaleConv)
         ScaleConvMercTr(a, l, p, n, lambdac, xs, k0, *x, conv, scfact);
     else
@@ -312,12 +411,50 @@ void ProjectionTMerc::Apply(double l, double p, double *x, double *y, double *co
 /**\brief Projected to Geographic coordinates.*/
 void ProjectionTMerc::ApplyInv(double x, double y, double *l, double *p, double *conv, double *scfact)
 {
-    MercTrGeo(lambda0, n, xs, ys, e2, l, p, x, y);
+    MercTrGeo(ellContext, lambda0, n, xs, ys, cInv, l, p, x, y);
     if (bCalcScaleConv)
         ScaleConvMercTr(a, *l, *p, n, lambdac, xs, k0, x, conv, scfact);
     else
         *conv = *scfact = 0.;
 }
+/**
+* \brief Geographic to Projected coordinates of np points stored in contiguous arrays.
+* \param[in] np: The number of points.
+* \param[in] l, p: The geographic coordinates (radians).
+* \param[out] x, y: The projected coordinates.
+* \param[out] conv, scfact: The convergence and scale factor, each one only filled if not NULL.
+*/
+void ProjectionTMerc::ApplyMany(unsigned int np, const double *l, const double *p, double *x, double *y, double *conv, double *scfact)
+{
+    GeoMercTrMany(lambda0, n, xs, ys, e2, cDir, np, l, p, x, y);
+    if (conv || scfact)
+        for (unsigned int i=0; i<np; i++)
+        {
+            double cv, sf;
+            ScaleConvMercTr(a, l[i], p[i], n, lambdac, xs, k0, x[i], &cv, &sf);
+            if (conv) conv[i] = cv;
+            if (scfact) scfact[i] = sf;
+        }
+}
+/**
+* \brief Projected to Geographic coordinates of np points stored in contiguous arrays.
+* \param[in] np: The number of points.
+* \param[in] x, y: The projected coordinates.
+* \param[out] l, p: The geographic coordinates (radians).
+* \param[out] conv, scfact: The convergence and scale factor, each one only filled if not NULL.
+*/
+void ProjectionTMerc::ApplyInvMany(unsigned int np, const double *x, const double *y, double *l, double *p, double *conv, double *scfact)
+{
+    MercTrGeoMany(lambda0, n, xs, ys, e2, cInv, np, l, p, x, y);
+    if (conv || scfact)
+        for (unsigned int i=0; i<np; i++)
+        {
+            double cv, sf;
+            ScaleConvMercTr(a, l[i], p[i], n, lambdac, xs, k0, x[i], &cv, &sf);
+            if (conv) conv[i] = cv;
+            if (scfact) scfact[i] = sf;
+        }
+}
 
 /**
 * \brief Constructor.
@@ -392,12 +529,52 @@ void ProjectionGLab::Apply(double l, double p, double *x, double *y, double *con
 /**\brief Projected to Geographic coordinates.*/
 void ProjectionGLab::ApplyInv(double x, double y, double *l, double *p, double *conv, double *scfact)
 {
-    GaussLabGeo(c, n1, n2, xs, ys, e2, lambdac, l, p, x, y);
+    GaussLabGeo(ellContext, c, n1, n2, xs, ys, lambdac, l, p, x, y);
     if (bCalcScaleConv)
         ScaleConvGaussLab(a, e2, *l, *p, n1, n2, c, lambdac, conv, scfact);
     else
         *conv = *scfact = 0.;
 }
+/**
+* \brief Geographic to Projected coordinates of np points stored in contiguous arrays.
+* \param[in] np: The number of points.
+* \param[in] l, p: The geographic coordinates (radians).
+* \param[out] x, y: The projected coordinates.
+* \param[out] conv, scfact: The convergence and scale factor, each one only filled if not NULL.
+*/
+void ProjectionGLab::ApplyMany(unsigned int np, const double *l, const double *p, double *x, double *y, double *conv, double *scfact)
+{
+    for (unsigned int i=0; i<np; i++)
+        GeoGaussLab(c, n1, n2, xs, ys, e2, lambdac, l[i], p[i], x+i, y+i);
+    if (conv || scfact)
+        for (unsigned int i=0; i<np; i++)
+        {
+            double cv, sf;
+            ScaleConvGaussLab(a, e2, l[i], p[i], n1, n2, c, lambdac, &cv, &sf);
+            if (conv) conv[i] = cv;
+            if (scfact) scfact[i] = sf;
+        }
+}
+/**
+* \brief Projected to Geographic coordinates of np points stored in contiguous arrays.
+* \param[in] np: The number of points.
+* \param[in] x, y: The projected coordinates.
+* \param[out] l, p: The geographic coordinates (radians).
+* \param[out] conv, scfact: The convergence and scale factor, each one only filled if not NULL.
+*/
+void ProjectionGLab::ApplyInvMany(unsigned int np, const double *x, const double *y, double *l, double *p, double *conv, double *scfact)
+{
+    for (unsigned int i=0; i<np; i++)
+        GaussLabGeo(ellContext, c, n1, n2, xs, ys, lambdac, l+i, p+i, x[i], y[i]);
+    if (conv || scfact)
+        for (unsigned int i=0; i<np; i++)
+        {
+            double cv, sf;
+            ScaleConvGaussLab(a, e2, l[i], p[i], n1, n2, c, lambdac, &cv, &sf);
+            if (conv) conv[i] = cv;
+            if (scfact) scfact[i] = sf;
+        }
+}
 
 /**
 * \brief Constructor.
@@ -462,6 +639,42 @@ void ProjectionLAEA::ApplyInv(double x, double y, double *l, double *p, double *
     LAEAgeo(a, e2, lambda0, phi0, qp, Rq, beta1, D, x0, y0, l, p, x, y);
     *conv = *scfact = 0.;
 }
+/**
+* \brief Geographic to Projected coordinates of np points stored in contiguous arrays.
+* \param[in] np: The number of points.
+* \param[in] l, p: The geographic coordinates (radians).
+* \param[out] x, y: The projected coordinates.
+* \param[out] conv, scfact: The convergence and scale factor, each one only filled if not NULL.
+*/
+void ProjectionLAEA::ApplyMany(unsigned int np, const double *l, const double *p, double *x, double *y, double *conv, double *scfact)
+{
+    for (unsigned int i=0; i<np; i++)
+        GeoLAEA(a, e2, lambda0, phi0, qp, Rq, beta1, D, x0, y0, l[i], p[i], x+i, y+i);
+    if (conv || scfact)
+        for (unsigned int i=0; i<np; i++)
+        {
+            if (conv) conv[i] = 0.;
+            if (scfact) scfact[i] = 0.;
+        }
+}
+/**
+* \brief Projected to Geographic coordinates of np points stored in contiguous arrays.
+* \param[in] np: The number of points.
+* \param[in] x, y: The projected coordinates.
+* \param[out] l, p: The geographic coordinates (radians).
+* \param[out] conv, scfact: The convergence and scale factor, each one only filled if not NULL.
+*/
+void ProjectionLAEA::ApplyInvMany(unsigned int np, const double *x, const double *y, double *l, double *p, double *conv, double *scfact)
+{
+    for (unsigned int i=0; i<np; i++)
+        LAEAgeo(a, e2, lambda0, phi0, qp, Rq, beta1, D, x0, y0, l+i, p+i, x[i], y[i]);
+    if (conv || scfact)
+        for (unsigned int i=0; i<np; i++)
+        {
+            if (conv) conv[i] = 0.;
+            if (scfact) scfact[i] = 0.;
+        }
+}
 
 /**
 * \brief Constructor.
@@ -512,12 +725,12 @@ void ProjectionSouthPolarStereographic::InitParam(std::string IPMid, std::string
     setApplicationInvMethodId(AIMid);
     // if (addFromGreenwich) lambda0+=fromGreenwich;
     if (getInitParamMethodId()==SMCSID)
-        CoefProjSterObl(1, a, e2, lambda0, phi0, k0, x0, y0, &lambdac, &phic, &c, &n1, &n2, &xs, &ys);
+        CoefProjSterObl(1, ellContext, lambda0, phi0, k0, x0, y0, &lambdac, &phic, &c, &n1, &n2, &xs, &ys);
     else if (getInitParamMethodId()==SPSTID)
-        CoefProjSterObl(5, a, e2, lambda0, phi0, k0, x0, y0, &lambdac, &phic, &c, &n1, &n2, &xs, &ys);
+        CoefProjSterObl(5, ellContext, lambda0, phi0, k0, x0, y0, &lambdac, &phic, &c, &n1, &n2, &xs, &ys);
     else if (getInitParamMethodId()==SPSSID) // The only one to be implemented in Apply and ApplyInv
         //Stéréographique polaire sud Terre Adélie
-        CoefProjSterObl(7, a, e2, lambda0, phi0, k0, x0, y0, &lambdac, &phic, &c, &n1, &n2, &xs, &ys);
+        CoefProjSterObl(7, ellContext, lambda0, phi0, k0, x0, y0, &lambdac, &phic, &c, &n1, &n2, &xs, &ys);
 }
 /**\brief Geographic to Projected coordinates.*/
 void ProjectionSouthPolarStereographic::Apply(double l, double p, double *x, double *y, double *conv, double *scfact)
@@ -531,12 +744,52 @@ void ProjectionSouthPolarStereographic::Apply(double l, double p, double *x, dou
 /**\brief Projected to Geographic coordinates.*/
 void ProjectionSouthPolarStereographic::ApplyInv(double x, double y, double *l, double *p, double *conv, double *scfact)
 {
-    SterPolSudGeo(n1, n2, xs, ys, e2, c, lambdac, phic, l, p, x, y);
+    SterPolSudGeo(ellContext, n1, n2, xs, ys, c, lambdac, phic, l, p, x, y);
     if (bCalcScaleConv)
         ModConvSterObl (a, *l, *p, e2, c, n1, n2, lambdac, phic, conv, scfact);
     else
         *conv = *scfact = 0.;
 }
+/**
+* \brief Geographic to Projected coordinates of np points stored in contiguous arrays.
+* \param[in] np: The number of points.
+* \param[in] l, p: The geographic coordinates (radians).
+* \param[out] x, y: The projected coordinates.
+* \param[out] conv, scfact: The convergence and scale factor, each one only filled if not NULL.
+*/
+void ProjectionSouthPolarStereographic::ApplyMany(unsigned int np, const double *l, const double *p, double *x, double *y, double *conv, double *scfact)
+{
+    for (unsigned int i=0; i<np; i++)
+        GeoSterPolSud(c, n1, n2, xs, ys, e2, lambdac, phic, l[i], p[i], x+i, y+i);
+    if (conv || scfact)
+        for (unsigned int i=0; i<np; i++)
+        {
+            double cv, sf;
+            ModConvSterObl (a, l[i], p[i], e2, c, n1, n2, lambdac, phic, &cv, &sf);
+            if (conv) conv[i] = cv;
+            if (scfact) scfact[i] = sf;
+        }
+}
+/**
+* \brief Projected to Geographic coordinates of np points stored in contiguous arrays.
+* \param[in] np: The number of points.
+* \param[in] x, y: The projected coordinates.
+* \param[out] l, p: The geographic coordinates (radians).
+* \param[out] conv, scfact: The convergence and scale factor, each one only filled if not NULL.
+*/
+void ProjectionSouthPolarStereographic::ApplyInvMany(unsigned int np, const double *x, const double *y, double *l, double *p, double *conv, double *scfact)
+{
+    for (unsigned int i=0; i<np; i++)
+        SterPolSudGeo(ellContext, n1, n2, xs, ys, c, lambdac, phic, l+i, p+i, x[i], y[i]);
+    if (conv || scfact)
+        for (unsigned int i=0; i<np; i++)
+        {
+            double cv, sf;
+            ModConvSterObl (a, l[i], p[i], e2, c, n1, n2, lambdac, phic, &cv, &sf);
+            if (conv) conv[i] = cv;
+            if (scfact) scfact[i] = sf;
+        }
+}
 
 
 /**
@@ -558,6 +811,7 @@ ProjectionHatt::ProjectionHatt(const Conversion &B, double _a, double _e2) : Con
 */
 ProjectionHatt::ProjectionHatt(const ProjectionHatt &B) : Conversion(B)
 {
+    hc = B.hc;
 }
 /**
 * \brief Empties values of the members of an instance.
@@ -565,6 +819,7 @@ ProjectionHatt::ProjectionHatt(const ProjectionHatt &B) : Conversion(B)
 void ProjectionHatt::reset()
 {
     Conversion::reset();
+    InitHattContext(ellContext, 0., 0., 0., 0., &hc);
 }
 
 /**
@@ -577,19 +832,199 @@ void ProjectionHatt::InitParam(std::string IPMid, std::string AMid, std::string
     setInitParamMethodId(IPMid);
     setApplicationMethodId(AMid);
     setApplicationInvMethodId(AIMid);
+    InitHattContext(ellContext, lambda0, phi0, x0, y0, &hc);
 }
 /**\brief Geographic to Projected coordinates.*/
 void ProjectionHatt::Apply(double l, double p, double *x, double *y, double *conv, double *scfact)
 {
-    GeoHatt(lambda0, phi0, x0, y0, a, e2, l, p, x, y);
+    GeoHatt(hc, l, p, x, y);
     *conv = *scfact = 0.;
 }
 /**\brief Projected to Geographic coordinates.*/
 void ProjectionHatt::ApplyInv(double x, double y, double *l, double *p, double *conv, double *scfact)
 {
-    HattGeo(lambda0, phi0, x0, y0, a, e2, l, p, x, y);
+    HattGeo(hc, l, p, x, y);
     *conv = *scfact = 0.;
 }
+/**
+* \brief Geographic to Projected coordinates of np points stored in contiguous arrays.
+* \param[in] np: The number of points.
+* \param[in] l, p: The geographic coordinates (radians).
+* \param[out] x, y: The projected coordinates.
+* \param[out] conv, scfact: The convergence and scale factor, each one only filled if not NULL.
+*/
+void ProjectionHatt::ApplyMany(unsigned int np, const double *l, const double *p, double *x, double *y, double *conv, double *scfact)
+{
+    for (unsigned int i=0; i<np; i++)
+        GeoHatt(hc, l[i], p[i], x+i, y+i);
+    if (conv || scfact)
+        for (unsigned int i=0; i<np; i++)
+        {
+            if (conv) conv[i] = 0.;
+            if (scfact) scfact[i] = 0.;
+        }
+}
+/**
+* \brief Projected to Geographic coordinates of np points stored in contiguous arrays.
+* \param[in] np: The number of points.
+* \param[in] x, y: The projected coordinates.
+* \param[out] l, p: The geographic coordinates (radians).
+* \param[out] conv, scfact: The convergence and scale factor, each one only filled if not NULL.
+*/
+void ProjectionHatt::ApplyInvMany(unsigned int np, const double *x, const double *y, double *l, double *p, double *conv, double *scfact)
+{
+    for (unsigned int i=0; i<np; i++)
+        HattGeo(hc, l+i, p+i, x[i], y[i]);
+    if (conv || scfact)
+        for (unsigned int i=0; i<np; i++)
+        {
+            if (conv) conv[i] = 0.;
+            if (scfact) scfact[i] = 0.;
+        }
+}
+
+/**
+* \brief Returns the largest of m and |d|, or HUGE_VAL if d is not a number.
+*/
+static double maxAbsDiff(double m, double d)
+{
+    if (std::isnan(d)) return HUGE_VAL;
+    return std::max(m, fabs(d));
+}
+
+/**
+* \brief Compares ApplyMany and ApplyInvMany of a projection with Apply and ApplyInv on a lattice
+* of geographic points, and writes the largest differences.
+* \param fo: A pointer to the output std::ofstream.
+* \param[in] name: The name of the projection.
+* \param C: A pointer to the initialized projection.
+* \param[in] lmin, lmax, pmin, pmax: The bounds of the lattice (degrees).
+* \param[in] tolerance: The largest difference accepted (meters).
+* \return The number of failures (0 to 2).
+*/
+static unsigned int compareApplyMany(std::ofstream *fo, const std::string &name, Conversion *C,
+                                     double lmin, double lmax, double pmin, double pmax, double tolerance)
+{
+    const unsigned int nl = 81, np = 81;
+    const unsigned int n = nl*np;
+    std::vector<double> l(n), p(n), x(n), y(n), conv(n), scfact(n);
+    std::vector<double> xm(n), ym(n), convm(n), scfactm(n), lm(n), pm(n);
+    double dDir = 0., dInv = 0., dConv = 0., cv, sf, dl, dp;
+    unsigned int i, nFail = 0;
+    for (i=0; i<n; i++)
+    {
+        l[i] = (lmin+(lmax-lmin)*(i%nl)/(nl-1))*DEG2RAD;
+        p[i] = (pmin+(pmax-pmin)*(i/nl)/(np-1))*DEG2RAD;
+    }
+    C->setbCalcScaleConv(true);
+    for (i=0; i<n; i++)
+        C->Apply(l[i], p[i], &x[i], &y[i], &conv[i], &scfact[i]);
+    C->ApplyMany(n, l.data(), p.data(), xm.data(), ym.data(), convm.data(), scfactm.data());
+    for (i=0; i<n; i++)
+    {
+        dDir = maxAbsDiff(maxAbsDiff(dDir, xm[i]-x[i]), ym[i]-y[i]);
+        dConv = maxAbsDiff(maxAbsDiff(dConv, convm[i]-conv[i]), scfactm[i]-scfact[i]);
+    }
+    C->ApplyMany(n, l.data(), p.data(), xm.data(), ym.data(), NULL, NULL);
+    for (i=0; i<n; i++)
+        dDir = maxAbsDiff(maxAbsDiff(dDir, xm[i]-x[i]), ym[i]-y[i]);
+    for (i=0; i<n; i++)
+        C->ApplyInv(x[i], y[i], &l[i], &p[i], &conv[i], &scfact[i]);
+    C->ApplyInvMany(n, x.data(), y.data(), lm.data(), pm.data(), convm.data(), scfactm.data());
+    for (i=0; i<n; i++)
+    {
+        dl = (lm[i]-l[i])*cos(p[i])*C->get_a();
+        dp = (pm[i]-p[i])*C->get_a();
+        dInv = maxAbsDiff(maxAbsDiff(dInv, dl), dp);
+        dConv = maxAbsDiff(maxAbsDiff(dConv, convm[i]-conv[i]), scfactm[i]-scfact[i]);
+    }
+    C->ApplyInvMany(n, x.data(), y.data(), lm.data(), pm.data(), NULL, NULL);
+    C->setbCalcScaleConv(false);
+    for (i=0; i<n; i++)
+    {
+        C->ApplyInv(x[i], y[i], &l[i], &p[i], &cv, &sf);
+        dInv = maxAbsDiff(maxAbsDiff(dInv, (lm[i]-l[i])*cos(p[i])*C->get_a()), (pm[i]-p[i])*C->get_a());
+    }
+    if (dDir > tolerance) nFail++;
+    *fo << (dDir > tolerance ? "FAIL " : "OK   ") << name << " ApplyMany: " << dDir << " m" << std::endl;
+    if (dInv > tolerance || dConv > 1e-12) nFail++;
+    *fo << (dInv > tolerance || dConv > 1e-12 ? "FAIL " : "OK   ") << name << " ApplyInvMany: " << dInv
+        << " m, convergence and scale factor: " << dConv << std::endl;
+    return nFail;
+}
+
+/**
+* \brief Sets the parameters of a projection for testApplyMany (InitParam must be called next).
+* \param C: A pointer to the projection.
+* \param[in] a, e2: The ellipsoid.
+* \param[in] lambda0, phi0, phi1, phi2 (degrees), k0, x0, y0: The parameters.
+*/
+static void initTestProjection(Conversion *C, double a, double e2, double lambda0, double phi0,
+                               double phi1, double phi2, double k0, double x0, double y0)
+{
+    C->reset();
+    C->set_a(a);
+    C->set_e2(e2);
+    C->setParameter("LAMBDA0", lambda0, "DEGREES");
+    C->setParameter("PHI0", phi0, "DEGREES");
+    C->setParameter("PHI1", phi1, "DEGREES");
+    C->setParameter("PHI2", phi2, "DEGREES");
+    C->setParameter("K0", k0, "");
+    C->setParameter("X0", x0, "");
+    C->setParameter("Y0", y0, "");
+}
+
+/**
+* \brief Compares the batch methods (ApplyMany, ApplyInvMany) of each projection with the point ones
+* (Apply, ApplyInv) over its domain, and writes the largest differences in a file.
+* \param[in] filout: The output file path.
+* \remark The batch methods run the same formulas as the point ones, so they are expected to agree
+* to rounding (1e-9 m).
+*/
+void testApplyMany(std::string filout)
+{
+    const double aGRS80 = 6378137., e2GRS80 = 0.00669438002290;
+    const double aHayford = 6378388., e2Hayford = 0.006722670022;
+    const double aClarke = 6378249.2, e2Clarke = 0.006803487646;
+    std::ofstream fo(filout.data());
+    unsigned int nFail = 0;
+    fo << std::setprecision(3);
+    ProjectionLCC lcc;
+    initTestProjection(&lcc, aGRS80, e2GRS80, 3., 46.5, 44., 49., 0., 700000., 6600000.);
+    lcc.InitParam(LCCSID, "", "");
+    nFail += compareApplyMany(&fo, "Lambert-93", &lcc, -5.5, 10., 41., 52., 1e-9);
+    initTestProjection(&lcc, aGRS80, e2GRS80, 3., 50., 49.25, 50.75, 0., 1700000., 9200000.);
+    lcc.InitParam(LCCSID, "", "");
+    nFail += compareApplyMany(&fo, "CC50", &lcc, -5.5, 10., 49., 51., 1e-9);
+    initTestProjection(&lcc, aClarke, e2Clarke, 2.33722917, 49.5, 0., 0., 0.99987734, 600000., 200000.);
+    lcc.InitParam(LCCTID, "", "");
+    nFail += compareApplyMany(&fo, "Lambert I", &lcc, -5.5, 10., 48., 51.5, 1e-9);
+    ProjectionTMerc tm;
+    initTestProjection(&tm, aGRS80, e2GRS80, -63., 0., 0., 0., 0.9996, 500000., 0.);
+    tm.InitParam(UTMNID, "", "");
+    nFail += compareApplyMany(&fo, "UTM 20N", &tm, -67., -59., 0., 30., 1e-9);
+    initTestProjection(&tm, aGRS80, e2GRS80, 57., 0., 0., 0., 0.9996, 500000., 10000000.);
+    tm.InitParam(UTMSID, "", "");
+    nFail += compareApplyMany(&fo, "UTM 40S", &tm, 53., 61., -30., 0., 1e-9);
+    ProjectionGLab glab;
+    initTestProjection(&glab, aHayford, e2Hayford, 55.53333333, -21.11666667, 0., 0., 1., 160000., 50000.);
+    glab.InitParam(GLSCID, "", "");
+    nFail += compareApplyMany(&fo, "Gauss-Laborde", &glab, 55., 56.2, -21.6, -20.6, 1e-9);
+    ProjectionLAEA laea;
+    initTestProjection(&laea, aGRS80, e2GRS80, 10., 52., 0., 0., 0., 4321000., 3210000.);
+    laea.InitParam(LAEAID, "", "");
+    nFail += compareApplyMany(&fo, "ETRS89-LAEA", &laea, -5.5, 10., 41., 52., 1e-9);
+    ProjectionSouthPolarStereographic sps;
+    initTestProjection(&sps, aHayford, e2Hayford, 140., -67., 0., 0., 0.960272946, 300000., 200000.);
+    sps.InitParam(SPSSID, "", "");
+    nFail += compareApplyMany(&fo, "South polar stereographic", &sps, 136., 142., -67.5, -65.5, 1e-9);
+    ProjectionHatt hatt;
+    initTestProjection(&hatt, aHayford, e2Hayford, -149.5, -17.6, 0., 0., 0., 0., 0.);
+    hatt.InitParam(HATTID, "", "");
+    nFail += compareApplyMany(&fo, "Hatt", &hatt, -150., -149., -18.1, -17.1, 1e-9);
+    fo << nFail << " failure(s)" << std::endl;
+    fo.close();
+}
 
 //EPSG 9836
 //Geographic/topocentric conversions 
@@ -95,6 +95,7 @@ class Conversion: public Operation
 {
 protected:
     double a, e2;
+    ellipsoidContext ellContext;
     double lambda0, phi0,  phi1, phi2, k0, x0, y0;
     double fromGreenwich;
     std::string initParamMethodId, applicationMethodId, applicationInvMethodId;
@@ -109,12 +110,14 @@ public:
     void InitParam(std::string IPMid, std::string AMid, std::string AIMid) ;
     virtual void Apply(double l, double p, double *x, double *y, double *conv, double *scfact){*x=l;*y=p;*conv=*scfact=0.;}
     virtual void ApplyInv(double x, double y, double *l, double *p, double *conv, double *scfact){*l=x;*p=y;*conv=*scfact=0.;}
+    virtual void ApplyMany(unsigned int np, const double *l, const double *p, double *x, double *y, double *conv, double *scfact);
+    virtual void ApplyInvMany(unsigned int np, const double *x, const double *y, double *l, double *p, double *conv, double *scfact);
 
     void setInitParamMethodId(std::string id) {initParamMethodId=id;}
     void setApplicationMethodId(std::string id) {applicationMethodId=id;}
     void setApplicationInvMethodId(std::string id) {applicationInvMethodId=id;}
-    void set_a(double _a) {a=_a;}
-    void set_e2(double _e2) {e2=_e2;}
+    void set_a(double _a) {a=_a; InitEllipsoidContext(a,e2,&ellContext);}
+    void set_e2(double _e2) {e2=_e2; InitEllipsoidContext(a,e2,&ellContext);}
     void setFromGreenwich(double _value) {fromGreenwich=_value;}
     void setParameter(std::string parameter_name,double _value,std::string unit);
     void setPrimeMeridianId(std::string id) {primeMeridianId=id;}
@@ -126,6 +129,7 @@ public:
     std::string getApplicationInvMethodId() const {return applicationInvMethodId;}
     double get_a() const {return a;}
     double get_e2() const {return e2;}
+    const ellipsoidContext& getEllipsoidContext() const {return ellContext;}
     double getFromGreenwich() const {return fromGreenwich;}
     std::string getPrimeMeridianId() const {return primeMeridianId;}
     bool getAddFromGreenwich() const {return addFromGreenwich;}
@@ -145,6 +149,8 @@ public:
     void InitParam(std::string IPMid, std::string AMid, std::string AIMid);
     void Apply(double l, double p, double *x, double *y, double *conv, double *scfact);
     void ApplyInv(double x, double y, double *l, double *p, double *conv, double *scfact);
+    void ApplyMany(unsigned int np, const double *l, const double *p, double *x, double *y, double *conv, double *scfact);
+    void ApplyInvMany(unsigned int np, const double *x, const double *y, double *l, double *p, double *conv, double *scfact);
 };
 	
 /**\brief This class manages operations between geographic and Mercator Transverse Projected coordinates.*/
@@ -152,6 +158,7 @@ class ProjectionTMerc : public Conversion
 {
 private:
     double lambdac, n, c, xs, ys;
+    double cDir[DEGRE+1], cInv[DEGRE+1];
 public:
     ProjectionTMerc();
 	ProjectionTMerc(const Conversion &B, double _a, double _e2); // copy constructor
@@ -160,6 +167,8 @@ public:
     void InitParam(std::string IPMid, std::string AMid, std::string AIMid);
     void Apply(double l, double p, double *x, double *y, double *conv, double *scfact);
     void ApplyInv(double x, double y, double *l, double *p, double *conv, double *scfact);
+    void ApplyMany(unsigned int np, const double *l, const double *p, double *x, double *y, double *conv, double *scfact);
+    void ApplyInvMany(unsigned int np, const double *x, const double *y, double *l, double *p, double *conv, double *scfact);
 };
 	
 /**\brief This class manages operations between geographic and Gauss-Laborde Projected coordinates.*/
@@ -176,6 +185,8 @@ public:
     void InitParam(std::string IPMid, std::string AMid, std::string AIMid);
     void Apply(double l, double p, double *x, double *y, double *conv, double *scfact);
     void ApplyInv(double x, double y, double *l, double *p, double *conv, double *scfact);
+    void ApplyMany(unsigned int np, const double *l, const double *p, double *x, double *y, double *conv, double *scfact);
+    void ApplyInvMany(unsigned int np, const double *x, const double *y, double *l, double *p, double *conv, double *scfact);
 };
 	
 /**\brief This class manages operations between geographic and Lambert Azimuthal Equal Area (LAEA) Projected coordinates.*/
@@ -191,6 +202,8 @@ public:
     void InitParam(std::string IPMid, std::string AMid, std::string AIMid);
     void Apply(double l, double p, double *x, double *y, double *conv, double *scfact);
     void ApplyInv(double x, double y, double *l, double *p, double *conv, double *scfact);
+    void ApplyMany(unsigned int np, const double *l, const double *p, double *x, double *y, double *conv, double *scfact);
+    void ApplyInvMany(unsigned int np, const double *x, const double *y, double *l, double *p, double *conv, double *scfact);
 };
 
 /**\brief This class manages operations between geographic and South Polar Stereographic Projected coordinates.*/
@@ -206,12 +219,16 @@ public:
     void InitParam(std::string IPMid, std::string AMid, std::string AIMid);
     void Apply(double l, double p, double *x, double *y, double *conv, double *scfact);
     void ApplyInv(double x, double y, double *l, double *p, double *conv, double *scfact);
+    void ApplyMany(unsigned int np, const double *l, const double *p, double *x, double *y, double *conv, double *scfact);
+    void ApplyInvMany(unsigned int np, const double *x, const double *y, double *l, double *p, double *conv, double *scfact);
 };
 
 
 /**\brief This class manages operations between geographic and Hatt Projected coordinates.*/
 class ProjectionHatt : public Conversion
 {
+private:
+    hattContext hc;
 public:
     ProjectionHatt();
     ProjectionHatt(const Conversion &B, double _a, double _e2); // copy constructor
@@ -220,8 +237,12 @@ public:
     void InitParam(std::string IPMid, std::string AMid, std::string AIMid);
     void Apply(double l, double p, double *x, double *y, double *conv, double *scfact);
     void ApplyInv(double x, double y, double *l, double *p, double *conv, double *scfact);
+    void ApplyMany(unsigned int np, const double *l, const double *p, double *x, double *y, double *conv, double *scfact);
+    void ApplyInvMany(unsigned int np, const double *x, const double *y, double *l, double *p, double *conv, double *scfact);
 };
 
+void testApplyMany(std::string filout);
+
 } //namespace circe
 
 #endif // CONVERSION_H
@@ -40,6 +40,9 @@ can be found at http://geodesie.ign.fr/index.php?page=algorithmes.
 */
 
 #include "conversioncore.h"
+#include <fstream> //testGeoCartMany
+#include <iomanip> //testGeoCartMany
+#include <vector> //testGeoCartMany
 
 /**\brief Polynom calculation*/
 double polynome ( double x, int degre, double coef[])
@@ -72,23 +75,58 @@ double LatIso(double phi, double e2)
   }
 
 
-/**\brief alg0002 Reverse Isometric Latitude */
-double LatIsoInv(double latiso, double e2)
+/**\brief Coefficients of the series (up to e^8) of the latitude as a function of the conformal latitude.*/
+void CoefLatConf(double e2, double cs[4])
 {
-	int LatIsoInv_niter;
-	double l0, l1;
-	double epsilon_phi = 1e-12;  // radians soit 0.01 mm par defaut
-	double e = sqrt(e2);
+  double e4 = e2*e2, e6 = e4*e2, e8 = e6*e2;
+  cs[0] = e2/2 + 5*e4/24 + e6/12 + 13*e8/360;
+  cs[1] = 7*e4/48 + 29*e6/240 + 811*e8/11520;
+  cs[2] = 7*e6/120 + 81*e8/1120;
+  cs[3] = 4279*e8/161280;
+}
 
-  l1 = 2*atan(exp(latiso)) - M_PI_2;
-  l0 = 100.;
-  for (LatIsoInv_niter=0; fabs(l1-l0)>epsilon_phi; LatIsoInv_niter++)
+/**\brief alg0002 Reverse Isometric Latitude, without iteration: the latitude is given by the series
+(see CoefLatConf) as a function of the conformal latitude, summed by Clenshaw's method, then refined
+by a single Newton step on the isometric latitude. For e2 up to 0.0068, the series is within 2.2e-12 rad
+of the exact value over +/-89.9 degrees and the result within 4e-16 rad (the former iteration, stopped
+at a 1e-12 step, was within 7e-15 rad for about three times the cost).
+\param[in] latiso: the isometric latitude.
+\param[in] e, e2: the eccentricity and its square.
+\param[in] cs: the coefficients computed by CoefLatConf(e2, cs).*/
+static inline double LatIsoInvFixed(double latiso, double e, double e2, const double cs[4])
+{
+  //sine and cosine of the conformal latitude
+  double sc = tanh(latiso), cc = 1/cosh(latiso);
+  double chi = atan2(sc, cc);
+  double x = 2*(1 - 2*sc*sc), b1 = 0, b2 = 0;
+  for (int k=3; k>=0; k--)
   {
-    l0 = l1;
-    l1 = 2 * atan( exp(e*log((1+e*sin(l0))/(1-e*sin(l0)))/2) * exp(latiso) )
-	 - M_PI_2;
+    double b0 = x*b1 - b2 + cs[k];
+    b2 = b1;
+    b1 = b0;
   }
-  return l1;
+  double phi = chi + 2*sc*cc*b1;
+  double sp = sin(phi), cp = cos(phi), es = e*sp;
+  return phi - (asinh(sp/cp) - e*atanh(es) - latiso)*(1-es*es)*cp/(1-e2);
+}
+
+/**\brief alg0002 Reverse Isometric Latitude (see LatIsoInvFixed for the method and the accuracy).
+On the sphere (e2 = 0), it is the Gudermannian function.*/
+double LatIsoInv(double latiso, double e2)
+{
+  if (e2 == 0.)
+    return 2*atan(exp(latiso)) - M_PI_2;
+  double cs[4];
+  CoefLatConf(e2, cs);
+  return LatIsoInvFixed(latiso, sqrt(e2), e2, cs);
+}
+
+/**\brief alg0002 Reverse Isometric Latitude, with the series coefficients of an ellipsoidContext.*/
+double LatIsoInv(const ellipsoidContext &ec, double latiso)
+{
+  if (ec.e2 == 0.)
+    return 2*atan(exp(latiso)) - M_PI_2;
+  return LatIsoInvFixed(latiso, ec.e, ec.e2, ec.clc);
 }
 
 /**\brief alg0003 Geographic to Lambert Conformal Conic (LCC) Projected coordinates */
@@ -106,6 +144,16 @@ void GeoLambert(double e2, double n, double c, double lambdac,
 /**\brief alg0004 Lambert Conformal Conic (LCC) Projected to Geographic coordinates */
 void LambertGeo(double e2, double n, double c, double lambdac,
 	double xs, double ys, double *lambda, double *phi, double x, double y)
+{
+  ellipsoidContext ec;
+  InitEllipsoidContext(0., e2, &ec);
+  LambertGeo(ec, n, c, lambdac, xs, ys, lambda, phi, x, y);
+}
+
+/**\brief alg0004 Lambert Conformal Conic (LCC) Projected to Geographic coordinates, with the
+coefficients of an ellipsoidContext.*/
+void LambertGeo(const ellipsoidContext &ec, double n, double c, double lambdac,
+	double xs, double ys, double *lambda, double *phi, double x, double y)
 {
   double r, gamma, latiso;
 
@@ -113,7 +161,42 @@ void LambertGeo(double e2, double n, double c, double lambdac,
   gamma = atan((x-xs)/(ys-y));
   *lambda = lambdac+gamma/n;
   latiso = -log(fabs(r/c))/n;
-  *phi = LatIsoInv(latiso, e2);
+  *phi = LatIsoInv(ec, latiso);
+}
+
+/**\brief alg0003 Geographic to Lambert Conformal Conic (LCC) Projected coordinates, for np points
+stored in contiguous arrays. The loop has no branch nor call other than math functions so that it
+can be vectorized by the compiler.*/
+void GeoLambertMany(double e2, double n, double c, double lambdac,
+		double xs, double ys, unsigned int np,
+		const double *lambda, const double *phi, double *x, double *y)
+{
+  double e = sqrt(e2);
+  for (unsigned int i=0; i<np; i++)
+  {
+    double es = e*sin(phi[i]);
+    double li = log(tan(M_PI_4+phi[i]/2)) + e*log( (1-es)/(1+es) )/2;
+    double ex = exp(-n*li);
+    double dl = n*(lambda[i]-lambdac);
+    x[i] = xs + c * ex * sin(dl);
+    y[i] = ys - c * ex * cos(dl);
+  }
+}
+
+/**\brief alg0004 Lambert Conformal Conic (LCC) Projected to Geographic coordinates, for np points
+stored in contiguous arrays.*/
+void LambertGeoMany(double e2, double n, double c, double lambdac,
+	double xs, double ys, unsigned int np, double *lambda, double *phi, const double *x, const double *y)
+{
+  double e = sqrt(e2), cs[4];
+  CoefLatConf(e2, cs);
+  for (unsigned int i=0; i<np; i++)
+  {
+    double dx = x[i]-xs, dy = ys-y[i];
+    double r = sqrt(dx*dx + dy*dy);
+    lambda[i] = lambdac+atan(dx/dy)/n;
+    phi[i] = LatIsoInvFixed(-log(fabs(r/c))/n, e, e2, cs);
+  }
 }
 
 /**\brief alg0009 Geographic to Geocentric coordinates*/
@@ -126,6 +209,124 @@ void GeoCart(double a, double e2, double lambda, double phi, double h, double *x
 	  *z = (gn*(1-e2)+h)*sin(phi);
 }
 
+/**\brief Initializes the constants derived from an ellipsoid.
+\param[in] a: the semi-major axis.
+\param[in] e2: the squared eccentricity.
+\param[out] ec: a pointer to an ellipsoidContext instance.*/
+void InitEllipsoidContext(double a, double e2, ellipsoidContext *ec)
+{
+	ec->a = a;
+	ec->e2 = e2;
+	ec->e2m = 1-e2;
+	ec->e4 = e2*e2;
+	ec->e = sqrt(e2);
+	ec->sqe2m = sqrt(1-e2);
+	ec->b = a*ec->sqe2m;
+	ec->fst = exp(ec->e/2*log((1-ec->e)/(1+ec->e)));
+	CoefLatConf(e2, ec->clc);
+}
+
+/**\brief alg0009 Geographic to Geocentric coordinates (same results as GeoCart(a, e2, ...)).*/
+void GeoCart(const ellipsoidContext &ec, double lambda, double phi, double h, double *x, double *y, double *z)
+{
+	double sp = sin(phi), cp = cos(phi);
+	double gn = ec.a/sqrt(1 - ec.e2*sp*sp);
+	*x = (gn+h)*cp*cos(lambda);
+	*y = (gn+h)*cp*sin(lambda);
+	*z = (gn*ec.e2m+h)*sp;
+}
+
+/**\brief alg0009 Geographic to Geocentric coordinates, for np points stored in contiguous arrays.*/
+void GeoCartMany(const ellipsoidContext &ec, unsigned int np, const double *lambda, const double *phi, const double *h,
+				 double *x, double *y, double *z)
+{
+	for (unsigned int i=0; i<np; i++)
+	{
+		double sp = sin(phi[i]), cp = cos(phi[i]);
+		double gn = ec.a/sqrt(1 - ec.e2*sp*sp);
+		x[i] = (gn+h[i])*cp*cos(lambda[i]);
+		y[i] = (gn+h[i])*cp*sin(lambda[i]);
+		z[i] = (gn*ec.e2m+h[i])*sp;
+	}
+}
+
+/**\brief Geocentric to Geographic coordinates, closed form of H. Vermeille (An analytical method
+to transform geocentric into geodetic coordinates, J. Geod. 85, 2011) with the safeguards of
+C. Karney (GeographicLib) for the points inside the evolute of the meridian ellipse.
+For any point, from the geocentre to 1e9 m, the latitude is within 2e-9 m and the height within
+4e-9 m (terrestrial points) to 1e-8 m (20000 km) of the exact values, that is the rounding error
+of the computation (algo 56 is within 2e-6 m for terrestrial points and diverges near the geocentre).
+At the geocentre, the latitude is +90 degrees and the height -b.*/
+void CartGeo(const ellipsoidContext &ec, double x, double y, double z, double *lambda, double *phi, double *h)
+{
+	double R = sqrt(x*x + y*y);
+	double p = (R/ec.a)*(R/ec.a), q = ec.e2m*(z/ec.a)*(z/ec.a), r = (p+q-ec.e4)/6;
+	*lambda = atan2(y, x);
+	if (ec.e4*q != 0 || r > 0)
+	{
+		double S = ec.e4*p*q/4, r2 = r*r, r3 = r*r2, disc = S*(S+2*r3), u = r;
+		if (disc >= 0)
+		{
+			double T3 = S+r3;
+			T3 += T3 < 0 ? -sqrt(disc) : sqrt(disc);
+			double T = cbrt(T3);
+			u += T + (T != 0 ? r2/T : 0);
+		}
+		else
+			u += 2*r*cos(atan2(sqrt(-disc), -(S+r3))/3);
+		double v = sqrt(u*u + ec.e4*q);
+		double uv = u < 0 ? ec.e4*q/(v-u) : u+v;
+		double w = ec.e2*(uv-q)/(2*v);
+		if (w < 0) w = 0;
+		double k = uv/(sqrt(uv+w*w)+w);
+		double d = k*R/(k+ec.e2);
+		*phi = atan2(z/k, R/(k+ec.e2));
+		*h = (1-ec.e2m/k)*sqrt(d*d+z*z);
+	}
+	else
+	{
+		//Point of the equatorial plane inside the evolute
+		double zz = sqrt((ec.e4-p)/ec.e2m), xx = sqrt(p);
+		*phi = atan2(z < 0 ? -zz : zz, xx);
+		*h = -ec.a*ec.e2m*sqrt(zz*zz+xx*xx)/ec.e2;
+	}
+}
+
+/**\brief Geocentric to Geographic coordinates (see CartGeo), for np points stored in contiguous arrays.*/
+void CartGeoMany(const ellipsoidContext &ec, unsigned int np, const double *x, const double *y, const double *z,
+				 double *lambda, double *phi, double *h)
+{
+	for (unsigned int i=0; i<np; i++)
+		CartGeo(ec, x[i], y[i], z[i], lambda+i, phi+i, h+i);
+}
+
+/**\brief Applies a precomputed Helmert transformation to a geocentric coordinate set.
+M is stored as I+D (3x3) and T: x2 = x1 + T + D*x1, with M[0..3] = D00 D01 D02 Tx, M[4..7] = D10 D11 D12 Ty,
+M[8..11] = D20 D21 D22 Tz. Keeping the identity apart preserves the precision of the small terms.*/
+void HelmertCart(const double M[12], double x1, double y1, double z1, double *x2, double *y2, double *z2)
+{
+	*x2 = x1 + M[3] + M[0]*x1 + M[1]*y1 + M[2]*z1;
+	*y2 = y1 + M[7] + M[4]*x1 + M[5]*y1 + M[6]*z1;
+	*z2 = z1 + M[11] + M[8]*x1 + M[9]*y1 + M[10]*z1;
+}
+
+/**\brief Composes two Helmert transformations stored as in HelmertCart: M = M2 o M1 (M1 applied first).
+M may be M1 or M2.*/
+void HelmertCompose(const double M2[12], const double M1[12], double M[12])
+{
+	double R[12];
+	for (int i=0; i<3; i++)
+	{
+		for (int j=0; j<3; j++)
+			R[4*i+j] = M1[4*i+j] + M2[4*i+j]
+					 + M2[4*i]*M1[j] + M2[4*i+1]*M1[4+j] + M2[4*i+2]*M1[8+j];
+		R[4*i+3] = M1[4*i+3] + M2[4*i+3]
+				 + M2[4*i]*M1[3] + M2[4*i+1]*M1[7] + M2[4*i+2]*M1[11];
+	}
+	for (int k=0; k<12; k++)
+		M[k] = R[k];
+}
+
 /**\brief alg0014 Rotation about an axis */
 void RotAxe(char axe,double angle,double ux,double uy,double uz,double *vx,double *vy,double *vz)
 {
@@ -230,6 +431,40 @@ void VertDeflection(double a, double e2, double phi, double dphi, double dlambda
     *eta = dNwe / LPar(a, e2, phi, dlambda);
 }
 
+/**\brief algo0021 length of the prime vertical (same results as GrandeNormale(phi, a, e2)).*/
+double GrandeNormale(const ellipsoidContext &ec, double phi)
+{
+	double sp = sin(phi);
+	return ec.a/sqrt(1 - ec.e2*sp*sp);
+}
+
+/**\brief Radius of curvature in the plane of the meridian (same results as RMer(a, e2, phi)).*/
+double RMer(const ellipsoidContext &ec, double phi)
+{
+	double sp = sin(phi), w = 1 - ec.e2*sp*sp;
+	return ec.a/sqrt(w)*ec.e2m/w;
+}
+
+/**\brief Length of a small arc of meridian (same results as LMer(a, e2, phi, dphi)).*/
+double LMer(const ellipsoidContext &ec, double phi, double dphi)
+{
+	return RMer(ec,phi)*dphi;
+}
+
+/**\brief Length of a small arc of parallel (same results as LPar(a, e2, phi, dlambda)).*/
+double LPar(const ellipsoidContext &ec, double phi, double dlambda)
+{
+	return GrandeNormale(ec,phi)*cos(phi)*dlambda;
+}
+
+/**\brief Vertical Deflection (same results as VertDeflection(a, e2, ...)).*/
+void VertDeflection(const ellipsoidContext &ec, double phi, double dphi, double dlambda,
+                    double dNwe, double dNsn, double *xi, double *eta)
+{
+    *xi = dNsn / LMer(ec, phi, dphi);
+    *eta = dNwe / LPar(ec, phi, dlambda);
+}
+
 /**\brief alg0025 Coefficients for Meridian arc length.*/
 void CoeffArcMer(double e2, double c[DEGRE+1])
   {
@@ -290,15 +525,45 @@ void CoefProjMercTrInv(double e2, double c[DEGRE+1])
 
 }
 
+/**\brief Clenshaw summation of sum(c[i]*sin(2*i*z), i=1..DEGRE) for the complex z = u + i*v,
+in real arithmetic with a single sin/cos and sinh/cosh pair.
+\param[out] sr, si: the real and imaginary parts of the sum.*/
+static inline void ClenshawSin2(const double c[DEGRE+1], double u, double v, double *sr, double *si)
+{
+  double s2 = sin(2*u), c2 = cos(2*u), sh2 = sinh(2*v), ch2 = cosh(2*v);
+  // 2*cos(2z)
+  double ar = 2*c2*ch2, ai = -2*s2*sh2;
+  double br = 0, bi = 0, b2r = 0, b2i = 0, tr, ti;
+  for (int i=DEGRE; i>=1; i--)
+  {
+    tr = c[i] + ar*br - ai*bi - b2r;
+    ti = ar*bi + ai*br - b2i;
+    b2r = br;
+    b2i = bi;
+    br = tr;
+    bi = ti;
+  }
+  // b1*sin(2z)
+  *sr = br*s2*ch2 - bi*c2*sh2;
+  *si = br*c2*sh2 + bi*s2*ch2;
+}
+
 /**\brief alg0030 Geographic to Mercator Transverse Projected coordinates.*/
 void GeoMercTr(double lambda0, double n, double xs, double ys,
 	double e2, double lambda, double phi, double *x, double *y)
 {
-	double phi1, lambda1, l, ls, c[5];
+	double c[DEGRE+1];
+	CoefProjMercTrDir(e2, c);
+	GeoMercTr(lambda0, n, xs, ys, e2, c, lambda, phi, x, y);
+}
 
-  int i;
+/**\brief alg0030 Geographic to Mercator Transverse Projected coordinates, with the coefficients
+computed by CoefProjMercTrDir.*/
+void GeoMercTr(double lambda0, double n, double xs, double ys,
+	double e2, const double c[DEGRE+1], double lambda, double phi, double *x, double *y)
+{
+	double phi1, lambda1, l, ls, sr, si;
 
-	CoefProjMercTrDir(e2, c);
 	l = LatIso(phi, e2);
 	lambda1 = M_PI_2;
 	if ( l == +INF )
@@ -315,40 +580,75 @@ void GeoMercTr(double lambda0, double n, double xs, double ys,
 	}
 	ls = LAT_CROISSANTE(phi1);
 
-    std::complex <double> z(lambda1 , ls) ;
-    std::complex <double> zz ;
-	zz = n * c[0] * z ;
-	for ( i=1 ; i<5 ; i++ ) 
-		zz +=  n * c[i] * sin( (2.0*i*z) );
-	*x = xs + zz.imag();
-	*y = ys + zz.real();
+	ClenshawSin2(c, lambda1, ls, &sr, &si);
+	*x = xs + n * (c[0] * ls + si);
+	*y = ys + n * (c[0] * lambda1 + sr);
+}
 
+/**\brief alg0030 Geographic to Mercator Transverse Projected coordinates, for np points stored
+in contiguous arrays, with the coefficients computed by CoefProjMercTrDir.*/
+void GeoMercTrMany(double lambda0, double n, double xs, double ys, double e2, const double c[DEGRE+1],
+	unsigned int np, const double *lambda, const double *phi, double *x, double *y)
+{
+	for (unsigned int i=0; i<np; i++)
+		GeoMercTr(lambda0, n, xs, ys, e2, c, lambda[i], phi[i], x+i, y+i);
 }
 
 /**\brief Mercator Transverse Projected to Geographic coordinates (complex method).*/
 void MercTrGeo(double lambda0, double n, double xs, double ys, double e2,
 	double *lambda, double *phi, double x, double y)
 {
-	double l, ls, phi1, c[5];
-	int i;
-
+	double c[DEGRE+1];
 	CoefProjMercTrInv(e2, c);
+	MercTrGeo(lambda0, n, xs, ys, e2, c, lambda, phi, x, y);
+}
 
-    std::complex <double>z ( (y-ys)/(n*c[0]), (x-xs)/(n*c[0]) ) ;
-    std::complex <double>zp ( (y-ys)/(n*c[0]), (x-xs)/(n*c[0]) ) ;
-	l = z.real();
-	ls = z.imag();
-	for (i=1; i<5; i++)
-	{
-	    z -= c[i] * sin( (2.0*i*zp) );
-		l = z.real();
-		ls = z.imag();
-	}
+/**\brief Mercator Transverse Projected to Geographic coordinates (complex method), with the
+coefficients computed by CoefProjMercTrInv.*/
+void MercTrGeo(double lambda0, double n, double xs, double ys, double e2, const double c[DEGRE+1],
+	double *lambda, double *phi, double x, double y)
+{
+	ellipsoidContext ec;
+	InitEllipsoidContext(0., e2, &ec);
+	MercTrGeo(ec, lambda0, n, xs, ys, c, lambda, phi, x, y);
+}
+
+/**\brief Mercator Transverse Projected to Geographic coordinates (complex method), with the
+coefficients computed by CoefProjMercTrInv and those of an ellipsoidContext.*/
+void MercTrGeo(const ellipsoidContext &ec, double lambda0, double n, double xs, double ys, const double c[DEGRE+1],
+	double *lambda, double *phi, double x, double y)
+{
+	double l, ls, phi1, sr, si;
+	double u = (y-ys)/(n*c[0]), v = (x-xs)/(n*c[0]);
+
+	ClenshawSin2(c, u, v, &sr, &si);
+	l = u - sr;
+	ls = v - si;
 
 	*lambda = lambda0 + atan(sinh(ls)/cos(l));
 	phi1 = asin(sin(l)/cosh(ls));
 	l = LAT_CROISSANTE(phi1);
-	*phi = LatIsoInv(l, e2);
+	*phi = LatIsoInv(ec, l);
+}
+
+/**\brief Mercator Transverse Projected to Geographic coordinates (complex method), for np points
+stored in contiguous arrays, with the coefficients computed by CoefProjMercTrInv.*/
+void MercTrGeoMany(double lambda0, double n, double xs, double ys, double e2, const double c[DEGRE+1],
+	unsigned int np, double *lambda, double *phi, const double *x, const double *y)
+{
+	double e = sqrt(e2), cs[4];
+	CoefLatConf(e2, cs);
+	for (unsigned int i=0; i<np; i++)
+	{
+		double l, ls, phi1, sr, si;
+		double u = (y[i]-ys)/(n*c[0]), v = (x[i]-xs)/(n*c[0]);
+		ClenshawSin2(c, u, v, &sr, &si);
+		l = u - sr;
+		ls = v - si;
+		lambda[i] = lambda0 + atan(sinh(ls)/cos(l));
+		phi1 = asin(sin(l)/cosh(ls));
+		phi[i] = LatIsoInvFixed(log(tan(M_PI_4+phi1/2)), e, e2, cs);
+	}
 }
 
 /**\brief  alg0052 Coefficients for Mercator Transverse Projection.*/
@@ -381,12 +681,23 @@ void GeoGaussLab(double c, double n1, double n2, double xs, double ys,
 void GaussLabGeo(double c, double n1, double n2, double xs, double ys, 
 						double e2, double lambdac, double *lambda, double *phi, 
 						double x, double y)
+{
+	ellipsoidContext ec;
+	InitEllipsoidContext(0., e2, &ec);
+	GaussLabGeo(ec, c, n1, n2, xs, ys, lambdac, lambda, phi, x, y);
+}
+
+/**\brief alg0035 Gauss-Laborde Projected to Geographic coordinates, with the coefficients of an
+ellipsoidContext.*/
+void GaussLabGeo(const ellipsoidContext &ec, double c, double n1, double n2, double xs, double ys,
+						double lambdac, double *lambda, double *phi,
+						double x, double y)
 {
 	double LAMBDA, ls;
 	LAMBDA = atan( sinh((x-xs)/n2)/cos((y-ys)/n2) );
 	ls = LAT_CROISSANTE(asin(sin((y-ys)/n2)/cosh((x-xs)/n2)));
 	*lambda = lambdac + LAMBDA/n1;
-	*phi = LATISO_INV((ls-c)/n1);
+	*phi = LatIsoInv(ec, (ls-c)/n1);
 }
 
 /**\brief alg0043 Parameters of Oblique Stereographic Projection.*/
@@ -394,16 +705,27 @@ void CoefProjSterObl(int choix,double a,double e2,double lambda0,double phi0,
           double k0,double x0,double y0,double *lambdac,
           double *phic,double *c,double *n1,double *n2, double *xs, double *ys)
 {
-double e = sqrt(e2);
-double f = exp(e/2*log((1-e)/(1+e)));
+    ellipsoidContext ec;
+    InitEllipsoidContext(a, e2, &ec);
+    CoefProjSterObl(choix, ec, lambda0, phi0, k0, x0, y0, lambdac, phic, c, n1, n2, xs, ys);
+}
+
+/**\brief alg0043 Parameters of Oblique Stereographic Projection, the constants of the ellipsoid
+being taken from an ellipsoidContext.*/
+void CoefProjSterObl(int choix, const ellipsoidContext &ec, double lambda0, double phi0,
+          double k0,double x0,double y0,double *lambdac,
+          double *phic,double *c,double *n1,double *n2, double *xs, double *ys)
+{
+double a = ec.a, e2 = ec.e2;
+double sp0 = sin(phi0), cp0 = cos(phi0);
 double r0;
  switch (choix){
   case 1:/*sphere courbure*/
    *lambdac=lambda0;
-   *n1=sqrt(1+e2*pow(cos(phi0),4)/(1-e2));
-   *phic=asin(sin(phi0)/ *n1);
+   *n1=sqrt(1+e2*pow(cp0,4)/ec.e2m);
+   *phic=asin(sp0/ *n1);
    *c=LatIso(*phic,0)-*n1*LatIso(phi0,e2);
-   *n2=k0*a*sqrt(1-e2)/(1-e2*pow(sin(phi0),2));
+   *n2=k0*a*ec.sqe2m/(1-e2*sp0*sp0);
    *xs=x0;
    *ys=y0;
   break;
@@ -413,7 +735,7 @@ double r0;
    *n1=1;
    *phic=phi0;
    *c=LatIso(*phic,0)-*n1*LatIso(phi0,e2);
-   *n2=k0*a/sqrt(1-e2*pow(sin(phi0),2));
+   *n2=k0*a/sqrt(1-e2*sp0*sp0);
    *xs=x0;
    *ys=y0;
   break;
@@ -423,7 +745,7 @@ double r0;
    *n1=1;
    *phic=LatIsoInv(LatIso(phi0,e2),0);
    *c=0;
-   *n2=k0*a*cos(phi0)/sqrt(1-e2*pow(sin(phi0),2));
+   *n2=k0*a*cp0/sqrt(1-e2*sp0*sp0);
    *xs=x0;
    *ys=y0;
   break;
@@ -433,7 +755,7 @@ double r0;
    *n1=1;
    *phic=M_PI_2;
    *c=0;
-   *n2=a*k0/sqrt(1-e2)*f;
+   *n2=a*k0/ec.sqe2m*ec.fst;
    *xs=x0;
    *ys=y0;
   break;
@@ -443,7 +765,7 @@ double r0;
     *n1=1;
     *phic=-M_PI_2;
     *c=0;
-    *n2=a*k0/sqrt(1-e2)*f;
+    *n2=a*k0/ec.sqe2m*ec.fst;
     *xs=x0;
     *ys=y0;
    break;
@@ -453,7 +775,7 @@ double r0;
   *n1=1;
   *phic=M_PI_2;
   *c=0;
-     r0=a*cos(phi0)/sqrt(1-e2*pow(sin(phi0),2));
+     r0=a*cp0/sqrt(1-e2*sp0*sp0);
   *n2=r0*exp(LatIso(phi0,e2))/2.;
   *xs=x0;
   *ys=y0-r0;
@@ -464,7 +786,7 @@ double r0;
   *n1=1;
   *phic=-M_PI_2;
   *c=0;
-     r0=a*cos(phi0)/sqrt(1-e2*pow(sin(phi0),2));
+     r0=a*cp0/sqrt(1-e2*sp0*sp0);
   *n2=r0*exp(-LatIso(phi0,e2))/2.;
   *xs=x0;
   *ys=y0-r0;
@@ -632,6 +954,16 @@ void GeoSterPolSud(double c, double n1, double n2, double xs, double ys, double
 // This algo has to be reviewed. It is correct but in a strange shape (see rho = ...).
 void SterPolSudGeo(double n1, double n2, double xs, double ys, double e2, double c,
                    double lambdac, double phic, double* l, double* p, double x, double y)
+{
+    ellipsoidContext ec;
+    InitEllipsoidContext(0., e2, &ec);
+    SterPolSudGeo(ec, n1, n2, xs, ys, c, lambdac, phic, l, p, x, y);
+}
+
+/**\brief alg0070 Secant South Polar Stereographic Projected to Geographic coordinates, with the
+coefficients of an ellipsoidContext.*/
+void SterPolSudGeo(const ellipsoidContext &ec, double n1, double n2, double xs, double ys, double c,
+                   double lambdac, double phic, double* l, double* p, double x, double y)
 {
     double LAMBDA, PHI, LAMBDAp, PHIp, rho;
     double r = sqrt(pow(x-xs,2)+pow(y-ys,2));
@@ -653,7 +985,7 @@ void SterPolSudGeo(double n1, double n2, double xs, double ys, double e2, double
         PHI = atan2(-sin(PHIp),rho);
     }
     *l = lambdac + LAMBDA;
-    *p = LatIsoInv(LatIso(PHI,0),e2);
+    *p = LatIsoInv(ec, LatIso(PHI,0));
 }
 
 /**\brief alg0070 Test of Secant South Polar Stereographic Projection.*/
@@ -696,6 +1028,54 @@ void testGeoSterPolSud()
     printf ("SterPolSudGeo:x=%.3lf;y=%.3lf/l=%.10lf;p=%.10lf\n",x,y,l,p);
 }
 
+/**\brief Compares GeoCartMany and CartGeoMany with GeoCart and CartGeo on a lattice of geographic points
+(all longitudes and latitudes, heights from -10 km to 20000 km), checks the round trip against the
+accuracy stated for CartGeo, and writes the largest differences in filout.*/
+void testGeoCartMany(std::string filout)
+{
+	const double ell[2][2] = {{6378137., 0.00669438002290}, {6378249.2, 0.006803487646}};
+	const char *ellName[2] = {"GRS80", "Clarke 1880 IGN"};
+	const double hgt[5] = {-1e4, 0., 1e3, 1e5, 2e7};
+	const unsigned int nl = 37, np = 73, nh = 5, n = nl*np*nh;
+	std::ofstream fo(filout.data());
+	fo << std::setprecision(3);
+	std::vector<double> l(n), p(n), h(n), x(n), y(n), z(n), xm(n), ym(n), zm(n), lm(n), pm(n), hm(n);
+	unsigned int i, nFail = 0;
+	for (i=0; i<n; i++)
+	{
+		l[i] = (-180.+10.*(i%nl))*M_PI/180.;
+		p[i] = (-90.+2.5*((i/nl)%np))*M_PI/180.;
+		h[i] = hgt[i/(nl*np)];
+	}
+	for (int k=0; k<2; k++)
+	{
+		ellipsoidContext ec;
+		InitEllipsoidContext(ell[k][0], ell[k][1], &ec);
+		double dDir = 0., dInv = 0., dTrip = 0., d, lm1, pm1, hm1;
+		GeoCartMany(ec, n, l.data(), p.data(), h.data(), xm.data(), ym.data(), zm.data());
+		CartGeoMany(ec, n, xm.data(), ym.data(), zm.data(), lm.data(), pm.data(), hm.data());
+		for (i=0; i<n; i++)
+		{
+			GeoCart(ec, l[i], p[i], h[i], &x[i], &y[i], &z[i]);
+			d = fabs(xm[i]-x[i]) + fabs(ym[i]-y[i]) + fabs(zm[i]-z[i]);
+			if (!(d <= dDir)) dDir = std::isnan(d) ? INF : d;
+			CartGeo(ec, xm[i], ym[i], zm[i], &lm1, &pm1, &hm1);
+			d = (fabs(lm[i]-lm1)*cos(pm1) + fabs(pm[i]-pm1))*ec.a + fabs(hm[i]-hm1);
+			if (!(d <= dInv)) dInv = std::isnan(d) ? INF : d;
+			d = fabs(remainder(lm[i]-l[i], 2*M_PI))*cos(p[i])*(ec.a+h[i]);
+			d += fabs(pm[i]-p[i])*(ec.a+h[i]) + fabs(hm[i]-h[i]);
+			if (!(d <= dTrip)) dTrip = std::isnan(d) ? INF : d;
+		}
+		if (dDir > 0. || dInv > 0.) nFail++;
+		fo << (dDir > 0. || dInv > 0. ? "FAIL " : "OK   ") << ellName[k] << " GeoCartMany: " << dDir
+		   << " m, CartGeoMany: " << dInv << " m" << std::endl;
+		if (dTrip > 5e-8) nFail++;
+		fo << (dTrip > 5e-8 ? "FAIL " : "OK   ") << ellName[k] << " CartGeoMany(GeoCartMany): " << dTrip << " m" << std::endl;
+	}
+	fo << nFail << " failure(s)" << std::endl;
+	fo.close();
+}
+
 /**\brief alg0072 Parameters of Lambert Azimuthal Equal Area (LAEA) Projection.*/
 double q_(double e2, double phi)
 {
@@ -835,54 +1215,122 @@ double ShifTnTilT (double a1, double a2, double a3, double lambda0, double phi0,
     return a1 + a2*RMer(a,e2,phi)*(phi-phi0) + a3*GrandeNormale(phi,a,e2)*(lambda-lambda0)*cos(phi);
 }
 
+/**\brief Same as ShifTnTilT(a1, a2, a3, lambda0, phi0, a, e2, lambda, phi), with sin(phi) computed once.*/
+double ShifTnTilT (double a1, double a2, double a3, double lambda0, double phi0, const ellipsoidContext &ec,
+                 double lambda, double phi)
+{
+    double sp = sin(phi), w = 1 - ec.e2*sp*sp, gn = ec.a/sqrt(w);
+    return a1 + a2*(gn*ec.e2m/w)*(phi-phi0) + a3*gn*(lambda-lambda0)*cos(phi);
+}
+
+/**\brief Initializes the constants of a Hatt projection.
+\param[in] ec: the constants of the ellipsoid.
+\param[in] lambda0, phi0: the geographic coordinates of the origin (rad).
+\param[in] x0, y0: the false easting and northing (m).
+\param[out] hc: a pointer to a hattContext instance.*/
+void InitHattContext(const ellipsoidContext &ec, double lambda0, double phi0, double x0, double y0, hattContext *hc)
+{
+    hc->lambda0 = lambda0;
+    hc->phi0 = phi0;
+    hc->x0 = x0;
+    hc->y0 = y0;
+    hc->a = ec.a;
+    hc->e2 = ec.e2;
+    hc->e2m = ec.e2m;
+    hc->sphi0 = sin(phi0);
+    hc->cphi0 = cos(phi0);
+    hc->n0 = GrandeNormale(ec, phi0);
+    hc->e2n0s = ec.e2*hc->n0*hc->sphi0;
+    hc->G = ec.e*hc->sphi0/ec.sqe2m;
+    hc->G2 = hc->G*hc->G;
+    hc->Hc = ec.e*hc->cphi0/ec.sqe2m;
+    hc->Ac = ec.e2*hc->cphi0*hc->cphi0/ec.e2m;
+    hc->Bc = 3*ec.e2*hc->sphi0*hc->cphi0/ec.e2m;
+}
+
 /**\brief alg0079 Geographic to Hatt Projected coordinates.*/
 void GeoHatt(double lambda0, double phi0, double x0, double y0,
              double a, double e2, double lambda, double phi, double *x, double *y)
 {
-    if (cos(phi) < 1e-10)
+    ellipsoidContext ec;
+    hattContext hc;
+    InitEllipsoidContext(a, e2, &ec);
+    InitHattContext(ec, lambda0, phi0, x0, y0, &hc);
+    GeoHatt(hc, lambda, phi, x, y);
+}
+
+/**\brief alg0079 Geographic to Hatt Projected coordinates, the constants of the projection being
+taken from a hattContext. The sines and cosines of psi and of the azimuth are derived algebraically
+from their tangents. The results are within 1e-7 m of the former implementation, which lost accuracy
+near the meridian of the origin south of it (and returned the origin for the points of that meridian).*/
+void GeoHatt(const hattContext &hc, double lambda, double phi, double *x, double *y)
+{
+    double cp = cos(phi);
+    if (cp < 1e-10)
     {
         *x = 0.;
         *y = 0.;
         return;
     }
-    double psi = atan( (1-e2)*tan(phi) + e2*GrandeNormale(phi0,a,e2)*sin(phi0)
-                      / GrandeNormale(phi,a,e2)/cos(phi) );
-    double az = atan2( sin(lambda-lambda0),
-                       cos(phi0)*tan(psi)-sin(phi0)*cos(lambda-lambda0) );
-    double s;
-    if (sin(az) == 0)
+    double sp = sin(phi);
+    double tpsi = hc.e2m*sp/cp + hc.e2n0s / (hc.a/sqrt(1-hc.e2*sp*sp)) / cp;
+    double cpsi = 1/sqrt(1+tpsi*tpsi), spsi = tpsi*cpsi;
+    double sdl = sin(lambda-hc.lambda0), cdl = cos(lambda-hc.lambda0);
+    double ay = sdl, ax = hc.cphi0*tpsi-hc.sphi0*cdl, r = sqrt(ax*ax+ay*ay);
+    double saz = 0., caz = 1.;
+    if (r != 0)
     {
-        s = fabs(asin(cos(phi0)*sin(psi)-sin(phi0)*cos(psi)));
-        if (cos(az) < 0) s = -s;
+        saz = ay/r;
+        caz = ax/r;
     }
+    double s;
+    if (saz == 0)
+        //On the meridian of the origin, the direction is given by caz
+        s = fabs(asin(hc.cphi0*spsi-hc.sphi0*cpsi));
     else
-    {
-        s = asin(sin(lambda-lambda0)*cos(psi)/sin(az));
-    }
-    double e = sqrt(e2);
-    double G = e*sin(phi0)/sqrt(1-e2);
-    double H = e*cos(phi0)*cos(az)/sqrt(1-e2);
-    double c = GrandeNormale(phi0,a,e2) * s * ( 1
-               - pow(s,2)*pow(H,2)*(1-pow(H,2))/6.
-               + pow(s,3)*G*H*(1-2*pow(H,2))/8.
-               + pow(s,4)*( pow(H,2)*(4-7*pow(H,2))-3*pow(G,2)*(1-7*pow(H,2)) )/120.
-               - pow(s,5)/48. );
-    *x = c*sin(az)+x0;
-    *y = c*cos(az)+y0;
+        s = asin(sdl*cpsi/saz);
+    double H = hc.Hc*caz, H2 = H*H, s2 = s*s;
+    double c = hc.n0 * s * ( 1
+               - s2*H2*(1-H2)/6.
+               + s2*s*hc.G*H*(1-2*H2)/8.
+               + s2*s2*( H2*(4-7*H2)-3*hc.G2*(1-7*H2) )/120.
+               - s2*s2*s/48. );
+    *x = c*saz+hc.x0;
+    *y = c*caz+hc.y0;
 }
 
 /**\brief alg0080 Hatt Projected to Geographic coordinates.*/
 void HattGeo(double lambda0, double phi0, double x0, double y0,
              double a, double e2, double *lambda, double *phi, double x, double y)
 {
-    double C = sqrt(pow(x-x0,2)+pow(y-y0,2));
-    double az = atan2(x-x0, y-y0);
-    double A = -e2*pow(cos(phi0),2)*pow(cos(az),2) / (1-e2);
-    double B = 3*e2*(1-A)*sin(phi0)*cos(phi0)*cos(az) / (1-e2);
-    double D = C / GrandeNormale(phi0,a,e2);
-    double E = D - A*(1+A)*pow(D,3)/6. - B*(1+3*A)*pow(D,4)/24.;
-    double F = 1 - A*pow(E,2)/2. - B*pow(E,3)/6.;
-    double psi = asin(sin(phi0)*cos(E)+cos(phi0)*sin(E)*cos(az));
-    *lambda = lambda0 + asin(sin(az)*sin(E)/cos(psi));
-    *phi = atan( (1 - e2*F*sin(phi0)/sin(psi)) * tan(psi)/(1-e2) );
+    ellipsoidContext ec;
+    hattContext hc;
+    InitEllipsoidContext(a, e2, &ec);
+    InitHattContext(ec, lambda0, phi0, x0, y0, &hc);
+    HattGeo(hc, lambda, phi, x, y);
+}
+
+/**\brief alg0080 Hatt Projected to Geographic coordinates, the constants of the projection being
+taken from a hattContext (see GeoHatt).*/
+void HattGeo(const hattContext &hc, double *lambda, double *phi, double x, double y)
+{
+    double dx = x-hc.x0, dy = y-hc.y0;
+    double C = sqrt(dx*dx+dy*dy);
+    double saz = 0., caz = 1.;
+    if (C != 0)
+    {
+        saz = dx/C;
+        caz = dy/C;
+    }
+    double A = -hc.Ac*caz*caz;
+    double B = hc.Bc*(1-A)*caz;
+    double D = C / hc.n0, D2 = D*D;
+    double E = D - A*(1+A)*D2*D/6. - B*(1+3*A)*D2*D2/24.;
+    double E2 = E*E;
+    double F = 1 - A*E2/2. - B*E2*E/6.;
+    double sE = sin(E);
+    double spsi = hc.sphi0*cos(E)+hc.cphi0*sE*caz;
+    double cpsi = sqrt(1-spsi*spsi);
+    *lambda = hc.lambda0 + asin(saz*sE/cpsi);
+    *phi = atan( (1 - hc.e2*F*hc.sphi0/spsi) * spsi/cpsi/hc.e2m );
 }
@@ -45,6 +45,7 @@ Author:
 #include <cmath>
 #include <cassert>
 #include <complex>
+#include <string>
 
 //constants already defined in math.h l.372
 #define M_PI		3.14159265358979323846	// extrait de tc\include\math.h
@@ -58,30 +59,84 @@ Author:
 #define LAT_CROISSANTE(X)	LatIso(X, 0.)
 #define LATISO_INV(X)		LatIsoInv(X, e2)
 
+/**\brief Constants derived from an ellipsoid, computed once for the conversions between geographic and geocentric coordinates.*/
+struct ellipsoidContext
+{
+    double a;    // semi-major axis
+    double e2;   // squared eccentricity
+    double e2m;  // 1-e2
+    double e4;   // e2*e2
+    double b;    // semi-minor axis
+    double e;    // eccentricity
+    double sqe2m;// sqrt(1-e2)
+    double fst;  // ((1-e)/(1+e))^(e/2), polar stereographic factor
+    double clc[4];// coefficients of the latitude from the conformal latitude (see CoefLatConf)
+};
+
+/**\brief Constants of a Hatt projection, computed once from its ellipsoid and its origin.*/
+struct hattContext
+{
+    double lambda0, phi0, x0, y0;
+    double a, e2, e2m;
+    double sphi0, cphi0; // sin(phi0), cos(phi0)
+    double n0;           // GrandeNormale(phi0)
+    double e2n0s;        // e2*n0*sin(phi0)
+    double G, G2;        // e*sin(phi0)/sqrt(1-e2) and its square
+    double Hc;           // e*cos(phi0)/sqrt(1-e2)
+    double Ac;           // e2*cos(phi0)^2/(1-e2)
+    double Bc;           // 3*e2*sin(phi0)*cos(phi0)/(1-e2)
+};
+
 double LatIso(double phi, double e2);
+void CoefLatConf(double e2, double cs[4]);
+double LatIsoInv(double latiso, double e2);
+double LatIsoInv(const ellipsoidContext &ec, double latiso);
 void GeoLambert(double e2, double n, double c, double lambdac, double xs, double ys, double lambda, double phi, double *x, double *y);
 void LambertGeo(double e2, double n, double c, double lambdac, double xs, double ys, double *lambda, double *phi, double x, double y);
+void LambertGeo(const ellipsoidContext &ec, double n, double c, double lambdac, double xs, double ys, double *lambda, double *phi, double x, double y);
+void GeoLambertMany(double e2, double n, double c, double lambdac, double xs, double ys, unsigned int np, const double *lambda, const double *phi, double *x, double *y);
+void LambertGeoMany(double e2, double n, double c, double lambdac, double xs, double ys, unsigned int np, double *lambda, double *phi, const double *x, const double *y);
 void GeoCart(double a, double e2, double lambda, double phi, double h, double *x, double *y, double *z);
+void InitEllipsoidContext(double a, double e2, ellipsoidContext *ec);
+void GeoCart(const ellipsoidContext &ec, double lambda, double phi, double h, double *x, double *y, double *z);
+void GeoCartMany(const ellipsoidContext &ec, unsigned int np, const double *lambda, const double *phi, const double *h, double *x, double *y, double *z);
+void CartGeo(const ellipsoidContext &ec, double x, double y, double z, double *lambda, double *phi, double *h);
+void CartGeoMany(const ellipsoidContext &ec, unsigned int np, const double *x, const double *y, const double *z, double *lambda, double *phi, double *h);
+void HelmertCart(const double M[12], double x1, double y1, double z1, double *x2, double *y2, double *z2);
+void HelmertCompose(const double M2[12], const double M1[12], double M[12]);
 void RotAxe(char axe,double angle,double ux,double uy,double uz,double *vx,double *vy,double *vz);
 void SpherCart(double lambda, double phi, double *x, double *y, double *z);
 void CartSpher(double x, double y, double z, double *lambda, double *phi);
 void CoefProjLambTan(double a, double e2, double lambda0, double phi0, double k0, double x0, double y0, double *lambdac, double *n, double *c, double *xs, double *ys);
 double polynome(double x , int n , double c[]);
 double GrandeNormale(double phi, double a, double e2);
+double GrandeNormale(const ellipsoidContext &ec, double phi);
 double RMer(double a, double e2, double phi);
+double RMer(const ellipsoidContext &ec, double phi);
 double LMer(double a, double e2, double phi, double dphi);
+double LMer(const ellipsoidContext &ec, double phi, double dphi);
 double LPar(double a, double e2, double phi, double dlambda);
+double LPar(const ellipsoidContext &ec, double phi, double dlambda);
 void VertDeflection(double a, double e2, double phi, double dphi, double dlambda, double dNwe, double dNsn, double *xi, double *eta);
+void VertDeflection(const ellipsoidContext &ec, double phi, double dphi, double dlambda, double dNwe, double dNsn, double *xi, double *eta);
 double LParMerDist(double a, double e2, double phi, double dlambda, double dphi, double *lpar, double *lmer);
 void CoeffArcMer(double e2, double c[DEGRE+1]);
 double DevArcMer(double phi, double e2);
 void CoefProjMercTrDir(double e2, double c[DEGRE+1]);
+void CoefProjMercTrInv(double e2, double c[DEGRE+1]);
 void GeoMercTr(double lambda0, double n, double xs, double ys, double e2, double lambda, double phi, double *x, double *y);
+void GeoMercTr(double lambda0, double n, double xs, double ys, double e2, const double c[DEGRE+1], double lambda, double phi, double *x, double *y);
+void GeoMercTrMany(double lambda0, double n, double xs, double ys, double e2, const double c[DEGRE+1], unsigned int np, const double *lambda, const double *phi, double *x, double *y);
 void MercTrGeo(double lambda0, double n, double xs, double ys, double e2, double *lambda, double *phi, double x, double y);
+void MercTrGeo(double lambda0, double n, double xs, double ys, double e2, const double c[DEGRE+1], double *lambda, double *phi, double x, double y);
+void MercTrGeo(const ellipsoidContext &ec, double lambda0, double n, double xs, double ys, const double c[DEGRE+1], double *lambda, double *phi, double x, double y);
+void MercTrGeoMany(double lambda0, double n, double xs, double ys, double e2, const double c[DEGRE+1], unsigned int np, double *lambda, double *phi, const double *x, const double *y);
 void GeoGaussLab(double c, double n1, double n2, double xs, double ys, double e2, double lambdac, double lambda, double phi, double *x, double *y);
 void GaussLabGeo(double c, double n1, double n2, double xs, double ys, double e2, double lambdac, double *lambda, double *phi, double x, double y);
+void GaussLabGeo(const ellipsoidContext &ec, double c, double n1, double n2, double xs, double ys, double lambdac, double *lambda, double *phi, double x, double y);
 void ScaleConvGaussLab(double a, double e2, double lambda, double phi, double n1, double n2, double c, double lambdac, double *conv, double *scfact);
 void CoefProjSterObl(int choix, double a, double e2, double lambda0, double phi0, double k0, double x0, double y0, double *lambdac, double *phic, double *c, double *n1, double *n2, double *xs, double *ys);
+void CoefProjSterObl(int choix, const ellipsoidContext &ec, double lambda0, double phi0, double k0, double x0, double y0, double *lambdac, double *phic, double *c, double *n1, double *n2, double *xs, double *ys);
 void CoefProjGaussLab(int choix, double a, double e2, double lambda0, double phi0, double k0, double x0, double y0, double *lambdac, double *phic, double *c, double *n1, double *n2, double *xs, double *ys);
 void CoefProjMercTr(double a, double e2, double lambda0, double phi0, double k0, double x0, double y0, double *lambdac, double *n, double *xs,double *ys);
 void CoefProjLambSec(double a, double e2, double lambda0, double phi0, double phi1, double phi2, double x0, double y0, double *lambdac, double *n, double *c, double *xs, double *ys);
@@ -92,14 +147,20 @@ void ScaleConvLamb(double lambda, double phi, double a, double e2, double n, dou
 void ScaleConvMercTr(double a, double lambda, double phi, double n, double lambdac, double xs, double k0, double x, double *conv, double *scfact);
 void GeoSterPolSud(double c, double n1, double n2, double xs, double ys, double e2, double lambdac, double phic, double l, double p, double* x, double* y);
 void SterPolSudGeo(double n1, double n2, double xs, double ys, double e2, double c, double lambdac, double phic, double* l, double* p, double x, double y);
+void SterPolSudGeo(const ellipsoidContext &ec, double n1, double n2, double xs, double ys, double c, double lambdac, double phic, double* l, double* p, double x, double y);
 double q_(double e2, double phi);
 double m_(double e2, double phi);
 void CoefProjLAEA(double a, double e2, double phi0, double *qp, double *beta1, double *Rq, double *D);
 void GeoLAEA(double a, double e2, double lambda0, double phi0, double qp, double Rq, double beta1, double D, double x0, double y0, double lambda, double phi, double *x, double *y);
 void LAEAgeo(double a, double e2, double lambda0, double phi0, double qp, double Rq, double beta1, double D, double x0, double y0, double *lambda, double *phi, double x, double y);
 void testGeoSterPolSud();
+void testGeoCartMany(std::string filout);
 double ShifTnTilT(double a1, double a2, double a3, double lambda0, double phi0, double a, double e2, double lambda, double phi);
+double ShifTnTilT(double a1, double a2, double a3, double lambda0, double phi0, const ellipsoidContext &ec, double lambda, double phi);
 void GeoHatt(double lambda0, double phi0, double x0, double y0, double a, double e2, double lambda, double phi, double *x, double *y);
 void HattGeo(double lambda0, double phi0, double x0, double y0, double a, double e2, double *lambda, double *phi, double x, double y);
+void InitHattContext(const ellipsoidContext &ec, double lambda0, double phi0, double x0, double y0, hattContext *hc);
+void GeoHatt(const hattContext &hc, double lambda, double phi, double *x, double *y);
+void HattGeo(const hattContext &hc, double *lambda, double *phi, double x, double y);
 
 #endif // !defined CONVERSIONCORE_H
@@ -48,6 +48,8 @@ namespace circe
 */
 Ellipsoid::Ellipsoid()
 {
+    a = b = e2 = f = 0.;
+    InitEllipsoidContext(a, e2, &ec);
 }
 
 /**
@@ -59,6 +61,7 @@ Ellipsoid::Ellipsoid(const Ellipsoid &B) : CirceObject(B)
     b = B.b;
     e2 = B.e2;
     f = B.f;
+    ec = B.ec;
 }
 
 /**
@@ -68,6 +71,7 @@ void Ellipsoid::reset()
 {
     CirceObject::reset();
     a = b = e2 = f = 0.;
+    InitEllipsoidContext(a, e2, &ec);
 }
 
 } //namespace circe
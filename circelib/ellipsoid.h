@@ -43,6 +43,7 @@ Author:
 
 #include <cmath>
 #include "circeobject.h"
+#include "conversioncore.h"
 
 namespace circe
 {
@@ -54,22 +55,24 @@ class Ellipsoid: public CirceObject
 {
 private:
     double a, b, e2, f;
+    ellipsoidContext ec;
 public:
     Ellipsoid();
     Ellipsoid(const Ellipsoid &B) ; // copy constructor
     void reset();
-    void set_a(double _a) {a=_a;}
+    void set_a(double _a) {a=_a; InitEllipsoidContext(a,e2,&ec);}
     void set_b(double _b) {b=_b;}
     void set_f(double _f) {f=_f;}
-    void set_e2(double _e2) {e2=_e2;}
+    void set_e2(double _e2) {e2=_e2; InitEllipsoidContext(a,e2,&ec);}
     double get_a() const {return a;}
     double get_b() const {return b;}
     double get_e2() const {return e2;}
     double get_f() const {return f;}
+    const ellipsoidContext& getEllipsoidContext() const {return ec;}
 	/**\brief First parameter (a) given, calculates second parameter (e2) from b.*/
-	void b__e2(){ e2 = 1. - pow(b / a, 2); }
+	void b__e2(){ e2 = 1. - pow(b / a, 2); InitEllipsoidContext(a,e2,&ec); }
 	/**\brief First parameter (a) given, calculates second parameter (e2) from f.*/
-	void f__e2(){ e2 = 1. - pow(1. - f, 2); }
+	void f__e2(){ e2 = 1. - pow(1. - f, 2); InitEllipsoidContext(a,e2,&ec); }
 };
 
 } //namespace circe
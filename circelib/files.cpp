@@ -38,9 +38,16 @@ Author:
 * \brief Implementation of point data input and output.
 */
 
+#include <cmath> //isfinite
 #include <limits> //numeric_limits
+#include <cstring> //memchr
+#include <cstdint> //uint32_t
+#include <cctype> //isspace
+#include <charconv> //from_chars
+#include <algorithm> //min, reverse
 #include <iomanip> //setprecision, setw
 #include <sstream> //istringstream
+#include <chrono> //benchBasicWriter
 #include "files.h"
 #include "stringtools.h"
 //#include <QDebug>
@@ -48,6 +55,9 @@ Author:
 namespace circe
 {
 
+static void getOstreamFlags(basicWriter *bw, const std::ostream *fo);
+static void setOstreamFlags(const basicWriter &bw, std::ostream *fo);
+
 /**
 * \brief Initializes a std::ostream for further output.
 * \param fo: A pointer to a std::ostream.
@@ -62,16 +72,39 @@ void initBasicOstream(std::ostream *fo)
 * \brief Writes the content of a pt4d vector to a file.
 * \param[in] circopt: processing options in a circeOptions structure.
 * \param[in] vPt4d: A pointer to the vector of pt4d.
+* \param os: A pointer to the std::ostream to write to instead of the target file (if not NULL).
 */
-void writeVectorPt4d(const circeOptions &circopt, const std::vector<circe::pt4d> &vPt4d)
+void writeVectorPt4d(const circeOptions &circopt, const std::vector<circe::pt4d> &vPt4d, std::ostream *os)
 {
     std::ofstream ofs;
     std::ostringstream oss;
-    initBasicOstream(&oss);
-    displayVectorPt4d (&oss, vPt4d, circopt);
-    openOutputFile(&ofs, circopt, "", false);
-    ofs << oss.str();
-    closeOutputFile(&ofs,circopt);
+    std::ostream *fo = (os != NULL ? os : &ofs);
+    if (os == NULL)
+        openOutputFile(&ofs, circopt, "", false);
+    else
+        writeOutputHeader(os, circopt, "", false);
+    if (circopt.targetOptions.subformatId == FF_BINARY)
+    {
+        binaryWriter bw;
+        initBinaryWriter(&bw, circopt, false);
+        for (std::vector<circe::pt4d>::const_iterator itPt4d = vPt4d.begin(); itPt4d<vPt4d.end(); itPt4d++)
+        {
+            appendBinaryPoint(&bw, *itPt4d, 0);
+            if (bw.n == BinaryChunkMaxSize)
+                writeBinaryChunk(&bw, fo);
+        }
+        writeBinaryChunk(&bw, fo);
+    }
+    else
+    {
+        initBasicOstream(&oss);
+        displayVectorPt4d (&oss, vPt4d, circopt);
+        *fo << oss.str();
+    }
+    if (os == NULL)
+        closeOutputFile(&ofs,circopt);
+    else
+        writeOutputTail(os, circopt);
     return;
 }
 
@@ -84,13 +117,18 @@ void writeVectorPt4d(const circeOptions &circopt, const std::vector<circe::pt4d>
 void displayVectorPt4d(std::ostream *fo, const std::vector<circe::pt4d>& vPt4d, const circeOptions &circopt)
 {
 	std::vector<circe::pt4d>::const_iterator itPt4d;
-	unsigned int idt;
+    basicWriter bw;
+    initBasicWriter(&bw, circopt, circopt.targetOptions.formatId);
+    getOstreamFlags(&bw, fo);
 	for (itPt4d = vPt4d.begin(); itPt4d<vPt4d.end(); itPt4d++)
 	{
         //itPt4d->transfoIndex = 0; //don't write transformation precision information
-        writeBasicLine(fo, circopt, *itPt4d, &idt, circopt.targetOptions.formatId);
-		*fo << "\n";
+        bw.buf.clear();
+        writeBasicLine(&bw, *itPt4d);
+        bw.buf += '\n';
+        fo->write(bw.buf.data(), bw.buf.size());
 	}
+    setOstreamFlags(bw, fo);
 }
 
 /**
@@ -102,9 +140,25 @@ void displayVectorPt4d(std::ostream *fo, const std::vector<circe::pt4d>& vPt4d,
 void openOutputFile(std::ofstream *fo, const circeOptions &circopt, const std::string& str, int TransfoRequired)
 {
     if (!fo->is_open())
-        fo->open(circopt.targetOptions.pathname.data(),std::ofstream::out);
+    {
+        if (circopt.targetOptions.subformatId == FF_BINARY)
+            fo->open(circopt.targetOptions.pathname.data(),std::ofstream::out|std::ofstream::binary);
+        else
+            fo->open(circopt.targetOptions.pathname.data(),std::ofstream::out);
+    }
     if (!(fo->is_open()))
         throw(DataValidationText[DV_CANNOT_OPEN_OUTPUT])+": "+circopt.targetOptions.pathname;
+    writeOutputHeader(fo, circopt, str, TransfoRequired);
+}
+
+/**
+* \brief Writes a header in a std::ostream if needed.
+* \param[in] circopt: processing options in a circeOptions structure.
+* \param fo: A pointer to a std::ostream (a file or the standard output).
+*/
+void writeOutputHeader(std::ostream *fo, const circeOptions &circopt, const std::string& str, int TransfoRequired)
+{
+    binaryWriter bw;
     switch (circopt.targetOptions.subformatId)
     {
     case FF_BASIC:
@@ -119,6 +173,10 @@ void openOutputFile(std::ofstream *fo, const circeOptions &circopt, const std::s
         break;
     case FF_NMEA_POINT:
         break;
+    case FF_BINARY:
+        initBinaryWriter(&bw, circopt, TransfoRequired);
+        writeBinaryHeader(fo, circopt, bw);
+        break;
     default:
         break;
     }
@@ -135,6 +193,7 @@ void openOutputFile(std::ofstream *fo, const circeOptions &circopt, const std::s
 */
 void writeOutputLine(std::ostream *fo, const circeOptions& circopt, const pt4d &p, unsigned int *idt)
 {
+    binaryWriter bw;
     switch (circopt.targetOptions.subformatId)
     {
     case FF_BASIC:
@@ -150,6 +209,12 @@ void writeOutputLine(std::ostream *fo, const circeOptions& circopt, const pt4d &
     case FF_NMEA_POINT:
         //writeNMEAline(fo, p);
         break;
+    case FF_BINARY:
+        //a chunk of a single point
+        initBinaryWriter(&bw, circopt, p.transfoIndex);
+        appendBinaryPoint(&bw, p, 0);
+        writeBinaryChunk(&bw, fo);
+        break;
     default:
         break;
     }
@@ -162,6 +227,17 @@ void writeOutputLine(std::ostream *fo, const circeOptions& circopt, const pt4d &
 * \param[in] fo: A pointer to a std::ofstream.
 */
 void closeOutputFile(std::ofstream *fo, const circeOptions& circopt)
+{
+    writeOutputTail(fo, circopt);
+    fo->close();
+}
+
+/**
+* \brief Writes a tail in a std::ostream if needed.
+* \param[in] circopt: processing options in a circeOptions structure.
+* \param[in] fo: A pointer to a std::ostream (a file or the standard output).
+*/
+void writeOutputTail(std::ostream *fo, const circeOptions& circopt)
 {
     switch (circopt.targetOptions.subformatId)
     {
@@ -175,223 +251,307 @@ void closeOutputFile(std::ofstream *fo, const circeOptions& circopt)
         break;
     case FF_NMEA_POINT:
         break;
+    case FF_BINARY:
+        writeBinaryTail(fo);
+        break;
     default:
         break;
     }
-    fo->close();
 }
 
+static const size_t BasicReaderBlockSize = 1<<20;
+
 /**
-* \brief Reads a single point data in a std::ifstream.
+* \brief Initializes a basicReader: the parser of each column is decided here once for the job.
+* \param br: A pointer to the basicReader.
+* \param fi: A pointer to the input std::istream.
+* \param[in] circopt: processing options in a circeOptions structure.
 * \param[in] lnfrmt: data format.
-* \param fi: A pointer to a std::ifstream.
-* \param[out] p: A pointer to a pt4d instance.
-* \param[out] fo: A pointer to the int position in the data format where an error occured (if any).
-* \return A DATA_VALIDATION code to be converted to an error message (if any).
 */
-//not much format validation to save performance (but other domain validation in Operate)
-DATA_VALIDATION readBasicLine(std::ifstream *fi, const circeOptions &circopt,
-                              const std::string& lnfrmt,  pt4d *p, unsigned int *idt)
+void initBasicReader(basicReader *br, std::istream *fi, const circeOptions &circopt, const std::string& lnfrmt)
 {
-    std::string foo;
-    p->e=p->n=p->l=p->p=p->h=p->x=p->y=p->z=p->w=0.;
-    p->id = p->info = "";
-    char fp = fi->peek();
-    if (fp == '*' || fp == '\r' || fp == '\n')
-    {
-        fi->ignore(std::numeric_limits<std::streamsize>::max(), '\n');
-        return DV_COMMENT;
-    }
-
-	//std::string line;
-	//std::getline(*fi, line);
-	//std::istringstream iss(line);
-
-    if (fi->eof())
-        return DV_EOF;
-    for ((*idt)=0; (*idt)<lnfrmt.size(); (*idt)++)
+    basicColumn bc;
+    br->fi = fi;
+    br->lineBuffered = circopt.lineBuffered;
+    br->buf.resize(BasicReaderBlockSize);
+    br->ib = br->ie = 0;
+    br->sep = getSeparator(circopt.separator);
+    br->dvAngle = (br->sep == ' ' ? DV_BAD_COORD : DV_BAD_FORMAT);
+    br->vColumn.clear();
+    for (unsigned int idt=0; idt<lnfrmt.size(); idt++)
     {
-        try {
-        switch (lnfrmt[*idt])
+        bc.kind = 'D';
+        bc.value = NULL;
+        bc.context = "";
+        switch (lnfrmt[idt])
         {
         case 'I':
-            *fi >> p->id;
+            bc.kind = 'I';
             break;
         case 'X':
-            *fi >> p->x;
+            bc.value = &pt4d::x;
             break;
         case 'Y':
-            *fi >> p->y;
+            bc.value = &pt4d::y;
             break;
         case 'Z':
-            *fi >> p->z;
+            bc.value = &pt4d::z;
             break;
         case 'L':
-            if (circopt.sourceOptions.angularUnit == "DMS")
-            {
-                *fi >> foo;
-                p->l = readDMS(foo, "longitude DMS", true);
-            }
-            else if (circopt.sourceOptions.angularUnit == "DM")
-            {
-                *fi >> foo;
-                p->l = readDMS(foo, "longitude DM", true);
-            }
-            else
-                *fi >> p->l;
-            break;
         case 'P':
+            if (lnfrmt[idt] == 'L')
+                bc.value = &pt4d::l;
+            else
+                bc.value = &pt4d::p;
+            bc.context = (lnfrmt[idt] == 'L' ? "longitude " : "latitude ");
             if (circopt.sourceOptions.angularUnit == "DMS")
             {
-                *fi >> foo;
-                p->p = readDMS(foo, "latitude DMS", true);
+                bc.kind = 'S';
+                bc.context += "DMS";
             }
             else if (circopt.sourceOptions.angularUnit == "DM")
             {
-                *fi >> foo;
-                p->p = readDMS(foo, "latitude DM", true);
+                bc.kind = 'M';
+                bc.context += "DM";
             }
-            else
-                *fi >> p->p;
             break;
         case 'H':
-            *fi >> p->h;
+            bc.value = &pt4d::h;
             break;
         case 'E':
-            *fi >> p->e;
+            bc.value = &pt4d::e;
             break;
         case 'N':
-            *fi >> p->n;
+            bc.value = &pt4d::n;
             break;
         case 'V':
-            *fi >> p->w;
+            bc.value = &pt4d::w;
+            break;
+        case 'T':
+            bc.value = &pt4d::t;
             break;
         default:
-            *fi >> foo; //use any other character to skip a field
+            bc.kind = 0; //use any other character to skip a field
+            break;
+        }
+        br->vColumn.push_back(bc);
+    }
+}
+
+/**
+* \brief Tells whether all the lines of a basicReader have been read.
+* \param[in] br: A basicReader.
+* \return true at the end of the input.
+*/
+bool eofBasicReader(const basicReader &br)
+{
+    return br.ib == br.ie && !br.fi->good();
+}
+
+/**
+* \brief Gets the next line of a basicReader, reading a new block of the input when needed.
+* \param br: A pointer to the basicReader.
+* \param[out] b: A pointer to the beginning of the line in the reader buffer.
+* \param[out] e: A pointer to the end of the line (excluding '\n').
+* \return false at the end of the input.
+*/
+static bool nextBasicLine(basicReader *br, const char **b, const char **e)
+{
+    const char *nl;
+    size_t is = br->ib;
+    while ((nl = (const char*)memchr(br->buf.data()+is, '\n', br->ie-is)) == NULL)
+    {
+        if (!br->fi->good())
             break;
+        if (br->ib > 0)
+        {
+            memmove(br->buf.data(), br->buf.data()+br->ib, br->ie-br->ib);
+            br->ie -= br->ib;
+            br->ib = 0;
         }
-        } catch (std::string str) {
-            fi->clear();
-            fi->ignore(std::numeric_limits<std::streamsize>::max(), '\n');
-            return DV_BAD_COORD;
+        if (br->ie == br->buf.size())
+            br->buf.resize(2*br->buf.size());
+        is = br->ie;
+        if (br->lineBuffered)
+        {
+            // a single line, not to wait for a whole block of a stream
+            std::string line;
+            if (!std::getline(*br->fi, line))
+                break;
+            line += '\n';
+            while (br->buf.size()-br->ie < line.size())
+                br->buf.resize(2*br->buf.size());
+            memcpy(br->buf.data()+br->ie, line.data(), line.size());
+            br->ie += line.size();
+        }
+        else
+        {
+            br->fi->read(br->buf.data()+br->ie, br->buf.size()-br->ie);
+            br->ie += br->fi->gcount();
         }
-        if (fi->fail())
-		{
-			fi->clear();
-			fi->ignore(std::numeric_limits<std::streamsize>::max(), '\n');
-			return DV_BAD_FORMAT;
-		}
     }
-    //skip other fields if any
-    fi->ignore(std::numeric_limits<std::streamsize>::max(), '\n');
-//            char next;
-//            while(fi->get(next))
-//            {
-//                if (next == '\n')  // If the file has been opened in
-//                {
-//                    break;        // text mode then it will correctly decode the
-//                }                  // platform specific EOL marker into '\n'
-//            }
-    return DV_OK;
+    if (nl == NULL)
+    {
+        if (br->ib == br->ie)
+            return false;
+        nl = br->buf.data()+br->ie;
+    }
+    *b = br->buf.data()+br->ib;
+    *e = nl;
+    br->ib = std::min(size_t(nl-br->buf.data())+1, br->ie);
+    return true;
 }
 
 /**
-* \brief Reads a single point data in a std::ifstream.
-* \param[in] lnfrmt: data format.
-* \param fi: A pointer to a std::ifstream.
+* \brief Reads a decimal number with std::from_chars.
+* \param[in] b: A pointer to the beginning of the field.
+* \param[in] e: A pointer to the end of the field.
+* \param[in] whole: true if the whole field must be a number (white space separated fields, as with
+istream >>), false if leading white space and trailing characters are ignored (as with std::stod).
+* \param[out] v: A pointer to the number.
+* \return true if a finite number was read (from_chars also parses nan and inf, which istream >>
+rejects).
+*/
+static bool readNumber(const char *b, const char *e, bool whole, double *v)
+{
+    if (!whole)
+        while (b < e && isspace((unsigned char)*b))
+            b++;
+    if (b < e && *b == '+' && (b+1 == e || b[1] != '-'))
+        b++;
+    std::from_chars_result r = std::from_chars(b, e, *v);
+    return r.ec == std::errc() && (!whole || r.ptr == e) && std::isfinite(*v);
+}
+
+/**
+* \brief Reads a single point data with a basicReader.
+* \param br: A pointer to the basicReader.
 * \param[out] p: A pointer to a pt4d instance.
-* \param[out] fo: A pointer to the int position in the data format where an error occured (if any).
+* \param[out] idt: A pointer to the int position in the data format where an error occured (if any).
 * \return A DATA_VALIDATION code to be converted to an error message (if any).
 */
 //not much format validation to save performance (but other domain validation in Operate)
-DATA_VALIDATION readBasicLine2(std::ifstream *fi, const circeOptions &circopt,
-                              const std::string& lnfrmt,  pt4d *p, unsigned int *idt)
+DATA_VALIDATION readBasicLine(basicReader *br, pt4d *p, unsigned int *idt)
 {
-    std::string foo;
-    p->e=p->n=p->l=p->p=p->h=p->x=p->y=p->z=p->w=0.;
-    p->id = p->info = "";
-    char fp = fi->peek();
-    if (fp == '*' || fp == '\r' || fp == '\n')
-    {
-        fi->ignore(std::numeric_limits<std::streamsize>::max(), '\n');
-        return DV_COMMENT;
-    }
-
-    if (fi->eof())
+    const char *b, *e, *fb, *fe;
+    bool bEnd = false;
+    p->e=p->n=p->l=p->p=p->h=p->x=p->y=p->z=p->w=p->t=0.;
+    p->id.clear();
+    p->info.clear();
+    if (!nextBasicLine(br, &b, &e))
         return DV_EOF;
-
-    char sep = getSeparator(circopt.separator);
-    //qDebug("::%c::",sep);
-    std::string val;
-    std::string line;
-    std::getline(*fi, line);
-    std::istringstream iline(line);
-
-    try {
-        for ((*idt)=0; (*idt)<lnfrmt.size(); (*idt)++)
+    if (b == e || *b == '*' || *b == '\r')
+        return DV_COMMENT;
+    for ((*idt)=0; (*idt)<br->vColumn.size(); (*idt)++)
+    {
+        const basicColumn &bc = br->vColumn[*idt];
+        if (br->sep == ' ')
         {
-            std::getline(iline, val, sep);
-            //qDebug(":%s:",val.data());
-            if (val.length()==0 && sep==' ')
+            while (b < e && isspace((unsigned char)*b))
+                b++;
+            if (b == e)
+                return DV_BAD_FORMAT;
+            fb = b;
+            while (b < e && !isspace((unsigned char)*b))
+                b++;
+            fe = b;
+        }
+        else
+        {
+            if (bEnd)
+                return DV_BAD_FORMAT;
+            fb = b;
+            if ((fe = (const char*)memchr(b, br->sep, e-b)) == NULL)
             {
-                (*idt)--;
-                continue;
+                fe = e;
+                bEnd = true;
             }
-            //qDebug("%s",val.data());
-            switch (lnfrmt[*idt])
-            {
-            case 'I':
-                p->id = val;
-                break;
-            case 'X':
-                p->x = std::stod(val);
-                break;
-            case 'Y':
-                p->y = std::stod(val);
-                break;
-            case 'Z':
-                p->z = std::stod(val);
-                break;
-            case 'L':
-                if (circopt.sourceOptions.angularUnit == "DMS")
-                    p->l = readDMS(val, "longitude DMS", true);
-                else if (circopt.sourceOptions.angularUnit == "DM")
-                    p->l = readDMS(val, "longitude DM", true);
-                else
-                    p->l = std::stod(val);
-                break;
-            case 'P':
-                if (circopt.sourceOptions.angularUnit == "DMS")
-                    p->p = readDMS(val, "latitude DMS", true);
-                else if (circopt.sourceOptions.angularUnit == "DM")
-                    p->p = readDMS(val, "latitude DM", true);
-                else
-                    p->p = std::stod(val);
-                break;
-            case 'H':
-                p->h = std::stod(val);
-                break;
-            case 'E':
-                p->e = std::stod(val);
-                break;
-            case 'N':
-                p->n = std::stod(val);
-                break;
-            case 'V':
-                p->w = std::stod(val);
-                break;
-            default:
-                foo = val; //use any other character to skip a field
-                break;
+            else
+                b = fe+1;
+        }
+        switch (bc.kind)
+        {
+        case 'I':
+            p->id.assign(fb, fe-fb);
+            break;
+        case 'D':
+            if (!readNumber(fb, fe, br->sep == ' ', &(p->*bc.value)))
+                return DV_BAD_FORMAT;
+            break;
+        case 'S':
+        case 'M':
+            try {
+                p->*bc.value = readDMS(std::string(fb, fe-fb), bc.context, true);
+            } catch (...) {
+                return br->dvAngle;
             }
+            break;
+        default:
+            break;
         }
-
-    } catch (...) {
-        return DV_BAD_FORMAT;
     }
+    //other fields if any are skipped
     return DV_OK;
 }
 
+/**
+* \brief A case of testReadBasicLine: a line of a ILPH file, its separator and the expected result.
+*/
+struct readBasicLineCase
+{
+    const char *line, *separator;
+    DATA_VALIDATION dv;
+    double l, p, h;
+};
+
+static const readBasicLineCase readBasicLineCases[] = {
+    {"B1\t2.35\t48.85\t10", "\\t", DV_OK, 2.35, 48.85, 10.},
+    {"B1\t+2.35\t 48.85\t-1e2", "\\t", DV_OK, 2.35, 48.85, -100.},
+    {"B1\t2.35\t48.85\tnan", "\\t", DV_BAD_FORMAT, 0., 0., 0.},
+    {"B1\t2.35\t48.85\tNaN", "\\t", DV_BAD_FORMAT, 0., 0., 0.},
+    {"B1\tinf\t48.85\t10", "\\t", DV_BAD_FORMAT, 0., 0., 0.},
+    {"B1\t2.35\tinfinity\t10", "\\t", DV_BAD_FORMAT, 0., 0., 0.},
+    {"B1\t2.35\t-INF\t10", "\\t", DV_BAD_FORMAT, 0., 0., 0.},
+    {"B1\t2.35\t48.85\t1e400", "\\t", DV_BAD_FORMAT, 0., 0., 0.},
+    {"B1 2.35 48.85 10", " ", DV_OK, 2.35, 48.85, 10.},
+    {"B1 2.35 48.85 nan", " ", DV_BAD_FORMAT, 0., 0., 0.},
+    {"B1 inf 48.85 10", " ", DV_BAD_FORMAT, 0., 0., 0.},
+    {"B1 2.35 -infinity 10", " ", DV_BAD_FORMAT, 0., 0., 0.},
+    {"B1 2.35 48.85 10x", " ", DV_BAD_FORMAT, 0., 0., 0.}
+};
+
+/**
+* \brief Checks readBasicLine on readBasicLineCases: the validation code and the coordinates read.
+* \param[in] filout: The pathname of the file the results are written to.
+*/
+void testReadBasicLine(std::string filout)
+{
+    std::ofstream fo(filout.data());
+    fo << std::setprecision(10);
+    unsigned int nFail = 0;
+    for (unsigned int i=0; i<sizeof(readBasicLineCases)/sizeof(readBasicLineCases[0]); i++)
+    {
+        const readBasicLineCase& c = readBasicLineCases[i];
+        circeOptions circopt;
+        circopt.separator = c.separator;
+        std::istringstream fi(std::string(c.line)+"\n");
+        basicReader br;
+        pt4d p;
+        unsigned int idt = 0;
+        initBasicReader(&br, &fi, circopt, "ILPH");
+        DATA_VALIDATION dv = readBasicLine(&br, &p, &idt);
+        bool ok = dv == c.dv && (dv != DV_OK
+                  || (fabs(p.l-c.l) < 1e-12 && fabs(p.p-c.p) < 1e-12 && fabs(p.h-c.h) < 1e-12));
+        if (!ok) nFail++;
+        fo << (ok ? "OK   " : "FAIL ") << "[" << c.line << "] " << int(dv);
+        if (dv == DV_OK)
+            fo << " " << p.l << " " << p.p << " " << p.h;
+        fo << std::endl;
+    }
+    fo << nFail << " failure(s)" << std::endl;
+    fo.close();
+}
+
 /**
 * \brief Writes a header in a std::ofstream.
 * \param[in] circopt: processing options in a circeOptions structure.
@@ -437,6 +597,9 @@ void writeBasicHeader(std::ostream *fo, const circeOptions &circopt, const std::
         case 'V':
             *fo << "    H     ";
             break;
+        case 'T':
+            *fo << "  Epoch    ";
+            break;
         case 'C':
             *fo << " " << InterfaceElementText[IE_CONVERGENCE];
             break;
@@ -506,6 +669,9 @@ void writeBasicHeader2(std::ostream *fo, const circeOptions &circopt, const std:
         case 'V':
             *fo << "H; ";
             break;
+        case 'T':
+            *fo << "Epoch; ";
+            break;
         case 'C':
             *fo << " " << InterfaceElementText[IE_CONVERGENCE] << ";";
             break;
@@ -534,247 +700,927 @@ void writeBasicHeader2(std::ostream *fo, const circeOptions &circopt, const std:
 }
 
 /**
-* \brief Writes a single point data in a std::ostream.
+* \brief Initializes a basicWriter: the format of each column is decided here once for the job.
+* \param bw: A pointer to the basicWriter.
+* \param[in] circopt: processing options in a circeOptions structure.
 * \param[in] lnfrmt: data format.
-* \param fo: A pointer to a std::ostream.
-* \param[in] p: A pointer to a pt4d instance.
-* \param[out] idt: A pointer to the int position in the data format where an error occured (if any).
-* \throw a std:string containing the error message (if any).
 */
-//setw is not sticky.
-void writeBasicLine(std::ostream *fo, const circeOptions &circopt,
-                                const pt4d& p, unsigned int *idt, std::string lnfrmt)
+void initBasicWriter(basicWriter *bw, const circeOptions &circopt, const std::string& lnfrmt)
 {
-    //std::string lnfrmt = circopt.targetOptions.formatId;
-    bool js = ((circopt.outputFormat=="JSON") && (circopt.sourceOptions.pathname == ""));
-    for ((*idt)=0; (*idt)<lnfrmt.size(); (*idt)++)
+    basicOutputColumn bc;
+    bw->js = ((circopt.outputFormat=="JSON") && (circopt.sourceOptions.pathname == ""));
+    bw->verticalInfo = (circopt.targetOptions.verticalCRSid == "AUTHORITATIVE");
+    bw->plainDMS = circopt.plainDMS;
+    bw->buf.clear();
+    bw->left = false;
+    bw->floatfield = 'f';
+    bw->vColumn.clear();
+    for (unsigned int idt=0; idt<lnfrmt.size(); idt++)
     {
-        if (js)
-        {
-            if ((*idt)>0) *fo << ",\n";
-            *fo << "\"" << lnfrmt[*idt] << "\":\"";
-        }
-        switch (lnfrmt[*idt])
+        bc.id = lnfrmt[idt];
+        bc.kind = 'F';
+        bc.value = NULL;
+        bc.width = 0;
+        bc.widthM = false;
+        bc.precision = 'm';
+        bc.fixedPrecision = 0;
+        bc.angle = 0;
+        bc.type = "";
+        switch (lnfrmt[idt])
         {
         case 'I':
-			if (p.id != "")
-            {
-                if (!js) *fo << std::setw(15);
-                *fo << std::left;
-                *fo << p.id;
-                if (!js) *fo << " ";
-            }
+            bc.kind = 'I';
+            bc.width = 15;
             break;
         case 'X':
-            *fo << std::setprecision(p.frmt.n_m/*3*/);
-            if (!js) *fo << std::setw(p.frmt.n_m + 10/*13*/);
-            *fo << std::right;
-            *fo << p.x;
+            bc.value = &pt4d::x;
+            bc.width = 10;
+            bc.widthM = true;
             break;
         case 'Y':
-            *fo << std::setprecision(p.frmt.n_m/*3*/);
-            if (!js) *fo << std::setw(p.frmt.n_m + 10/*13*/);
-            *fo << std::right;
-            *fo << p.y;
+            bc.value = &pt4d::y;
+            bc.width = 10;
+            bc.widthM = true;
             break;
         case 'Z':
-            *fo << std::setprecision(p.frmt.n_m/*3*/);
-            if (!js) *fo << std::setw(p.frmt.n_m + 10/*13*/);
-            *fo << std::right;
-            *fo << p.z;
-            break;
-//        case 'L':
-//            *fo << std::setprecision(p.frmt.n_ang/*9*/) << std::setw(p.frmt.n_ang+6/*15*/) << std::right << p.l;
-//            break;
-//        case 'P':
-//            *fo << std::setprecision(p.frmt.n_ang/*9*/) << std::setw(p.frmt.n_ang + 6/*15*/) << std::right << p.p ;
-//            break;
+            bc.value = &pt4d::z;
+            bc.width = 10;
+            bc.widthM = true;
+            break;
         case 'L':
-            if (circopt.targetOptions.angularUnit == "DMS")
-            {
-                if (!js) *fo << std::setw(20);
-                *fo << std::right;
-                *fo << writeDMS(p.l, "lon", p.frmt.n_ang, circopt.plainDMS);
-            }
-            else if (circopt.targetOptions.angularUnit == "DM")
+        case 'P':
+            if (lnfrmt[idt] == 'L')
             {
-                if (!js) *fo << std::setw(20);
-                *fo << std::right;
-                *fo << writeDM(p.l, "lon", p.frmt.n_ang, circopt.plainDMS);
+                bc.value = &pt4d::l;
+                bc.type = "lon";
             }
             else
             {
-                if (!js) *fo << std::setw(/*p.frmt.n_ang+6*/16);
-                *fo << std::right;
-                *fo << std::setprecision(p.frmt.n_ang/*9*/) << p.l;
-            }
-            break;
-        case 'P':
-            if (circopt.targetOptions.angularUnit == "DMS")
-            {
-                if (!js) *fo << std::setw(19);
-                *fo << std::right;
-                *fo << writeDMS(p.p, "lat", p.frmt.n_ang, circopt.plainDMS);
+                bc.value = &pt4d::p;
+                bc.type = "lat";
             }
-            else if (circopt.targetOptions.angularUnit == "DM")
+            if (circopt.targetOptions.angularUnit == "DMS" || circopt.targetOptions.angularUnit == "DM")
             {
-                if (!js) *fo << std::setw(19);
-                *fo << std::right;
-                *fo << writeDM(p.p, "lat", p.frmt.n_ang, circopt.plainDMS);
+                bc.kind = 'A';
+                bc.angle = (circopt.targetOptions.angularUnit == "DMS" ? 'S' : 'M');
+                bc.width = (lnfrmt[idt] == 'L' ? 20 : 19);
             }
             else
             {
-                if (!js) *fo << std::setw(/*p.frmt.n_ang+6*/15);
-                *fo << std::right;
-                *fo << std::setprecision(p.frmt.n_ang/*9*/);
-                *fo << p.p ;
+                bc.precision = 'a';
+                bc.width = (lnfrmt[idt] == 'L' ? 16 : 15);
             }
             break;
         case 'H':
-            *fo << std::setprecision(p.frmt.n_m/*3*/);
-            if (!js) *fo << std::setw(p.frmt.n_m + 7/*10*/);
-            *fo << std::right;
-            *fo << p.h;
+            bc.value = &pt4d::h;
+            bc.width = 7;
+            bc.widthM = true;
             break;
         case 'E':
-            *fo << std::setprecision(p.frmt.n_m/*3*/);
-            if (!js) *fo << std::setw(13);
-            *fo << std::right;
-            *fo << p.e;
+            bc.value = &pt4d::e;
+            bc.width = 13;
             break;
         case 'N':
-            *fo << std::setprecision(p.frmt.n_m/*3*/);
-            if (!js) *fo << std::setw(13);
-            *fo << std::right;
-            *fo << p.n;
+            bc.value = &pt4d::n;
+            bc.width = 13;
             break;
         case 'V':
-            *fo << std::setprecision(p.frmt.n_m/*3*/);
-            if (!js) *fo << std::setw(10);
-            *fo << std::right;
-            if (p.info.find(std::string(OperationMessageText[OM_UNKNOWN_VALUE_FOUND])) !=std::string::npos)
-                *fo << "NaN";
-            else
-                *fo << p.w;
+            bc.kind = 'V';
+            bc.value = &pt4d::w;
+            bc.width = 10;
+            break;
+        case 'T':
+            bc.value = &pt4d::t;
+            bc.width = 11;
+            bc.precision = 0;
+            bc.fixedPrecision = 4;
             break;
         case 'C':
-            *fo << std::setprecision(6);
-            if (!js) *fo << std::setw(13);
-            *fo << std::right;
-            *fo << p.conv;
+            bc.value = &pt4d::conv;
+            bc.width = 13;
+            bc.precision = 0;
+            bc.fixedPrecision = 6;
             break;
         case 'S':
-            if (!js) *fo << std::setw(10);
-            *fo << std::right;
+            bc.width = 10;
+            bc.precision = 0;
             if (circopt.noPrintSppm)
-               *fo << std::setprecision(7) << 1+1e-6*p.scfact;
+            {
+                bc.kind = 'K';
+                bc.fixedPrecision = 7;
+            }
+            else
+            {
+                bc.value = &pt4d::scfact;
+                bc.fixedPrecision = 1;
+            }
+            break;
+        case 'D':
+            bc.kind = 'D';
+            bc.width = 6;
+            bc.precision = 0;
+            bc.fixedPrecision = 1;
+            break;
+        default:
+            bc.kind = 0;
+            break;
+        }
+        bw->vColumn.push_back(bc);
+    }
+}
+
+/**
+* \brief Pads the last field of a basicWriter buffer with spaces, as std::setw would.
+* \param bw: A pointer to the basicWriter.
+* \param[in] pos: The position of the field in the buffer.
+* \param[in] width: The width of the field.
+*/
+static void padField(basicWriter *bw, size_t pos, unsigned int width)
+{
+    size_t n = bw->buf.size()-pos;
+    if (n >= width)
+        return;
+    if (bw->left)
+        bw->buf.append(width-n, ' ');
+    else
+        bw->buf.insert(pos, width-n, ' ');
+}
+
+/**
+* \brief Writes a single point data at the end of the buffer of a basicWriter.
+* \param bw: A pointer to the basicWriter.
+* \param[in] p: A pt4d instance.
+*/
+void writeBasicLine(basicWriter *bw, const pt4d& p)
+{
+    char aff[DMS_BUFFER_SIZE];
+    size_t pos;
+    unsigned int precision, width;
+    std::string &buf = bw->buf;
+    for (unsigned int idt=0; idt<bw->vColumn.size(); idt++)
+    {
+        const basicOutputColumn &bc = bw->vColumn[idt];
+        if (bw->js)
+        {
+            if (idt>0) buf += ",\n";
+            buf += '"';
+            buf += bc.id;
+            buf += "\":\"";
+        }
+        if (bc.precision == 'm')
+            precision = p.frmt.n_m;
+        else if (bc.precision == 'a')
+            precision = p.frmt.n_ang;
+        else
+            precision = bc.fixedPrecision;
+        width = (bw->js ? 0 : bc.width + (bc.widthM ? p.frmt.n_m : 0));
+        pos = buf.size();
+        switch (bc.kind)
+        {
+        case 'I':
+            if (p.id != "")
+            {
+                bw->left = true;
+                buf += p.id;
+                padField(bw, pos, width);
+                if (!bw->js) buf += ' ';
+            }
+            break;
+        case 'F':
+            bw->left = false;
+            appendDouble(&buf, p.*bc.value, bw->floatfield, precision);
+            padField(bw, pos, width);
+            break;
+        case 'V':
+            bw->left = false;
+            if (p.info.find(std::string(OperationMessageText[OM_UNKNOWN_VALUE_FOUND])) !=std::string::npos)
+                buf += "NaN";
+            else
+                appendDouble(&buf, p.*bc.value, bw->floatfield, precision);
+            padField(bw, pos, width);
+            break;
+        case 'A':
+            bw->left = false;
+            if (bc.angle == 'S')
+                buf.append(aff, writeDMS(aff, p.*bc.value, bc.type, p.frmt.n_ang, bw->plainDMS));
             else
-                *fo << std::setprecision(1) << p.scfact;
+                buf.append(aff, writeDM(aff, p.*bc.value, bc.type, p.frmt.n_ang, bw->plainDMS));
+            padField(bw, pos, width);
+            break;
+        case 'K':
+            bw->left = false;
+            appendDouble(&buf, 1+1e-6*p.scfact, bw->floatfield, precision);
+            padField(bw, pos, width);
             break;
         case 'D':
             //if (TransfoRequired&T_VERTICAL_REQUIRED)
-                if (p.transfoIndex&T_VERTICAL_REQUIRED)
+            if (p.transfoIndex&T_VERTICAL_REQUIRED)
             {
-                if (!js) *fo << std::setw(6);
-                *fo << std::right;
+                bw->left = false;
+                //sticky, as std::scientific was
                 if (fabs(p.eta)<1e-2 || fabs(p.eta)<1e-2)
-                    *fo << std::scientific;
-                *fo << std::setprecision(1) << std::setw(6) << p.eta  << " ";
-                *fo << std::setprecision(1) << std::setw(6) << p.xi;
+                    bw->floatfield = 'e';
+                appendDouble(&buf, p.eta, bw->floatfield, precision);
+                padField(bw, pos, bc.width);
+                buf += ' ';
+                pos = buf.size();
+                appendDouble(&buf, p.xi, bw->floatfield, precision);
+                padField(bw, pos, bc.width);
             }
             break;
         default:
             break;
         }
-        if (js) *fo << "\"";
-        if (fo->fail())
-            throw(DataValidationText[DV_BAD_FORMAT]);
-        //*fo << " ";
+        if (bw->js) buf += '"';
     }
-    if (circopt.targetOptions.verticalCRSid == "AUTHORITATIVE"/* && p.info != ""*/)
+    if (bw->verticalInfo/* && p.info != ""*/)
     {
-        if (js)
-            *fo << ",\n\"vertical_info\":\"" << p.info << "\"";
+        if (bw->js)
+        {
+            buf += ",\n\"vertical_info\":\"";
+            buf += p.info;
+            buf += '"';
+        }
         else
-            *fo << "  " << std::setw(32) << std::left << " [ "+p.info+" ] ";
+        {
+            buf += "  ";
+            pos = buf.size();
+            bw->left = true;
+            buf += " [ ";
+            buf += p.info;
+            buf += " ] ";
+            padField(bw, pos, 32);
+        }
     }
     if (p.transfoIndex&T_GEODETIC_REQUIRED)
     {
-		//if (p.Gprec != 0)
-        if (js) *fo << ",\n\"geodetic_precision\":\"";
-        if (!js) *fo << std::setw(12);
-        *fo << precisionCode2Text(p.Gprec);
-        if (js) *fo << "\"";
+        //if (p.Gprec != 0)
+        if (bw->js) buf += ",\n\"geodetic_precision\":\"";
+        pos = buf.size();
+        buf += precisionCode2Text(p.Gprec);
+        if (bw->js)
+            buf += '"';
+        else
+            padField(bw, pos, 12);
     }
     if (p.transfoIndex&T_VERTICAL_REQUIRED)
     {
         //if (p.Vprec != 0)
-        if (js) *fo << ",\n\"vertical_precision\":\"";
-        if (!js) *fo << std::setw(12);
-        *fo << precisionCode2Text(p.Vprec);
-        if (js) *fo << "\"";
+        if (bw->js) buf += ",\n\"vertical_precision\":\"";
+        pos = buf.size();
+        buf += precisionCode2Text(p.Vprec);
+        if (bw->js)
+            buf += '"';
+        else
+            padField(bw, pos, 12);
     }
-	//    *fo << std::endl;
-    return;
 }
 
-
 /**
-* \brief Initializes pt4d member values from a tinyxml2 element.
-* \param[in] XMLelem: A tinyxml2::XMLElement* stemming from a KML file.
-* \param[out] p: A pointer to a pt4d instance.
-* \throw a std:string containing the error message (if any).
+* \brief Sets the sticky flags of a basicWriter from those of a std::ostream.
+* \param bw: A pointer to the basicWriter.
+* \param[in] fo: A pointer to the std::ostream.
 */
-void readKMLline(tinyxml2::XMLElement *XMLelem, pt4d *p)
+static void getOstreamFlags(basicWriter *bw, const std::ostream *fo)
 {
-    std::istringstream ss;
-    char coco[_MAX_PATH_], seps[]=",", *token;
-    tinyxml2::XMLElement *XMLelem2;
-    p->id = ReadString(XMLelem,"name");
-	p->info = "";
-    XMLelem2 = XMLelem->FirstChildElement("Point");
-    if (!XMLelem2)
-        throw DataValidationText[DV_TAG_NOT_FOUND];
-    XMLelem2 = XMLelem2->FirstChildElement("coordinates");
-    if (!XMLelem2)
-        throw DataValidationText[DV_TAG_NOT_FOUND];
-    //Points only
-    if (XMLelem2 && XMLelem2->GetText())
-    {
-        strcpy(coco,XMLelem2->GetText());
-        if ( (token = strtok(coco, seps)) != NULL)
-            sscanf(token,"%lf",&(p->l));
-        else
-            throw DataValidationText[DV_BAD_FORMAT];
-        if ( (token = strtok(NULL, seps)) != NULL)
-            sscanf(token,"%lf",&(p->p));
-        else
-            throw DataValidationText[DV_BAD_FORMAT];
-        if ( (token = strtok(NULL, seps)) != NULL)
-            sscanf(token,"%lf",&(p->h));
-        else
-            throw DataValidationText[DV_BAD_FORMAT];
-        /*
-        ss.str(XMLelem2->GetText());
-        if (!ss.eof()) getline(ss, circopt->targetGeodeticCRSid, ',');
-        */
-    }
-    return;
+    bw->left = ((fo->flags() & std::ios::adjustfield) == std::ios::left);
+    if ((fo->flags() & std::ios::floatfield) == std::ios::fixed)
+        bw->floatfield = 'f';
+    else if ((fo->flags() & std::ios::floatfield) == std::ios::scientific)
+        bw->floatfield = 'e';
+    else
+        bw->floatfield = 'g';
 }
 
 /**
-* \brief Writes a header if a KML file.
-* \param[in] circopt: processing options in a circeOptions structure.
-* \param fo: A pointer to a std::ofstream.
+* \brief Sets the sticky flags of a std::ostream from those of a basicWriter.
+* \param[in] bw: A basicWriter.
+* \param fo: A pointer to the std::ostream.
 */
-void writeKMLheader(std::ostream *fo, const circeOptions& circopt)
+static void setOstreamFlags(const basicWriter &bw, std::ostream *fo)
 {
-    *fo << "\
-<?xml version=\"1.0\" encoding=\"UTF-8\"?> \n\
-<kml> \n\
-<Document> \n\
-<name> from circe " << circopt.sourceOptions.pathname << "</name>  \n\
-<StyleMap id=\"circe_point\"> \n\
+    fo->setf(bw.left ? std::ios::left : std::ios::right, std::ios::adjustfield);
+    if (bw.floatfield == 'e')
+        fo->setf(std::ios::scientific, std::ios::floatfield);
+}
+
+/**
+* \brief Writes a single point data in a std::ostream.
+* \param[in] lnfrmt: data format.
+* \param fo: A pointer to a std::ostream.
+* \param[in] p: A pointer to a pt4d instance.
+* \param[out] idt: A pointer to the int position in the data format where an error occured (if any).
+* \throw a std:string containing the error message (if any).
+* \remark To write many points, a basicWriter initialized once is faster.
+*/
+void writeBasicLine(std::ostream *fo, const circeOptions &circopt,
+                                const pt4d& p, unsigned int *idt, std::string lnfrmt)
+{
+    basicWriter bw;
+    initBasicWriter(&bw, circopt, lnfrmt);
+    getOstreamFlags(&bw, fo);
+    writeBasicLine(&bw, p);
+    *idt = lnfrmt.size();
+    fo->write(bw.buf.data(), bw.buf.size());
+    setOstreamFlags(bw, fo);
+    if (fo->fail())
+        throw(DataValidationText[DV_BAD_FORMAT]);
+}
+
+/**\brief Number of points formatted by benchBasicWriter.*/
+static const unsigned int BenchBasicWriterPoints = 200000;
+
+/**
+* \brief Seconds elapsed since a time point.
+*/
+static double elapsedSeconds(const std::chrono::steady_clock::time_point &t0)
+{
+    return std::chrono::duration<double>(std::chrono::steady_clock::now()-t0).count();
+}
+
+/**
+* \brief Throughput benchmark of the basic file writer. The same BenchBasicWriterPoints pseudo-random
+points are written with a basicWriter initialized once (writeBasicLine) and through a std::ostream
+(the writeBasicLine overload used for single points), as geographic coordinates in decimal degrees and
+in DMS and as projected coordinates. Their coordinates are also formatted by appendDouble alone and by
+a std::ostringstream, for comparison.
+* \param[in] filout: The pathname of the file the throughputs (points per second) and the output
+sizes (bytes) are written to.
+*/
+void benchBasicWriter(std::string filout)
+{
+    const char *format[3][2] = {{"ILPH","DEGREES"},{"ILPH","DMS"},{"IENH","DEGREES"}};
+    std::vector<pt4d> vPt(BenchBasicWriterPoints);
+    std::ofstream fo(filout.data());
+    std::chrono::steady_clock::time_point t0;
+    circeOptions circopt;
+    basicWriter bw;
+    std::ostringstream oss;
+    std::string str;
+    unsigned int i, idt;
+    size_t n1, n2;
+    double d1, d2;
+    fo << std::fixed << std::setprecision(0);
+    srand(1);
+    for (i=0; i<BenchBasicWriterPoints; i++)
+    {
+        InitDefPoint(&(vPt[i]));
+        vPt[i].id = "P"+asString(i);
+        vPt[i].l = -5.+15.*rand()/RAND_MAX;
+        vPt[i].p = 41.+10.*rand()/RAND_MAX;
+        vPt[i].h = 3000.*rand()/RAND_MAX;
+        vPt[i].e = 1e5+1e6*rand()/RAND_MAX;
+        vPt[i].n = 6e6+1e6*rand()/RAND_MAX;
+        vPt[i].transfoIndex = T_GEODETIC_REQUIRED;
+    }
+    for (int k=0; k<3; k++)
+    {
+        initDefOptions(&circopt);
+        circopt.targetOptions.angularUnit = format[k][1];
+        for (i=0; i<BenchBasicWriterPoints; i++)
+            initFormats(0.001, format[k][1], &(vPt[i].frmt));
+        initBasicWriter(&bw, circopt, format[k][0]);
+        n1 = 0;
+        t0 = std::chrono::steady_clock::now();
+        for (i=0; i<BenchBasicWriterPoints; i++)
+        {
+            bw.buf.clear();
+            writeBasicLine(&bw, vPt[i]);
+            n1 += bw.buf.size();
+        }
+        d1 = elapsedSeconds(t0);
+        n2 = 0;
+        t0 = std::chrono::steady_clock::now();
+        for (i=0; i<BenchBasicWriterPoints; i++)
+        {
+            oss.str("");
+            initBasicOstream(&oss);
+            writeBasicLine(&oss, circopt, vPt[i], &idt, format[k][0]);
+            n2 += oss.tellp();
+        }
+        d2 = elapsedSeconds(t0);
+        fo << format[k][0] << " " << format[k][1] << ": basicWriter " << BenchBasicWriterPoints/d1 << " points/s "
+           << n1 << " bytes, std::ostream " << BenchBasicWriterPoints/d2 << " points/s " << n2 << " bytes" << std::endl;
+    }
+    n1 = 0;
+    t0 = std::chrono::steady_clock::now();
+    for (i=0; i<BenchBasicWriterPoints; i++)
+    {
+        str.clear();
+        appendDouble(&str, vPt[i].l, 'f', 9);
+        appendDouble(&str, vPt[i].p, 'f', 9);
+        appendDouble(&str, vPt[i].h, 'f', 3);
+        n1 += str.size();
+    }
+    d1 = elapsedSeconds(t0);
+    n2 = 0;
+    t0 = std::chrono::steady_clock::now();
+    for (i=0; i<BenchBasicWriterPoints; i++)
+    {
+        oss.str("");
+        oss << std::fixed << std::setprecision(9) << vPt[i].l << vPt[i].p << std::setprecision(3) << vPt[i].h;
+        n2 += oss.tellp();
+    }
+    d2 = elapsedSeconds(t0);
+    fo << "LPH values: appendDouble " << BenchBasicWriterPoints/d1 << " points/s " << n1 << " bytes, std::ostringstream "
+       << BenchBasicWriterPoints/d2 << " points/s " << n2 << " bytes" << std::endl;
+    fo.close();
+}
+
+static const char BinaryMagic[] = "CIRCEBIN";
+static const unsigned int BinaryMagicSize = 8;
+static const unsigned int BinaryVersion = 1;
+static const size_t BinaryReaderBlockSize = 1<<20;
+
+/**
+* \brief Appends a number to a buffer in little-endian byte order.
+* \param buf: A pointer to the buffer.
+* \param[in] v: A pointer to the number.
+* \param[in] size: The size of the number.
+*/
+static void appendLE(std::string *buf, const void *v, size_t size)
+{
+    char b[8];
+    unsigned char SwapTest[2] = {1,0};
+    memcpy(b, v, size);
+    if (*(short *)SwapTest != 1) //big endian
+        std::reverse(b, b+size);
+    buf->append(b, size);
+}
+
+/**
+* \brief Copies a number stored in little-endian byte order.
+* \param[out] v: A pointer to the number.
+* \param[in] b: A pointer to the stored number.
+* \param[in] size: The size of the number.
+*/
+static void copyLE(void *v, const char *b, size_t size)
+{
+    unsigned char SwapTest[2] = {1,0};
+    memcpy(v, b, size);
+    if (*(short *)SwapTest != 1) //big endian
+        std::reverse((char*)v, (char*)v+size);
+}
+
+/**
+* \brief Reads a little-endian uint32 from a std::istream.
+* \param fi: A pointer to the std::istream.
+* \param[out] v: A pointer to the number.
+* \return false if it could not be read.
+*/
+static bool readUint32(std::istream *fi, uint32_t *v)
+{
+    char b[4];
+    if (!fi->read(b, 4))
+        return false;
+    copyLE(v, b, 4);
+    return true;
+}
+
+/**
+* \brief Initializes a binaryColumn from its name.
+* \param bc: A pointer to the binaryColumn.
+* \param[in] name: The name of the column.
+* \return false if the name is unknown.
+*/
+static bool initBinaryColumn(binaryColumn *bc, const std::string& name)
+{
+    bc->name = name;
+    bc->kind = 'F';
+    bc->value = NULL;
+    if (name == "I")
+        bc->kind = 'I';
+    else if (name == "X")
+        bc->value = &pt4d::x;
+    else if (name == "Y")
+        bc->value = &pt4d::y;
+    else if (name == "Z")
+        bc->value = &pt4d::z;
+    else if (name == "L")
+        bc->value = &pt4d::l;
+    else if (name == "P")
+        bc->value = &pt4d::p;
+    else if (name == "H")
+        bc->value = &pt4d::h;
+    else if (name == "E")
+        bc->value = &pt4d::e;
+    else if (name == "N")
+        bc->value = &pt4d::n;
+    else if (name == "V")
+        bc->value = &pt4d::w;
+    else if (name == "T")
+        bc->value = &pt4d::t;
+    else if (name == "C")
+        bc->value = &pt4d::conv;
+    else if (name == "S")
+        bc->value = &pt4d::scfact;
+    else if (name == "ETA")
+        bc->value = &pt4d::eta;
+    else if (name == "XI")
+        bc->value = &pt4d::xi;
+    else if (name == "GPREC")
+        bc->kind = 'G';
+    else if (name == "VPREC")
+        bc->kind = 'V';
+    else if (name == "STATUS")
+        bc->kind = 'S';
+    else
+        return false;
+    return true;
+}
+
+/**
+* \brief Initializes a binaryReader and reads the header of the binary file, which must match the
+source options.
+* \param br: A pointer to the binaryReader.
+* \param fi: A pointer to the input std::istream (opened in binary mode).
+* \param[in] circopt: processing options in a circeOptions structure.
+* \throw a std:string containing the error message (if any).
+*/
+void initBinaryReader(binaryReader *br, std::istream *fi, const circeOptions &circopt)
+{
+    char magic[BinaryMagicSize];
+    uint32_t size;
+    size_t found;
+    binaryColumn bc;
+    std::string txt, line, key, value, crs, lu, au;
+    std::istringstream ss, ssc;
+    const geodeticOptions &go = circopt.sourceOptions;
+    br->fi = fi;
+    br->vColumn.clear();
+    br->n = br->i = 0;
+    br->end = false;
+    if (!fi->read(magic, BinaryMagicSize) || memcmp(magic, BinaryMagic, BinaryMagicSize) != 0
+     || !readUint32(fi, &size))
+        throw FileFormatText[FF_BINARY]+ErrorMessageText[EM_NOT_VALID]+"\n("+go.pathname+")";
+    txt.resize(size);
+    if (size > 0 && !fi->read(&txt[0], size))
+        throw FileFormatText[FF_BINARY]+ErrorMessageText[EM_NOT_VALID]+"\n("+go.pathname+")";
+    ss.str(txt);
+    while (getline(ss, line))
+    {
+        if ((found = line.find('=')) == std::string::npos)
+            continue;
+        key = line.substr(0, found);
+        value = line.substr(found+1);
+        if (key == "VERSION" && value != asString(BinaryVersion))
+            throw value+" "+ErrorMessageText[EM_BAD_VERSION_NUMBER]+"\n("+go.pathname+")";
+        else if (key == "CRS")
+            crs = value;
+        else if (key == "FORMAT")
+        {
+            ssc.clear();
+            ssc.str(value);
+            getline(ssc, key, '.');
+            getline(ssc, lu, '.');
+            getline(ssc, au, '.');
+        }
+        else if (key == "COLUMNS")
+        {
+            ssc.clear();
+            ssc.str(value);
+            while (getline(ssc, key, ';'))
+            {
+                if (!initBinaryColumn(&bc, key))
+                    throw "COLUMNS "+key+ErrorMessageText[EM_NOT_VALID]+"\n("+go.pathname+")";
+                // values not part of the source format are skipped
+                if (bc.kind == 'F' && (key.size() > 1 || go.formatId.find(key[0]) == std::string::npos))
+                    bc.value = NULL;
+                br->vColumn.push_back(bc);
+            }
+        }
+    }
+    if (crs != go.geodeticCRSid+"."+go.verticalCRSid)
+        throw "CRS "+crs+ErrorMessageText[EM_INCONSISTENT]+"\n("+go.pathname+")";
+    if ((lu != "" && go.linearUnit != "" && lu != go.linearUnit)
+     || (au != "" && go.angularUnit != "" && au != go.angularUnit))
+        throw "FORMAT "+lu+"."+au+ErrorMessageText[EM_INCONSISTENT]+"\n("+go.pathname+")";
+    for (unsigned int idt=0; idt<go.formatId.size(); idt++)
+    {
+        if (std::string("IXYZLPHENVT").find(go.formatId[idt]) == std::string::npos)
+            continue;
+        for (found=0; found<br->vColumn.size(); found++)
+            if (br->vColumn[found].name == std::string(1, go.formatId[idt]))
+                break;
+        if (found == br->vColumn.size())
+            throw "COLUMNS "+go.formatId.substr(idt,1)+ErrorMessageText[EM_NOT_FOUND]+"\n("+go.pathname+")";
+    }
+    br->vData.resize(br->vColumn.size());
+    br->vPos.assign(br->vColumn.size(), 0);
+}
+
+/**
+* \brief Tells whether all the points of a binaryReader have been read.
+* \param[in] br: A binaryReader.
+* \return true at the end of the input.
+*/
+bool eofBinaryReader(const binaryReader &br)
+{
+    return br.i == br.n && (br.end || !br.fi->good());
+}
+
+/**
+* \brief Reads the next chunk of a binaryReader.
+* \param br: A pointer to the binaryReader.
+* \return false at the end of the input.
+* \throw a std:string containing the error message (if any).
+*/
+static bool readBinaryChunk(binaryReader *br)
+{
+    uint32_t n, isize;
+    size_t size, pos, len;
+    br->i = br->n = 0;
+    if (br->end || !readUint32(br->fi, &n) || n == 0)
+    {
+        br->end = true;
+        return false;
+    }
+    if (n > BinaryChunkMaxSize)
+        throw FileFormatText[FF_BINARY]+ErrorMessageText[EM_NOT_VALID];
+    for (unsigned int ic=0; ic<br->vColumn.size(); ic++)
+    {
+        std::vector<char> &data = br->vData[ic];
+        if (br->vColumn[ic].kind == 'I')
+        {
+            // n NUL-terminated identifiers
+            if (!readUint32(br->fi, &isize) || isize < n)
+                throw FileFormatText[FF_BINARY]+ErrorMessageText[EM_NOT_VALID];
+            size = isize;
+        }
+        else if (br->vColumn[ic].kind == 'F')
+            size = size_t(8)*n;
+        else
+            size = size_t(4)*n;
+        // read by blocks, so that the memory used does not exceed the size of the input
+        data.clear();
+        for (pos=0; pos<size; pos+=len)
+        {
+            len = std::min(size-pos, BinaryReaderBlockSize);
+            data.resize(pos+len);
+            if (!br->fi->read(data.data()+pos, len))
+                throw FileFormatText[FF_BINARY]+ErrorMessageText[EM_NOT_VALID];
+        }
+        br->vPos[ic] = 0;
+    }
+    br->n = n;
+    return true;
+}
+
+/**
+* \brief Reads a single point data from a binaryReader, reading its next chunk when needed.
+* \param br: A pointer to the binaryReader.
+* \param[out] p: A pointer to a pt4d instance.
+* \param[out] status: A pointer to the status of the point (0 if not in the file).
+* \return a DATA_VALIDATION code (DV_EOF at the end of the input).
+* \throw a std:string containing the error message (if any).
+*/
+DATA_VALIDATION readBinaryPoint(binaryReader *br, pt4d *p, int *status)
+{
+    int32_t v;
+    size_t len;
+    p->e=p->n=p->l=p->p=p->h=p->x=p->y=p->z=p->w=p->t=0.;
+    p->id.clear();
+    p->info.clear();
+    *status = 0;
+    if (br->i == br->n && !readBinaryChunk(br))
+        return DV_EOF;
+    for (unsigned int ic=0; ic<br->vColumn.size(); ic++)
+    {
+        const binaryColumn &bc = br->vColumn[ic];
+        const std::vector<char> &data = br->vData[ic];
+        switch (bc.kind)
+        {
+        case 'I':
+            len = strnlen(data.data()+br->vPos[ic], data.size()-br->vPos[ic]);
+            p->id.assign(data.data()+br->vPos[ic], len);
+            br->vPos[ic] = std::min(br->vPos[ic]+len+1, data.size());
+            break;
+        case 'F':
+            if (bc.value != NULL)
+                copyLE(&(p->*bc.value), data.data()+8*br->i, 8);
+            break;
+        case 'S':
+            copyLE(&v, data.data()+4*br->i, 4);
+            *status = v;
+            break;
+        default:
+            break;
+        }
+    }
+    br->i++;
+    return DV_OK;
+}
+
+/**
+* \brief Initializes a binaryWriter: the columns are decided here once for the job.
+* \param bw: A pointer to the binaryWriter.
+* \param[in] circopt: processing options in a circeOptions structure.
+* \param[in] TransfoRequired: precision columns written if T_GEODETIC_REQUIRED or T_VERTICAL_REQUIRED.
+*/
+void initBinaryWriter(binaryWriter *bw, const circeOptions &circopt, int TransfoRequired)
+{
+    binaryColumn bc;
+    const std::string &frmt = circopt.targetOptions.formatId;
+    bw->vColumn.clear();
+    for (unsigned int idt=0; idt<frmt.size(); idt++)
+    {
+        if (frmt[idt] == 'D')
+        {
+            initBinaryColumn(&bc, "ETA");
+            bw->vColumn.push_back(bc);
+            initBinaryColumn(&bc, "XI");
+            bw->vColumn.push_back(bc);
+        }
+        else if (initBinaryColumn(&bc, std::string(1, frmt[idt])))
+            bw->vColumn.push_back(bc);
+    }
+    if (TransfoRequired&T_GEODETIC_REQUIRED)
+    {
+        initBinaryColumn(&bc, "GPREC");
+        bw->vColumn.push_back(bc);
+    }
+    if (TransfoRequired&T_VERTICAL_REQUIRED)
+    {
+        initBinaryColumn(&bc, "VPREC");
+        bw->vColumn.push_back(bc);
+    }
+    initBinaryColumn(&bc, "STATUS");
+    bw->vColumn.push_back(bc);
+    bw->vData.assign(bw->vColumn.size(), "");
+    bw->n = 0;
+}
+
+/**
+* \brief Writes the header of a binary file.
+* \param fo: A pointer to the std::ostream (opened in binary mode).
+* \param[in] circopt: processing options in a circeOptions structure.
+* \param[in] bw: The binaryWriter of the job.
+*/
+void writeBinaryHeader(std::ostream *fo, const circeOptions &circopt, const binaryWriter &bw)
+{
+    std::string txt, buf(BinaryMagic, BinaryMagicSize);
+    const geodeticOptions &go = circopt.targetOptions;
+    uint32_t size;
+    txt = "VERSION="+asString(BinaryVersion)+"\n";
+    txt += "CRS="+go.geodeticCRSid+"."+go.verticalCRSid+"\n";
+    txt += "EPOCH="+asString(go.epoch,4)+"\n";
+    txt += "FORMAT="+go.formatId+"."+go.linearUnit+"."+go.angularUnit+"\n";
+    txt += "COLUMNS=";
+    for (unsigned int ic=0; ic<bw.vColumn.size(); ic++)
+    {
+        if (ic > 0) txt += ';';
+        txt += bw.vColumn[ic].name;
+    }
+    txt += "\n";
+    size = txt.size();
+    appendLE(&buf, &size, 4);
+    buf += txt;
+    fo->write(buf.data(), buf.size());
+}
+
+/**
+* \brief Appends a single point data to the current chunk of a binaryWriter.
+* \param bw: A pointer to the binaryWriter.
+* \param[in] p: A pt4d instance.
+* \param[in] status: 0, an OPERATION_MESSAGE code or the opposite of a DATA_VALIDATION code. If not 0,
+NaN values are written.
+*/
+void appendBinaryPoint(binaryWriter *bw, const pt4d &p, int status)
+{
+    double d;
+    int32_t v;
+    for (unsigned int ic=0; ic<bw->vColumn.size(); ic++)
+    {
+        const binaryColumn &bc = bw->vColumn[ic];
+        std::string &data = bw->vData[ic];
+        switch (bc.kind)
+        {
+        case 'I':
+            data += p.id;
+            data += '\0';
+            break;
+        case 'F':
+            if (status != 0 || (bc.value == &pt4d::w
+             && p.info.find(std::string(OperationMessageText[OM_UNKNOWN_VALUE_FOUND])) != std::string::npos))
+                d = std::numeric_limits<double>::quiet_NaN();
+            else
+                d = p.*bc.value;
+            appendLE(&data, &d, 8);
+            break;
+        case 'G':
+        case 'V':
+            v = (status != 0 ? 0 : (bc.kind == 'G' ? p.Gprec : p.Vprec));
+            appendLE(&data, &v, 4);
+            break;
+        case 'S':
+            v = status;
+            appendLE(&data, &v, 4);
+            break;
+        default:
+            break;
+        }
+    }
+    bw->n++;
+}
+
+/**
+* \brief Writes the current chunk of a binaryWriter (if not empty) and empties it.
+* \param bw: A pointer to the binaryWriter.
+* \param fo: A pointer to the std::ostream.
+*/
+void writeBinaryChunk(binaryWriter *bw, std::ostream *fo)
+{
+    std::string buf;
+    uint32_t size;
+    if (bw->n == 0)
+        return;
+    size = bw->n;
+    appendLE(&buf, &size, 4);
+    fo->write(buf.data(), buf.size());
+    for (unsigned int ic=0; ic<bw->vColumn.size(); ic++)
+    {
+        if (bw->vColumn[ic].kind == 'I')
+        {
+            buf.clear();
+            size = bw->vData[ic].size();
+            appendLE(&buf, &size, 4);
+            fo->write(buf.data(), buf.size());
+        }
+        fo->write(bw->vData[ic].data(), bw->vData[ic].size());
+        bw->vData[ic].clear();
+    }
+    bw->n = 0;
+}
+
+/**
+* \brief Writes the end of a binary file (an empty chunk).
+* \param fo: A pointer to the std::ostream.
+*/
+void writeBinaryTail(std::ostream *fo)
+{
+    std::string buf;
+    uint32_t n = 0;
+    appendLE(&buf, &n, 4);
+    fo->write(buf.data(), buf.size());
+}
+
+
+/**
+* \brief Initializes pt4d member values from a tinyxml2 element.
+* \param[in] XMLelem: A tinyxml2::XMLElement* stemming from a KML file.
+* \param[out] p: A pointer to a pt4d instance.
+* \throw a std:string containing the error message (if any).
+*/
+void readKMLline(tinyxml2::XMLElement *XMLelem, pt4d *p)
+{
+    std::istringstream ss;
+    char coco[_MAX_PATH_], seps[]=",", *token;
+    tinyxml2::XMLElement *XMLelem2;
+    p->id = ReadString(XMLelem,"name");
+	p->info = "";
+    XMLelem2 = XMLelem->FirstChildElement("Point");
+    if (!XMLelem2)
+        throw DataValidationText[DV_TAG_NOT_FOUND];
+    XMLelem2 = XMLelem2->FirstChildElement("coordinates");
+    if (!XMLelem2)
+        throw DataValidationText[DV_TAG_NOT_FOUND];
+    //Points only
+    if (XMLelem2 && XMLelem2->GetText())
+    {
+        strcpy(coco,XMLelem2->GetText());
+        if ( (token = strtok(coco, seps)) != NULL)
+            sscanf(token,"%lf",&(p->l));
+        else
+            throw DataValidationText[DV_BAD_FORMAT];
+        if ( (token = strtok(NULL, seps)) != NULL)
+            sscanf(token,"%lf",&(p->p));
+        else
+            throw DataValidationText[DV_BAD_FORMAT];
+        if ( (token = strtok(NULL, seps)) != NULL)
+            sscanf(token,"%lf",&(p->h));
+        else
+            throw DataValidationText[DV_BAD_FORMAT];
+        /*
+        ss.str(XMLelem2->GetText());
+        if (!ss.eof()) getline(ss, circopt->targetGeodeticCRSid, ',');
+        */
+    }
+    return;
+}
+
+/**
+* \brief Writes a header if a KML file.
+* \param[in] circopt: processing options in a circeOptions structure.
+* \param fo: A pointer to a std::ofstream.
+*/
+void writeKMLheader(std::ostream *fo, const circeOptions& circopt)
+{
+    *fo << "\
+<?xml version=\"1.0\" encoding=\"UTF-8\"?> \n\
+<kml> \n\
+<Document> \n\
+<name> from circe " << circopt.sourceOptions.pathname << "</name>  \n\
+<StyleMap id=\"circe_point\"> \n\
 <Pair> \n\
     <key>normal</key> \n\
     <styleUrl>#circe_point_normal</styleUrl> \n\
@@ -892,6 +1738,600 @@ void writeGPXtail(std::ostream *fo)
 </gpx> \n";
 }
 
+static const size_t XMLReaderBlockSize = 1<<16;
+
+/**
+* \brief Initializes a xmlReader.
+* \param xr: A pointer to the xmlReader.
+* \param fi: A pointer to the std::istream to be read.
+*/
+void initXMLReader(xmlReader *xr, std::istream *fi)
+{
+    xr->fi = fi;
+    xr->buf.resize(XMLReaderBlockSize);
+    xr->ib = xr->ie = 0;
+}
+
+/**
+* \brief Reads a new block of a std::istream after the unread part of a buffer.
+* \param fi: A pointer to the std::istream.
+* \param buf: A pointer to the buffer.
+* \param ib, ie: Pointers to the beginning and the end of the unread part of buf.
+* \return false if nothing could be read.
+*/
+static bool fillReaderBuffer(std::istream *fi, std::vector<char> *buf, size_t *ib, size_t *ie)
+{
+    if (!fi->good())
+        return false;
+    if (*ib > 0)
+    {
+        memmove(buf->data(), buf->data()+*ib, *ie-*ib);
+        *ie -= *ib;
+        *ib = 0;
+    }
+    if (*ie == buf->size())
+        buf->resize(2*buf->size());
+    fi->read(buf->data()+*ie, buf->size()-*ie);
+    *ie += fi->gcount();
+    return fi->gcount() > 0;
+}
+
+/**
+* \brief Reads a new block of the input of a xmlReader after its unread part.
+* \param xr: A pointer to the xmlReader.
+* \return false if nothing could be read.
+*/
+static bool fillXMLReader(xmlReader *xr)
+{
+    return fillReaderBuffer(xr->fi, &(xr->buf), &(xr->ib), &(xr->ie));
+}
+
+/**
+* \brief Gets the next token of a xmlReader: a markup ("<...>": tag, comment, CDATA section, declaration or
+processing instruction) or a piece of text. A text longer than a block is split after a white space.
+* \param xr: A pointer to the xmlReader.
+* \param[out] token: The token, as it is in the input.
+* \return false at the end of the input.
+* \throw a std:string containing the error message (if any).
+*/
+bool nextXMLtoken(xmlReader *xr, std::string *token)
+{
+    const char *b;
+    size_t k, n;
+    if (xr->ib == xr->ie && !fillXMLReader(xr))
+        return false;
+    if (xr->buf[xr->ib] == '<')
+    {
+        // enough characters to recognize comments and CDATA sections
+        while (xr->ie-xr->ib < 9 && fillXMLReader(xr));
+        b = xr->buf.data()+xr->ib;
+        n = xr->ie-xr->ib;
+        std::string close = ">";
+        size_t open = 1;
+        if (n >= 4 && memcmp(b, "<!--", 4) == 0)
+        {
+            close = "-->";
+            open = 4;
+        }
+        else if (n >= 9 && memcmp(b, "<![CDATA[", 9) == 0)
+        {
+            close = "]]>";
+            open = 9;
+        }
+        else if (n >= 2 && b[1] == '?')
+        {
+            close = "?>";
+            open = 2;
+        }
+        char quote = 0;
+        int bracket = 0;
+        for (k=1; ; k++)
+        {
+            if (xr->ib+k == xr->ie && !fillXMLReader(xr))
+                throw std::string(":::")+DataValidationText[DV_BAD_FORMAT]+":::\n";
+            b = xr->buf.data()+xr->ib;
+            if (close != ">")
+            {
+                if (k+1 >= open+close.size() && b[k] == '>'
+                 && memcmp(b+k+1-close.size(), close.data(), close.size()) == 0)
+                    break;
+            }
+            else if (quote != 0)
+            {
+                if (b[k] == quote)
+                    quote = 0;
+            }
+            else if (b[k] == '"' || b[k] == '\'')
+                quote = b[k];
+            else if (b[k] == '[') // DOCTYPE internal subset
+                bracket++;
+            else if (b[k] == ']')
+                bracket--;
+            else if (b[k] == '>' && bracket <= 0)
+                break;
+        }
+        k++;
+    }
+    else
+    {
+        k = 0;
+        while (true)
+        {
+            b = xr->buf.data()+xr->ib;
+            n = xr->ie-xr->ib;
+            const char *lt = (const char*)memchr(b+k, '<', n-k);
+            if (lt != NULL)
+            {
+                k = lt-b;
+                break;
+            }
+            k = n;
+            if (n >= XMLReaderBlockSize)
+            {
+                // long text (KML coordinates) split after its last white space
+                while (k > 0 && !isspace((unsigned char)b[k-1]))
+                    k--;
+                if (k > 0)
+                    break;
+                k = n;
+            }
+            if (!fillXMLReader(xr))
+                break;
+        }
+    }
+    token->assign(xr->buf.data()+xr->ib, k);
+    xr->ib += k;
+    return true;
+}
+
+/**
+* \brief Gets the name of a XML tag, without its namespace prefix.
+* \param[in] token: A token read by nextXMLtoken.
+* \param[out] type: 's' start tag, 'e' end tag, 'a' empty-element tag, 0 other token.
+* \return The name of the tag.
+*/
+std::string XMLtagName(const std::string& token, char *type)
+{
+    size_t b = 1, e;
+    *type = 0;
+    if (token.size() < 3 || token[0] != '<' || token[1] == '!' || token[1] == '?')
+        return "";
+    if (token[1] == '/')
+    {
+        *type = 'e';
+        b = 2;
+    }
+    else if (token[token.size()-2] == '/')
+        *type = 'a';
+    else
+        *type = 's';
+    for (e=b; e<token.size() && !isspace((unsigned char)token[e]) && token[e] != '>' && token[e] != '/'; e++);
+    std::string name = token.substr(b, e-b);
+    if ((b = name.find(':')) != std::string::npos)
+        name = name.substr(b+1);
+    return name;
+}
+
+/**
+* \brief Finds the value of an attribute in a XML start tag.
+* \param[in] token: A tag read by nextXMLtoken.
+* \param[in] name: The name of the attribute.
+* \param[out] vb, ve: The beginning and the end of the value (without its quotes) in token.
+* \return true if the attribute was found.
+*/
+static bool findXMLattribute(const std::string& token, const std::string& name, size_t *vb, size_t *ve)
+{
+    size_t i = token.find_first_of(" \t\r\n"), ne, q, qe;
+    while (i != std::string::npos)
+    {
+        if ((i = token.find_first_not_of(" \t\r\n", i)) == std::string::npos
+         || (ne = token.find('=', i)) == std::string::npos
+         || (q = token.find_first_of("\"'", ne)) == std::string::npos
+         || (qe = token.find(token[q], q+1)) == std::string::npos)
+            return false;
+        while (ne > i && isspace((unsigned char)token[ne-1]))
+            ne--;
+        if (token.compare(i, ne-i, name) == 0)
+        {
+            *vb = q+1;
+            *ve = qe;
+            return true;
+        }
+        i = qe+1;
+    }
+    return false;
+}
+
+/**
+* \brief Replaces the entity references of XML text by their characters.
+* \param[in] str: The text as read by nextXMLtoken.
+* \return The decoded text.
+*/
+std::string decodeXMLtext(const std::string& str)
+{
+    static const char *ent[5][2] = {{"&lt;","<"}, {"&gt;",">"}, {"&quot;","\""}, {"&apos;","'"}, {"&amp;","&"}};
+    std::string out;
+    size_t i = 0, j;
+    while ((j = str.find('&', i)) != std::string::npos)
+    {
+        out.append(str, i, j-i);
+        int k;
+        for (k=0; k<5 && str.compare(j, strlen(ent[k][0]), ent[k][0]) != 0; k++);
+        if (k < 5)
+        {
+            out += ent[k][1];
+            i = j+strlen(ent[k][0]);
+        }
+        else
+        {
+            out += '&';
+            i = j+1;
+        }
+    }
+    out.append(str, i, std::string::npos);
+    return out;
+}
+
+/**
+* \brief Reads a tuple of the coordinates element of a KML file (longitude,latitude[,altitude]).
+* \param[in] b: A pointer to the beginning of the tuple.
+* \param[in] e: A pointer to the end of the tuple.
+* \param[out] p: A pointer to a pt4d instance.
+* \param[out] dim: The number of values of the tuple (2 or 3).
+* \return A DATA_VALIDATION code to be converted to an error message (if any).
+*/
+DATA_VALIDATION readKMLtuple(const char *b, const char *e, pt4d *p, int *dim)
+{
+    double pt4d::*value[3] = {&pt4d::l, &pt4d::p, &pt4d::h};
+    const char *c;
+    p->h = 0.;
+    for (*dim=0; *dim<3; (*dim)++)
+    {
+        if ((c = (const char*)memchr(b, ',', e-b)) == NULL)
+            c = e;
+        if (!readNumber(b, c, true, &(p->*value[*dim])))
+            return DV_BAD_FORMAT;
+        if (c == e)
+            break;
+        b = c+1;
+    }
+    if (*dim == 3 || *dim == 0)
+        return DV_BAD_FORMAT;
+    (*dim)++;
+    return DV_OK;
+}
+
+/**
+* \brief Writes the horizontal coordinates of a tuple of the coordinates element of a KML file (longitude,latitude).
+* \param[in] p: A pt4d instance.
+* \return The coordinates.
+*/
+std::string writeKMLtuple(const pt4d& p)
+{
+    return asString(p.l,13) + "," + asString(p.p,13);
+}
+
+/**
+* \brief Reads a point element (wpt, trkpt or rtept) of a GPX file.
+* \param[in] vToken: The tokens of the element, from its start tag to its end tag.
+* \param[out] p: A pointer to a pt4d instance.
+* \return A DATA_VALIDATION code to be converted to an error message (if any).
+*/
+DATA_VALIDATION readGPXpoint(const std::vector<std::string>& vToken, pt4d *p)
+{
+    size_t i, vb, ve;
+    char type;
+    std::string name;
+    p->id = "";
+    p->info = "";
+    p->h = 0.;
+    if (!findXMLattribute(vToken[0], "lon", &vb, &ve)
+     || !readNumber(vToken[0].data()+vb, vToken[0].data()+ve, false, &(p->l))
+     || !findXMLattribute(vToken[0], "lat", &vb, &ve)
+     || !readNumber(vToken[0].data()+vb, vToken[0].data()+ve, false, &(p->p)))
+        return DV_BAD_FORMAT;
+    for (i=1; i+1<vToken.size(); i++)
+    {
+        name = XMLtagName(vToken[i], &type);
+        if (type != 's' || vToken[i+1][0] == '<')
+            continue;
+        if (name == "ele")
+        {
+            if (!readNumber(vToken[i+1].data(), vToken[i+1].data()+vToken[i+1].size(), false, &(p->h)))
+                return DV_BAD_FORMAT;
+        }
+        else if (name == "name")
+            p->id = decodeXMLtext(vToken[i+1]);
+    }
+    return DV_OK;
+}
+
+/**
+* \brief Writes the horizontal coordinates of a point in the start tag of a point element of a GPX file
+(lat and lon attributes), the other tokens of the element being left unchanged.
+* \param vToken: A pointer to the tokens of the element.
+* \param[in] p: A pt4d instance.
+*/
+void writeGPXpoint(std::vector<std::string> *vToken, const pt4d& p)
+{
+    size_t vb, ve;
+    if (findXMLattribute((*vToken)[0], "lat", &vb, &ve))
+        (*vToken)[0].replace(vb, ve-vb, asString(p.p,13));
+    if (findXMLattribute((*vToken)[0], "lon", &vb, &ve))
+        (*vToken)[0].replace(vb, ve-vb, asString(p.l,13));
+}
+
+static const size_t JSONReaderBlockSize = 1<<16;
+
+/**
+* \brief Initializes a jsonReader.
+* \param jr: A pointer to the jsonReader.
+* \param fi: A pointer to the std::istream to be read.
+*/
+void initJSONReader(jsonReader *jr, std::istream *fi)
+{
+    jr->fi = fi;
+    jr->buf.resize(JSONReaderBlockSize);
+    jr->ib = jr->ie = 0;
+}
+
+/**
+* \brief Gets the size of the JSON token at the beginning of a string: a punctuation ({}[]:,), a string,
+a number or a literal, or white space (including the record separator of GeoJSON text sequences).
+* \param[in] b: A pointer to the beginning of the string.
+* \param[in] e: A pointer to the end of the string.
+* \param[in] end: true if nothing follows e.
+* \return The size of the token, 0 if it is not complete.
+*/
+size_t scanJSONtoken(const char *b, const char *e, bool end)
+{
+    const char *c = b;
+    if (b == e)
+        return 0;
+    if (strchr("{}[]:,", *b) != NULL)
+        return 1;
+    if (isspace((unsigned char)*b) || *b == '\x1e')
+    {
+        while (c < e && (isspace((unsigned char)*c) || *c == '\x1e'))
+            c++;
+        return c-b;
+    }
+    if (*b == '"')
+    {
+        for (c=b+1; c<e && *c != '"'; c++)
+            if (*c == '\\')
+                c++;
+        return c < e ? c+1-b : 0;
+    }
+    while (c < e && !isspace((unsigned char)*c) && strchr("{}[]:,\"\x1e", *c) == NULL)
+        c++;
+    return (c < e || end) ? c-b : 0;
+}
+
+/**
+* \brief Gets the next token of a jsonReader (see scanJSONtoken).
+* \param jr: A pointer to the jsonReader.
+* \param[out] token: The token, as it is in the input.
+* \return false at the end of the input.
+* \throw a std:string containing the error message (if any).
+*/
+bool nextJSONtoken(jsonReader *jr, std::string *token)
+{
+    size_t n;
+    while ((n = scanJSONtoken(jr->buf.data()+jr->ib, jr->buf.data()+jr->ie, false)) == 0)
+    {
+        if (!fillReaderBuffer(jr->fi, &(jr->buf), &(jr->ib), &(jr->ie)))
+        {
+            if (jr->ib == jr->ie)
+                return false;
+            if ((n = scanJSONtoken(jr->buf.data()+jr->ib, jr->buf.data()+jr->ie, true)) == 0)
+                throw std::string(":::")+DataValidationText[DV_BAD_FORMAT]+":::\n";
+            break;
+        }
+    }
+    token->assign(jr->buf.data()+jr->ib, n);
+    jr->ib += n;
+    return true;
+}
+
+/**
+* \brief Chooses the pt4d member of each value of a GeoJSON position according to a CRS type.
+* \param[in] CRStype: The CRS type.
+* \param[in] vertical: true if the third value is a vertical height (if a vertical CRS is defined).
+* \param[out] value: The pt4d members.
+*/
+static void initGeoJSONvalues(CRS_TYPE CRStype, bool vertical, double pt4d::*value[3])
+{
+    switch (CRStype)
+    {
+    case CT_GEOCENTRIC:
+        value[0] = &pt4d::x;
+        value[1] = &pt4d::y;
+        value[2] = &pt4d::z;
+        return;
+    case CT_PROJECTED:
+        value[0] = &pt4d::e;
+        value[1] = &pt4d::n;
+        break;
+    default:
+        value[0] = &pt4d::l;
+        value[1] = &pt4d::p;
+        break;
+    }
+    value[2] = (vertical ? &pt4d::w : &pt4d::h);
+}
+
+/**
+* \brief Initializes a geojsonScanner.
+* \param gs: A pointer to the geojsonScanner.
+* \param[in] sourceCRStype, targetCRStype: The source and target CRS types.
+* \param[in] sourceVertical, targetVertical: true if a source (target) vertical CRS is defined.
+* \param[in] frmt: The display format, giving the precision of the values written.
+* \param[in] compact: true if white space is not to be written (GeoJSON text sequence output).
+*/
+void initGeoJSONscanner(geojsonScanner *gs, CRS_TYPE sourceCRStype, bool sourceVertical,
+                        CRS_TYPE targetCRStype, bool targetVertical, const displayFormat &frmt, bool compact)
+{
+    initGeoJSONvalues(sourceCRStype, sourceVertical, gs->sourceValue);
+    initGeoJSONvalues(targetCRStype, targetVertical, gs->targetValue);
+    for (int i=0; i<3; i++)
+        gs->precision[i] = (i<2 && targetCRStype == CT_GEOGRAPHIC ? frmt.n_ang : frmt.n_m);
+    gs->compact = compact;
+    resetGeoJSONscanner(gs);
+}
+
+/**
+* \brief Resets a geojsonScanner before a new GeoJSON text.
+* \param gs: A pointer to the geojsonScanner.
+*/
+void resetGeoJSONscanner(geojsonScanner *gs)
+{
+    gs->vType.clear();
+    gs->key.clear();
+    gs->vToken.clear();
+    gs->coordinates = gs->properties = gs->features = -1;
+    gs->expectKey = false;
+}
+
+/**
+* \brief Adds a token to a GeoJSON text being transformed. A position (innermost array of the coordinates
+member of a geometry, out of properties) is kept until it is complete.
+* \param gs: A pointer to the geojsonScanner.
+* \param[in] token: A token read by nextJSONtoken.
+* \param out: A pointer to the output text, to which the other tokens are appended.
+* \return true if a position is complete, to be written by writeGeoJSONposition.
+*/
+bool addGeoJSONtoken(geojsonScanner *gs, const std::string& token, std::string *out)
+{
+    char c = token[0];
+    if (gs->compact && (isspace((unsigned char)c) || c == '\x1e'))
+        return false;
+    if (gs->vToken.size() > 0)
+    {
+        if (c != '[')
+        {
+            gs->vToken.push_back(token);
+            if (c != ']')
+                return false;
+            gs->vType.pop_back();
+            if (gs->coordinates > (int)gs->vType.size())
+                gs->coordinates = -1;
+            return true;
+        }
+        // not a position
+        for (size_t i=0; i<gs->vToken.size(); i++)
+            out->append(gs->vToken[i]);
+        gs->vToken.clear();
+    }
+    switch (c)
+    {
+    case '{':
+    case '[':
+        gs->vType.push_back(c);
+        if (c == '[' && gs->vType.size() == 2 && gs->key == "features")
+            gs->features = 2;
+        else if (gs->properties < 0 && gs->key == "properties")
+            gs->properties = gs->vType.size();
+        else if (gs->properties < 0 && gs->coordinates < 0 && gs->key == "coordinates")
+            gs->coordinates = gs->vType.size();
+        gs->key.clear();
+        gs->expectKey = (c == '{');
+        if (c == '[' && gs->coordinates >= 0 && gs->properties < 0)
+        {
+            gs->vToken.push_back(token);
+            return false;
+        }
+        break;
+    case '}':
+    case ']':
+        if (gs->vType.size() > 0)
+            gs->vType.pop_back();
+        if (gs->coordinates > (int)gs->vType.size())
+            gs->coordinates = -1;
+        if (gs->properties > (int)gs->vType.size())
+            gs->properties = -1;
+        if (gs->features > (int)gs->vType.size())
+            gs->features = -1;
+        gs->expectKey = false;
+        break;
+    case ',':
+        gs->key.clear();
+        gs->expectKey = (gs->vType.size() > 0 && gs->vType.back() == '{');
+        break;
+    case ':':
+        gs->expectKey = false;
+        break;
+    case '"':
+        if (gs->expectKey)
+            gs->key = token.substr(1, token.size()-2);
+        break;
+    default:
+        break;
+    }
+    out->append(token);
+    return false;
+}
+
+/**
+* \brief Reads the complete position of a geojsonScanner (see addGeoJSONtoken).
+* \param[in] gs: The geojsonScanner.
+* \param[out] p: A pointer to a pt4d instance.
+* \return A DATA_VALIDATION code to be converted to an error message (if any).
+*/
+DATA_VALIDATION readGeoJSONposition(const geojsonScanner &gs, pt4d *p)
+{
+    int dim = 0;
+    p->e=p->n=p->l=p->p=p->h=p->x=p->y=p->z=p->w=p->t=0.;
+    for (size_t i=0; i<gs.vToken.size(); i++)
+    {
+        const std::string &t = gs.vToken[i];
+        if (strchr("[],", t[0]) != NULL || isspace((unsigned char)t[0]))
+            continue;
+        // further values (measures) left unchanged
+        if (dim < 3 && !readNumber(t.data(), t.data()+t.size(), true, &(p->*gs.sourceValue[dim])))
+            return DV_BAD_FORMAT;
+        dim++;
+    }
+    if (dim < 2)
+        return DV_BAD_FORMAT;
+    return DV_OK;
+}
+
+/**
+* \brief Writes the complete position of a geojsonScanner (see addGeoJSONtoken), only its values being changed.
+* \param gs: A pointer to the geojsonScanner (its position is cleared).
+* \param[in] p: A pointer to the operated pt4d instance, NULL to write the position unchanged.
+* \param out: A pointer to the output text.
+*/
+void writeGeoJSONposition(geojsonScanner *gs, const pt4d *p, std::string *out)
+{
+    int dim = 0;
+    size_t n;
+    for (size_t i=0; i<gs->vToken.size(); i++)
+    {
+        const std::string &t = gs->vToken[i];
+        if (p == NULL || dim >= 3 || strchr("[],", t[0]) != NULL || isspace((unsigned char)t[0]))
+        {
+            out->append(t);
+            continue;
+        }
+        // fixed notation without trailing zeros, a valid JSON number
+        n = out->size();
+        appendDouble(out, p->*gs->targetValue[dim], 'f', gs->precision[dim]);
+        if (out->find('.', n) != std::string::npos)
+        {
+            while (out->back() == '0')
+                out->pop_back();
+            if (out->back() == '.')
+                out->pop_back();
+        }
+        if (out->compare(n, std::string::npos, "-0") == 0)
+            out->erase(n, 1);
+        dim++;
+    }
+    gs->vToken.clear();
+}
+
 /**
 * \brief Reads a single point data in a NMEA file.
 * \param fi: A pointer to a std::ifstream.
@@ -54,30 +54,209 @@ Author:
 
 namespace circe
 {
+/**
+* \brief Parser of a column of a basic file, decided once per job from the data format and the angular unit.
+*/
+struct basicColumn
+{
+    char kind;              // 'I' identifier, 'D' decimal number, 'S' DMS, 'M' DM, 0 skipped field
+    double pt4d::*value;    // pt4d member receiving the number
+    std::string context;    // readDMS context
+};
+
+/**
+* \brief Block reader of basic files: the input is read by blocks and the fields of each line are
+split in place and parsed with std::from_chars according to a column table built once per job.
+*/
+struct basicReader
+{
+    std::istream *fi;
+    std::vector<char> buf;
+    size_t ib, ie;              // unread part of buf
+    char sep;                   // field separator, ' ' for any white space
+    bool lineBuffered;          // read line by line instead of by blocks
+    DATA_VALIDATION dvAngle;    // code returned when an angle cannot be read
+    std::vector<basicColumn> vColumn;
+};
+
+/**
+* \brief Column of the output of a basic file, decided once per job from the data format and the options.
+*/
+struct basicOutputColumn
+{
+    char id;                // format character
+    char kind;              // 'I' identifier, 'F' number, 'V' vertical value, 'A' sexagesimal angle,
+                            // 'K' scale factor (noPrintSppm), 'D' vertical deflection, 0 nothing written
+    double pt4d::*value;    // pt4d member written ('F', 'V', 'A')
+    unsigned int width;     // field width, to which n_m is added if widthM
+    bool widthM;
+    char precision;         // 'm' n_m, 'a' n_ang, 0 fixedPrecision
+    unsigned int fixedPrecision;
+    char angle;             // 'S' DMS, 'M' DM ('A')
+    std::string type;       // writeDMS type ('A')
+};
+
+/**
+* \brief Writer of basic files: each line is formatted with std::to_chars into a character buffer,
+reused from line to line (one writer per thread), according to a column table built once per job.
+The sticky flags of the std::ostream formerly used (std::left, std::scientific) are emulated so that
+the output is unchanged.
+*/
+struct basicWriter
+{
+    std::vector<basicOutputColumn> vColumn;
+    bool js;                // JSON output
+    bool verticalInfo;      // vertical CRS info written (AUTHORITATIVE)
+    bool plainDMS;
+    std::string buf;        // output buffer
+    bool left;              // std::left set
+    char floatfield;        // 'f' std::fixed, 'e' std::scientific, 'g' neither
+};
+
+/**
+* \brief Column of a binary file.
+*/
+struct binaryColumn
+{
+    std::string name;       // format character ("I", "X" ...), "ETA", "XI", "GPREC", "VPREC" or "STATUS"
+    char kind;              // 'I' identifier, 'F' float64, 'G' geodetic precision, 'V' vertical precision,
+                            // 'S' status (int32)
+    double pt4d::*value;    // pt4d member ('F')
+};
+
+/**
+* \brief Maximum number of points of a chunk of a binary file.
+*/
+static const unsigned int BinaryChunkMaxSize = 1<<16;
+
+/**
+* \brief Reader of binary files. A binary file begins with "CIRCEBIN", the size (uint32) of a text of
+"KEY=value" lines (VERSION, CRS, EPOCH, FORMAT, COLUMNS) and this text. Chunks of points follow, each
+of them being its number of points (uint32, 0 ending the file) and its columns one after the other:
+identifiers (uint32 size, then NUL-terminated strings), float64 values, int32 precision codes and int32
+status (0, an OPERATION_MESSAGE code or the opposite of a DATA_VALIDATION code). Numbers are
+little-endian. The columns of a chunk are read at once, without any parsing.
+*/
+struct binaryReader
+{
+    std::istream *fi;
+    std::vector<binaryColumn> vColumn;
+    std::vector<std::vector<char> > vData;  // columns of the current chunk
+    std::vector<size_t> vPos;               // next identifier in each column of the current chunk
+    unsigned int n, i;                      // size of the current chunk, next point
+    bool end;
+};
+
+/**
+* \brief Writer of binary files: the points are appended to the columns of a chunk, written at once
+(one writer per thread). A chunk must not hold more than BinaryChunkMaxSize points.
+*/
+struct binaryWriter
+{
+    std::vector<binaryColumn> vColumn;
+    std::vector<std::string> vData;         // columns of the current chunk
+    unsigned int n;                         // size of the current chunk
+};
+
+/**
+* \brief Streaming reader of XML (KML or GPX) files: the input is read by blocks and split into markups
+and pieces of text, copied as they are, so that a document can be passed through with a flat memory use.
+*/
+struct xmlReader
+{
+    std::istream *fi;
+    std::vector<char> buf;
+    size_t ib, ie;              // unread part of buf
+};
+
+/**
+* \brief Streaming reader of JSON (GeoJSON or GeoJSON text sequence) files: the input is read by blocks and
+split into tokens (see scanJSONtoken), copied as they are.
+*/
+struct jsonReader
+{
+    std::istream *fi;
+    std::vector<char> buf;
+    size_t ib, ie;              // unread part of buf
+};
+
+/**
+* \brief State of a GeoJSON text being transformed token by token (see addGeoJSONtoken): the positions are
+isolated to be operated, the other tokens (properties included) being written as they are.
+*/
+struct geojsonScanner
+{
+    double pt4d::*sourceValue[3];       // pt4d members of the values of a position
+    double pt4d::*targetValue[3];
+    unsigned int precision[3];          // decimal digits of the values written
+    bool compact;                       // white space not written
+    std::string vType;                  // type ('{' or '[') of each open container
+    std::string key;                    // member name of the next value
+    bool expectKey;
+    int coordinates, properties;        // depth of the coordinates and properties members (-1 if out)
+    int features;                       // depth of the features member of the root object (-1 if out)
+    std::vector<std::string> vToken;    // current array of coordinates (maybe a position)
+};
+
 //general
 void openOutputFile(std::ofstream *fo, const circeOptions& circopt, const std::string& str, int TransfoRequired);
 void writeOutputLine(std::ostream *fo, const circeOptions& circopt, const pt4d &p, unsigned int *idt);
 void closeOutputFile(std::ofstream *fo, const circeOptions &circopt);
+void writeOutputHeader(std::ostream *fo, const circeOptions& circopt, const std::string& str, int TransfoRequired);
+void writeOutputTail(std::ostream *fo, const circeOptions &circopt);
 //pt4d
-void writeVectorPt4d(const circeOptions &circopt, const std::vector<circe::pt4d> &vPt4d);
+void writeVectorPt4d(const circeOptions &circopt, const std::vector<circe::pt4d> &vPt4d, std::ostream *os = NULL);
 void displayVectorPt4d(std::ostream *fo, const std::vector<circe::pt4d>& vPt4d, const circeOptions &circopt);
 //basic file
 void initBasicOstream(std::ostream *fo);
-DATA_VALIDATION readBasicLine(std::ifstream *fi, const circeOptions &circopt, const std::string& lnfrmt,  pt4d *p, unsigned int *idt);
-DATA_VALIDATION readBasicLine2(std::ifstream *fi, const circeOptions &circopt, const std::string& lnfrmt,  pt4d *p, unsigned int *idt);
+void initBasicReader(basicReader *br, std::istream *fi, const circeOptions &circopt, const std::string& lnfrmt);
+bool eofBasicReader(const basicReader &br);
+DATA_VALIDATION readBasicLine(basicReader *br, pt4d *p, unsigned int *idt);
+void testReadBasicLine(std::string filout);
 void writeBasicHeader(std::ostream *fo, const circeOptions& circopt, const std::string& str, bool writePrec);
 void writeBasicHeader2(std::ostream *fo, const circeOptions& circopt, const std::string& str, int TransfoRequired);
 void writeBasicLine(std::ostream *fo, const circeOptions &circopt, const pt4d &p, unsigned int *idt, std::string lnfrmt);
+void initBasicWriter(basicWriter *bw, const circeOptions &circopt, const std::string& lnfrmt);
+void writeBasicLine(basicWriter *bw, const pt4d &p);
+void benchBasicWriter(std::string filout);
+//binary file
+void initBinaryReader(binaryReader *br, std::istream *fi, const circeOptions &circopt);
+bool eofBinaryReader(const binaryReader &br);
+DATA_VALIDATION readBinaryPoint(binaryReader *br, pt4d *p, int *status);
+void initBinaryWriter(binaryWriter *bw, const circeOptions &circopt, int TransfoRequired);
+void writeBinaryHeader(std::ostream *fo, const circeOptions &circopt, const binaryWriter &bw);
+void appendBinaryPoint(binaryWriter *bw, const pt4d &p, int status);
+void writeBinaryChunk(binaryWriter *bw, std::ostream *fo);
+void writeBinaryTail(std::ostream *fo);
 //KML file
 void readKMLline(tinyxml2::XMLElement *XMLelem, pt4d *p);
 void writeKMLheader(std::ostream *fo, const circeOptions& circopt);
 void writeKMLline(std::ostream *fo, const pt4d& p);
 void writeKMLtail(std::ostream *fo);
+DATA_VALIDATION readKMLtuple(const char *b, const char *e, pt4d *p, int *dim);
+std::string writeKMLtuple(const pt4d& p);
 //GPX file
 void readGPXline(tinyxml2::XMLElement *XMLelem, pt4d *p);
 void writeGPXheader(std::ostream *fo, const circeOptions& circopt);
 void writeGPXline(std::ostream *fo, const pt4d& p);
 void writeGPXtail(std::ostream *fo);
+DATA_VALIDATION readGPXpoint(const std::vector<std::string>& vToken, pt4d *p);
+void writeGPXpoint(std::vector<std::string> *vToken, const pt4d& p);
+//XML stream
+void initXMLReader(xmlReader *xr, std::istream *fi);
+bool nextXMLtoken(xmlReader *xr, std::string *token);
+std::string XMLtagName(const std::string& token, char *type);
+std::string decodeXMLtext(const std::string& str);
+//GeoJSON file
+void initJSONReader(jsonReader *jr, std::istream *fi);
+size_t scanJSONtoken(const char *b, const char *e, bool end);
+bool nextJSONtoken(jsonReader *jr, std::string *token);
+void initGeoJSONscanner(geojsonScanner *gs, CRS_TYPE sourceCRStype, bool sourceVertical,
+                        CRS_TYPE targetCRStype, bool targetVertical, const displayFormat &frmt, bool compact);
+void resetGeoJSONscanner(geojsonScanner *gs);
+bool addGeoJSONtoken(geojsonScanner *gs, const std::string& token, std::string *out);
+DATA_VALIDATION readGeoJSONposition(const geojsonScanner &gs, pt4d *p);
+void writeGeoJSONposition(geojsonScanner *gs, const pt4d *p, std::string *out);
 //NMEA
 //DATA_VALIDATION readNMEAline(std::ifstream *fi, pt4d *p, unsigned int *idt);
 //void writeNMEAline(std::ostream *fo, const pt4d& p);
@@ -104,6 +104,8 @@ void initDefOptions(circeOptions *circopt)
     circopt->getValidityArea = 0;
     circopt->getAuthority = 0;
 	circopt->followUpTransfos = 0;
+	circopt->threads = 1;
+	circopt->lineBuffered = 0;
     circopt->gridLoading = "UNDEFINED";
     //circopt->logPathname = "circe.log"; //ok
     InitDefPoint(&(circopt->Pt4d));
@@ -120,11 +122,13 @@ void initDefOptions(circeOptions *circopt)
     circopt->scrollArea = false;
     circopt->noUseVerticalFrameAuthoritative = false;
     circopt->plainDMS = false;
+    circopt->inverseGrids = false;
     circopt->sourceOptions.geodeticFrameId = circopt->targetOptions.geodeticFrameId = "";
     circopt->sourceOptions.verticalFrameId = circopt->targetOptions.verticalFrameId = "";
     circopt->sourceOptions.usesForTransformation = circopt->targetOptions.usesForTransformation = "";
     circopt->sourceOptions.geodeticCRStype = circopt->targetOptions.geodeticCRStype = CT_UNDEF;
 	circopt->displayPrecision = 0.001; // 1 mm
+	circopt->approxTolerance = 0.; // exact processing
     circopt->getSourceGeodeticFrame = 0;
     circopt->getTargetGeodeticFrame = 0;
     circopt->getSourceGeodeticCRS = 0;
@@ -197,6 +201,8 @@ void copyOptions(circeOptions *circopt2, const circeOptions &circopt1)
     circopt2->getValidityArea = circopt1.getValidityArea;
     circopt2->getAuthority = circopt1.getAuthority;
     circopt2->followUpTransfos = circopt1.followUpTransfos;
+    circopt2->threads = circopt1.threads;
+    circopt2->lineBuffered = circopt1.lineBuffered;
     circopt2->gridLoading = circopt1.gridLoading;
     circopt2->logPathname = circopt1.logPathname;
     circopt2->optionFile = circopt1.optionFile;
@@ -209,7 +215,9 @@ void copyOptions(circeOptions *circopt2, const circeOptions &circopt1)
     circopt2->scrollArea = circopt1.scrollArea;
     circopt2->noUseVerticalFrameAuthoritative = circopt1.noUseVerticalFrameAuthoritative;
     circopt2->plainDMS = circopt1.plainDMS;
+    circopt2->inverseGrids = circopt1.inverseGrids;
     circopt2->displayPrecision = circopt1.displayPrecision;
+    circopt2->approxTolerance = circopt1.approxTolerance;
     circopt2->getSourceGeodeticFrame = circopt1.getSourceGeodeticFrame;
     circopt2->getTargetGeodeticFrame = circopt1.getTargetGeodeticFrame;
     circopt2->getSourceGeodeticCRS = circopt1.getSourceGeodeticCRS;
@@ -323,7 +331,11 @@ std::string displayOptions(const circeOptions& circopt)
     s += "TRANSFORMATIONS\n";
     s += "idGeodeticTransfoRequired= "+circopt.idGeodeticTransfoRequired+"\n";
     s += "idVerticalTransfoRequired= "+circopt.idVerticalTransfoRequired+"\n";
+    s += "inverseGrids=              "+asString(circopt.inverseGrids)+"\n";
+    s += "threads=                   "+asString(circopt.threads)+"\n";
+    s += "lineBuffered=              "+asString(circopt.lineBuffered)+"\n";
 	s += "displayPrecision= "         +asString(circopt.displayPrecision) + "\n";
+	s += "approxTolerance=  "         +asString(circopt.approxTolerance) + "\n";
     s += "POINT\n";
     initBasicOstream(&ss);
 	unsigned int idt;
@@ -554,11 +566,23 @@ void parseOptions (int key, char *arg, circeOptions *circopt)
         if (!ss.eof()) getline(ss, circopt->sourceOptions.formatId, '.');
         if (!ss.eof()) getline(ss, circopt->sourceOptions.linearUnit, '.');
         if (!ss.eof()) getline(ss, circopt->sourceOptions.angularUnit, '.');
+        if (!ss.eof())
+        {
+            getline(ss, s, '.');
+            if (s == FileFormatText[FF_BINARY])
+                circopt->sourceOptions.subformatId = FF_BINARY;
+        }
         break;
     case 'F':
         if (!ss.eof()) getline(ss, circopt->targetOptions.formatId, '.');
         if (!ss.eof()) getline(ss, circopt->targetOptions.linearUnit, '.');
         if (!ss.eof()) getline(ss, circopt->targetOptions.angularUnit, '.');
+        if (!ss.eof())
+        {
+            getline(ss, s, '.');
+            if (s == FileFormatText[FF_BINARY])
+                circopt->targetOptions.subformatId = FF_BINARY;
+        }
         break;
     case 'e':
         if (!ss.eof())
@@ -597,6 +621,19 @@ void parseOptions (int key, char *arg, circeOptions *circopt)
 	case 'R':
 		circopt->followUpTransfos = 1;
         break;
+	case 'G':
+		circopt->inverseGrids = true;
+        break;
+	case 'j':
+		if (!ss.eof())
+		{
+			getline(ss, s);
+			sscanf(s.data(), "%d", &(circopt->threads));
+		}
+		break;
+	case 'k':
+		circopt->lineBuffered = 1;
+		break;
 	case 'q':
         circopt->verbose = 0;
         circopt->quiet = 1;
@@ -636,6 +673,13 @@ void parseOptions (int key, char *arg, circeOptions *circopt)
 			sscanf(s.data(), "%lf", &(circopt->displayPrecision));
 		}
 		break;
+	case 'A':
+		if (!ss.eof())
+		{
+			getline(ss, s);
+			sscanf(s.data(), "%lf", &(circopt->approxTolerance));
+		}
+		break;
     case 'N':
         if (!ss.eof()) getline(ss, circopt->separator);
         break;
@@ -729,7 +773,8 @@ void scrutinizeFormat(circeOptions *circopt, std::string what)
         }
         //getIndex returns 0 if frmt not in list.
         _ff=(FILE_FORMAT)getIndex(frmt,FileFormatText,FF_COUNT);
-        if (_ff > FF_BASIC)
+        //BINARY is given after the units and keeps the basic data format
+        if (_ff > FF_BASIC && _ff != FF_BINARY)
         {
             circopt->sourceOptions.subformatId  = _ff;
             return;
@@ -748,7 +793,8 @@ void scrutinizeFormat(circeOptions *circopt, std::string what)
             return;
         }
         _ff=(FILE_FORMAT)getIndex(frmt,FileFormatText,FF_COUNT);
-        if (_ff > FF_BASIC)
+        //BINARY is given after the units and keeps the basic data format
+        if (_ff > FF_BASIC && _ff != FF_BINARY)
         {
             circopt->targetOptions.subformatId  = _ff;
             return;
@@ -936,6 +982,9 @@ void parsePt4dCoordinates(int argc, char **argv, circe::circeOptions *circopt, i
         case 'V':
             ss >> circopt->Pt4d.w;
             break;
+        case 'T':
+            ss >> circopt->Pt4d.t;
+            break;
         default:
             throw std::string(ArgumentValidationText[AV_INVALID_OPTION_ARGUMENT])+": "+argTracking;
             break;
@@ -1319,20 +1368,32 @@ std::string writeCommandLine(const circeOptions& circopt) /*throw(std::string)*/
             else tvci = circopt.targetOptions.verticalCRSid;
         }
         s += "--sourceCRS="+sgci+"."+svci+" ";
-        s += "--sourceFormat="+circopt.sourceOptions.formatId+"."+circopt.sourceOptions.linearUnit+"."+circopt.sourceOptions.angularUnit+" ";
+        s += "--sourceFormat="+circopt.sourceOptions.formatId+"."+circopt.sourceOptions.linearUnit+"."+circopt.sourceOptions.angularUnit;
+        if (circopt.sourceOptions.subformatId == FF_BINARY) s += "."+FileFormatText[FF_BINARY];
+        s += " ";
         if (circopt.sourceOptions.epoch != 0.) s += "--sourceEpoch="+asString(circopt.sourceOptions.epoch,4)+" ";
         s += "--targetCRS="+tgci+"."+tvci+" ";
-        s += "--targetFormat="+circopt.targetOptions.formatId+"."+circopt.targetOptions.linearUnit+"."+circopt.targetOptions.angularUnit+" ";
+        s += "--targetFormat="+circopt.targetOptions.formatId+"."+circopt.targetOptions.linearUnit+"."+circopt.targetOptions.angularUnit;
+        if (circopt.targetOptions.subformatId == FF_BINARY) s += "."+FileFormatText[FF_BINARY];
+        s += " ";
         if (circopt.targetOptions.epoch != 0.) s += "--targetEpoch="+asString(circopt.targetOptions.epoch,4)+" ";
         if (circopt.idGeodeticTransfoRequired != "" || circopt.idVerticalTransfoRequired != "")
         {
             s += "--transfoRequired="+circopt.idGeodeticTransfoRequired+"."+circopt.idVerticalTransfoRequired+" ";
         }
         s += "--displayPrecision=" + asString(circopt.displayPrecision) + " ";
+        if (circopt.approxTolerance > 0.)
+            s += "--approx=" + asString(circopt.approxTolerance) + " ";
         if (getSeparator(circopt.separator) != ' ')
             s += "--separator=" + circopt.separator + " ";
         if (circopt.plainDMS)
             s += "--plainDMS ";
+        if (circopt.inverseGrids)
+            s += "--inverseGrids ";
+        if (circopt.threads != 1)
+            s += "--threads=" + asString(circopt.threads) + " ";
+        if (circopt.lineBuffered)
+            s += "--lineBuffered ";
         if (circopt.noPrintSppm)
             s += "--noPrintSppm ";
         s += "--gridLoading=BINARY ";
@@ -1374,6 +1435,9 @@ std::string writeCommandLine(const circeOptions& circopt) /*throw(std::string)*/
                 case 'V':
                     s += circe::asString(circopt.Pt4d.w,4)+" ";
                     break;
+                case 'T':
+                    s += circe::asString(circopt.Pt4d.t,4)+" ";
+                    break;
                 default:
                     break;
                 }
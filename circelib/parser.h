@@ -77,6 +77,7 @@ static const struct
 {
     {"usage",	              -1,  0,        0,  OH_USAGE, 1},
     {"getValidityArea",       'a', 0,        0,  OH_GET_VALIDITY_AREA, 5},
+    {"approx",                'A', "FLOAT",  0,  OH_APPROX, 2},
     {"boundaryFile",          'b', "STRING", 0,  OH_BOUNDARY_FILE, 2},
     {"processAsVector",       'c', 0,        0,  OH_PROCESS_VECTOR, 2},
     {"loadAsVector",          'C', 0,        0,  OH_LOAD_VECTOR, 2},
@@ -87,9 +88,12 @@ static const struct
     {"sourceFormat",          'f', "STRING", 0,  OH_SOURCE_FORMAT, 2},
     {"targetFormat",          'F', "STRING", 0,  OH_TARGET_FORMAT, 2},
     {"gridLoading",           'g', "STRING", 0,  OH_GRID_LOADING, 4},
+    {"inverseGrids",          'G', 0,        0,  OH_INVERSE_GRIDS, 4},
     {"help",	              'h', 0,    	 0,  OH_HELP, 0},
     {"sourceFrame",           'i', "STRING", 0,  OH_SOURCE_FRAME, 2},
     {"targetFrame",           'I', "STRING", 0,  OH_TARGET_FRAME, 2},
+    {"threads",               'j', "INT",    0,  OH_THREADS, 4},
+    {"lineBuffered",          'k', 0,        0,  OH_LINE_BUFFERED, 4},
     {"getCRSlist",            'l', 0,        0,  OH_GET_CRS_LIST, 5},
     {"getZoneList",           'L', 0,        0,  OH_GET_ZONE_LIST, 5},
     {"metadataFile",          'm', "STRING", 0,  OH_METADATAFILE, 2},
@@ -156,15 +160,15 @@ struct circeOptions
     circe::DATA_MODE dataMode;
     std::string metadataFile, gridLoading, logPathname, optionFile, imageFilename, logoFilename, iconFilename, boundaryFile;
     int displayHelp, runTest, multipleCRS, quiet, verbose, extraOut, processAsVector, loadAsVector;
-    int getCRSlist, getValidityArea, getAuthority, followUpTransfos;
+    int getCRSlist, getValidityArea, getAuthority, followUpTransfos, threads, lineBuffered;
     int getSourceGeodeticFrame, getSourceGeodeticCRS, getSourceVerticalCRS;
     int getTargetGeodeticFrame, getTargetGeodeticCRS, getTargetVerticalCRS;
     int getDataFileFormat, getDataPointFormat, getUom;
     int getGeodeticTransfo, getVerticalTransfo;
     int getAllGeodeticSubsetLists, getZoneList;
     circe::pt4d Pt4d;
-    bool printCS, displayBoundingBox, noPrintSppm, noUseVerticalFrameAuthoritative, scrollArea, plainDMS;
-	double displayPrecision;
+    bool printCS, displayBoundingBox, noPrintSppm, noUseVerticalFrameAuthoritative, scrollArea, plainDMS, inverseGrids;
+	double displayPrecision, approxTolerance;
     std::string separator, outputFormat, operationType;
     std::string menuTitle_zone, menuTitle_display, menuTitle_tool, menuTitle_help;
 };
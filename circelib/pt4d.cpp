@@ -126,6 +126,9 @@ std::string displayElement(const pt4d& p, char c)
     case 'V':
         ss << std::setprecision(p.frmt.n_m/*3*/) << p.w;
         break;
+    case 'T':
+        ss << displayEpoch(p.t);
+        break;
     case 'C':
         ss << std::setprecision(6) << p.conv;
         break;
@@ -174,6 +177,7 @@ void copyPt4d(pt4d *p1, const pt4d& p2)
     p1->e = p2.e;
     p1->n = p2.n;
     p1->w = p2.w;
+    p1->t = p2.t;
     p1->conv = p2.conv;
     p1->scfact = p2.scfact;
     p1->xi = p2.xi;
@@ -204,18 +208,111 @@ void copyPt4dVertical(pt4d *p1, const pt4d& p2)
     p1->info2 = p2.info2;
 }
 
+/**
+* \brief Copies the numeric members of a pt4dc instance in a pt4d instance.
+* \param[in] p2: A pt4dc instance.
+* \param[out] p1: A pointer to a pt4d instance (id, info, info2 and frmt are left unchanged).
+*/
+void copyPt4d(pt4d *p1, const pt4dc& p2)
+{
+    p1->x = p2.x;
+    p1->y = p2.y;
+    p1->z = p2.z;
+    p1->l = p2.l;
+    p1->p = p2.p;
+    p1->h = p2.h;
+    p1->e = p2.e;
+    p1->n = p2.n;
+    p1->w = p2.w;
+    p1->t = p2.t;
+    p1->conv = p2.conv;
+    p1->scfact = p2.scfact;
+    p1->xi = p2.xi;
+    p1->eta = p2.eta;
+    p1->CRStypeInit = p2.CRStypeInit;
+    p1->Gprec = p2.Gprec;
+    p1->Vprec = p2.Vprec;
+    p1->transfoIndex = p2.transfoIndex;
+}
+
+/**
+* \brief Copies the numeric members of a pt4d instance in a pt4dc instance.
+* \param[in] p2: A pt4d instance.
+* \param[out] p1: A pointer to a pt4dc instance (index and om are left unchanged).
+*/
+void copyPt4d(pt4dc *p1, const pt4d& p2)
+{
+    p1->x = p2.x;
+    p1->y = p2.y;
+    p1->z = p2.z;
+    p1->l = p2.l;
+    p1->p = p2.p;
+    p1->h = p2.h;
+    p1->e = p2.e;
+    p1->n = p2.n;
+    p1->w = p2.w;
+    p1->t = p2.t;
+    p1->conv = p2.conv;
+    p1->scfact = p2.scfact;
+    p1->xi = p2.xi;
+    p1->eta = p2.eta;
+    p1->CRStypeInit = p2.CRStypeInit;
+    p1->Gprec = p2.Gprec;
+    p1->Vprec = p2.Vprec;
+    p1->transfoIndex = p2.transfoIndex;
+}
+
+/**
+* \brief Builds the default display format.
+*/
+static displayFormat initDefaultFormat()
+{
+    displayFormat frmt;
+    frmt.angularUnit = "";
+    frmt.plainDMS = false;
+    initFormats(0, "", &frmt);
+    return frmt;
+}
+
+/**
+* \brief Returns the default display format, resolved once instead of once per point.
+* \return A reference to a constant displayFormat instance.
+*/
+const displayFormat& defaultFormat()
+{
+    static const displayFormat frmt = initDefaultFormat();
+    return frmt;
+}
+
 /**
 * \brief Initializes a pt4d instance with default values.
 * \param p: A pointer to a pt4d instance.
 */
 void InitDefPoint(pt4d *p)
 {
-    p->e=p->n=p->l=p->p=p->h=p->x=p->y=p->z=p->w=p->conv=p->scfact=p->xi=p->eta=0.;
-    p->id = p->info = p->info2 = "";
+    p->e=p->n=p->l=p->p=p->h=p->x=p->y=p->z=p->w=p->t=p->conv=p->scfact=p->xi=p->eta=0.;
+    p->id.clear();
+    p->info.clear();
+    p->info2.clear();
     p->CRStypeInit = CT_UNDEF;
 	p->Gprec = p->Vprec = 0;
     p->transfoIndex = 0;
-	initFormats(0, "", &(p->frmt));
+    p->frmt.n_m = defaultFormat().n_m;
+    p->frmt.n_ang = defaultFormat().n_ang;
+}
+
+/**
+* \brief Initializes a pt4dc instance with default values.
+* \param p: A pointer to a pt4dc instance.
+*/
+void InitDefPoint(pt4dc *p)
+{
+    p->e=p->n=p->l=p->p=p->h=p->x=p->y=p->z=p->w=p->t=p->conv=p->scfact=p->xi=p->eta=0.;
+    p->CRStypeInit = CT_UNDEF;
+    p->Gprec = p->Vprec = 0;
+    p->transfoIndex = 0;
+    p->index = 0;
+    p->om = 0;
 }
 
 /**
@@ -225,7 +322,7 @@ void InitDefPoint(pt4d *p)
 */
 void InitPoint(pt4d *p, double c1, double c2, double c3, double c4)
 {
-    p->e=p->n=p->l=p->p=p->h=p->x=p->y=p->z=p->w=0.;
+    p->e=p->n=p->l=p->p=p->h=p->x=p->y=p->z=p->w=p->t=0.;
     p->id = p->info = p->info2 = "";
     if (p->CRStypeInit==CT_GEOCENTRIC)
     {
@@ -68,21 +68,38 @@ struct displayFormat {
 
 // info is firstly intended to contain target vertical CRS id or name when an authoritative vertical 
 // transformation is required and so the target vertical CRS can vary from point to point.
+// t is the observation epoch of the point (decimal year), 0 meaning the epoch of the job.
 struct pt4d {
-	std::string id; double x; double y; double z; double l; double p; double h; double e; double n; double w;
+	std::string id; double x; double y; double z; double l; double p; double h; double e; double n; double w; double t;
     double conv; double scfact; double xi; double eta; CRS_TYPE CRStypeInit; int Gprec; int Vprec; displayFormat frmt;
     std::string info; std::string info2; int transfoIndex;
 };
 
+/**
+\brief pt4dc is a compact, trivially copyable counterpart of pt4d intended for numeric batch processing.
+It holds no std::string nor displayFormat: the identifier, the vertical info and the operation message
+of a point are kept out of band by the caller, using index (the rank of the point in the caller's
+containers). The output format is resolved once per job, not per point.
+*/
+struct pt4dc {
+    double x; double y; double z; double l; double p; double h; double e; double n; double w; double t;
+    double conv; double scfact; double xi; double eta; CRS_TYPE CRStypeInit; int Gprec; int Vprec;
+    int transfoIndex; unsigned int index; int om;
+};
+
 void initFormats(double prec, std::string angularUnit, displayFormat *frmt);
 std::string precisionCode2Text(int CodePrecision);
 std::string ComparePoint(pt4d *p, double c1, double c2, double c3, double c4);
 bool ComparePoint2(double a, double e2, pt4d *p, double c1, double c2, double c3, double c4, MEASURE_UNIT linearUnitId, MEASURE_UNIT angularUnitId, std::string *retMess, double *maxShift);
+const displayFormat& defaultFormat();
 void InitDefPoint(pt4d *p);
+void InitDefPoint(pt4dc *p);
 void InitPoint(pt4d *p, double c1, double c2, double c3, double c4);
 void copyPt4d(const pt4d& p, double *c1, double *c2, double *c3, double *c4);
 void copyPt4d(pt4d *p1, const pt4d& p2);
 void copyPt4dVertical(pt4d *p1, const pt4d& p2);
+void copyPt4d(pt4d *p1, const pt4dc& p2);
+void copyPt4d(pt4dc *p1, const pt4d& p2);
 
 std::string displayElement(const pt4d& p, char c);
 std::string displayEpoch(double e);
@@ -42,6 +42,9 @@ Author:
 #include <cstring> //strtok
 #include <sstream> //ostringstream
 #include <iomanip> //setprecision, setfill, setw
+#include <charconv> //to_chars
+#include <cmath> //isfinite
+#include <cstdio> //snprintf
 
 namespace circe
 {
@@ -188,6 +191,37 @@ std::string asString(const double x, const int precision, const int largeur)
     return ss.str();
 }
 
+/**
+* \brief Appends a double to a std::string as a std::ostream imbued with the classic locale writes it
+with std::setprecision and std::fixed, std::scientific or neither.
+* \param str: A pointer to the std::string.
+* \param[in] x: A double.
+* \param[in] floatfield: 'f' (std::fixed), 'e' (std::scientific) or 'g' (neither).
+* \param[in] precision: The precision.
+*/
+void appendDouble(std::string *str, double x, char floatfield, int precision)
+{
+    char buf[128];
+    const char *frmt = (floatfield == 'f' ? "%.*f" : floatfield == 'e' ? "%.*e" : "%.*g");
+    if (std::isfinite(x))
+    {
+        std::to_chars_result r = std::to_chars(buf, buf+sizeof(buf), x,
+                                               floatfield == 'f' ? std::chars_format::fixed :
+                                               floatfield == 'e' ? std::chars_format::scientific :
+                                                                   std::chars_format::general, precision);
+        if (r.ec == std::errc())
+        {
+            str->append(buf, r.ptr-buf);
+            return;
+        }
+    }
+    int n = snprintf(NULL, 0, frmt, precision, x);
+    size_t pos = str->size();
+    str->resize(pos+n+1);
+    snprintf(&(*str)[pos], n+1, frmt, precision, x);
+    str->resize(pos+n);
+}
+
 /**
 * \brief Returns the substring after the last occurrence of a char in a std::string.
 * \param[in] _value: The std::string.
@@ -61,6 +61,7 @@ std::string asString(const long& x);
 std::string asString(const double& x);
 std::string asString(const double x, const int precision);
 std::string asString(const double x, const int precision, const int largeur);
+void appendDouble(std::string *str, double x, char floatfield, int precision);
 std::string afterChar(const std::string& _value, char _char);
 void CompleteString(std::string *str);
 void RemoveCR(std::string *str);
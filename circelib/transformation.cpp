@@ -58,12 +58,32 @@ double NINT(double a)
     else return 0;
 }
 
+/**
+* \brief Solves a 3x3 linear system A.x = b (Cramer's rule).
+* \param[in] A: the matrix (row-major).
+* \param[in] b: the right-hand side.
+* \param[out] x: the solution.
+* \return false if the matrix is singular.
+*/
+bool Solve3(const double A[9], const double b[3], double x[3])
+{
+    double det = A[0]*(A[4]*A[8]-A[5]*A[7]) - A[1]*(A[3]*A[8]-A[5]*A[6]) + A[2]*(A[3]*A[7]-A[4]*A[6]);
+    if (fabs(det) < 1e-12)
+        return false;
+    x[0] = (b[0]*(A[4]*A[8]-A[5]*A[7]) - A[1]*(b[1]*A[8]-A[5]*b[2]) + A[2]*(b[1]*A[7]-A[4]*b[2]))/det;
+    x[1] = (A[0]*(b[1]*A[8]-A[5]*b[2]) - b[0]*(A[3]*A[8]-A[5]*A[6]) + A[2]*(A[3]*b[2]-b[1]*A[6]))/det;
+    x[2] = (A[0]*(A[4]*b[2]-b[1]*A[7]) - A[1]*(A[3]*b[2]-b[1]*A[6]) + b[0]*(A[3]*A[7]-A[4]*A[6]))/det;
+    return true;
+}
+
 /**
 * \brief Constructor.
 */
 Transformation::Transformation()
 {
     mb = NULL;
+    Values = std::make_shared<gridValues>();
+    bLastShift = false;
     //reset();
 }
 
@@ -80,6 +100,7 @@ void Transformation::reset()
     //Fichier 		=	NULL;
     Offset			=	0;
     LoadingType         = LD_UNDEF;
+    Values = std::make_shared<gridValues>();
 
     // General data
     GridType		=	GF_UNDEF;
@@ -91,6 +112,9 @@ void Transformation::reset()
     Keyword = "UNDEFINED";
     Description	= "UNDEFINED";
 	FollowUp = "";
+    bLastShift = false;
+    LastShift.clear();
+    IterationHistogram.clear();
 
     // Node data
     Layout		=	L_UNDEF;
@@ -106,6 +130,7 @@ void Transformation::reset()
     NodeCRStype	=	CT_UNDEF;
     IncCoordUnit		=	MU_DEGREE;
     NodeIncCoordUnit	=	MU_DEGREE;
+    InitUnitConversion(MU_UNDEF, NodeIncCoordUnit, &InterpolationUnitConversion);
     bNodeCoordWritten	=	false;
     bPrecisionCode		=	false;
     bPositiveWest			=	false;
@@ -126,6 +151,8 @@ void Transformation::reset()
     bUnknownValue2zero	=	0;
     //Translation[0]	=	0.;
     RateFactor          =   1.;
+    bHelmertMatrixOK    =   false;
+    HelmertOA           =   OA_UNDEF;
     MinValue			=	0.;
     MaxValue			=	0.;
     MeanValue			=	0.;
@@ -142,10 +169,12 @@ void Transformation::reset()
     Bf				=	0.;
     E2f				=	0.;
     EpochF          =   0.;
+    InitEllipsoidContext(Af, E2f, &ECf);
     At				=	0.;
     Bt				=	0.;
     E2t				=	0.;
     EpochT          =   0.;
+    InitEllipsoidContext(At, E2t, &ECt);
 }
 
 /**
@@ -180,6 +209,7 @@ Transformation::Transformation(const Transformation &B) : Operation(B)
     ValueUnit		=	B.ValueUnit;
     IncCoordUnit		=	B.IncCoordUnit;
     NodeIncCoordUnit	=	B.NodeIncCoordUnit;
+    InterpolationUnitConversion = B.InterpolationUnitConversion;
     Encoding	=	B.Encoding;
     bNodeCoordWritten	=	B.bNodeCoordWritten;
     bPrecisionCode		=	B.bPrecisionCode;
@@ -192,6 +222,11 @@ Transformation::Transformation(const Transformation &B) : Operation(B)
     bFinalLineNumber	=	B.bFinalLineNumber;
     Description		=	B.Description;
 	FollowUp	= B.FollowUp;
+    bLastShift = B.bLastShift;
+    LastShift = B.LastShift;
+    for (int k=0; k<9; k++) LastGradient[k] = B.LastGradient[k];
+    for (int k=0; k<3; k++) LastX[k] = B.LastX[k];
+    IterationHistogram = B.IterationHistogram;
     InterpolationOrder =	B.InterpolationOrder;
     N_nodes			=	B.N_nodes;
     N_col			=	B.N_col;
@@ -211,6 +246,9 @@ Transformation::Transformation(const Transformation &B) : Operation(B)
     SouthBound			=	B.SouthBound;
     NorthBound			=	B.NorthBound;
     RateFactor          =   B.RateFactor;
+    bHelmertMatrixOK    =   B.bHelmertMatrixOK;
+    HelmertOA           =   B.HelmertOA;
+    for (int k = 0; k < 12; k++) HelmertMatrix[k] = B.HelmertMatrix[k];
     MinValue			=	B.MinValue;
     MaxValue			=	B.MaxValue;
     MeanValue			=	B.MeanValue;
@@ -222,42 +260,20 @@ Transformation::Transformation(const Transformation &B) : Operation(B)
     Bf				=	B.Bf;
     E2f				=	B.E2f;
     EpochF          =   B.EpochF;
+    ECf             =   B.ECf;
     At				=	B.At;
     Bt				=	B.Bt;
     E2t				=	B.E2t;
     EpochT          =   B.EpochT;
+    ECt             =   B.ECt;
 
     InitValues.reserve(B.InitValues.size());
     copy(B.InitValues.begin(),B.InitValues.end(),back_inserter(InitValues));
 
     Translation.reserve(B.Translation.size());
     copy(B.Translation.begin(),B.Translation.end(),back_inserter(Translation));
-    if (Encoding == ET_UNDEF || Encoding == ET_ASCII)
-    {
-        switch (ValueType)
-        {
-            case 1:
-                VecValI2.reserve(B.VecValI2.size());
-                copy(B.VecValI2.begin(),B.VecValI2.end(),back_inserter(VecValI2));
-                break;
-            case 2:
-                VecValI4.reserve(B.VecValI4.size());
-                copy(B.VecValI4.begin(),B.VecValI4.end(),back_inserter(VecValI4));
-                break;
-            case 3:
-                VecValR4.reserve(B.VecValR4.size());
-                copy(B.VecValR4.begin(),B.VecValR4.end(),back_inserter(VecValR4));
-                break;
-            case 4:
-                VecValR8.reserve(B.VecValR8.size());
-                copy(B.VecValR8.begin(),B.VecValR8.end(),back_inserter(VecValR8));
-                break;
-            default:
-                break;
-        }
-        VecPrec.reserve(B.VecPrec.size());
-        copy(B.VecPrec.begin(),B.VecPrec.end(),back_inserter(VecPrec));
-    }
+    // The loaded values are shared, not copied (see gridValues).
+    Values = B.Values;
 }
 
 
@@ -290,6 +306,7 @@ Transformation& Transformation::operator=(const Transformation &B)
     ValueUnit		=	B.ValueUnit;
     IncCoordUnit		=	B.IncCoordUnit;
     NodeIncCoordUnit	=	B.NodeIncCoordUnit;
+    InterpolationUnitConversion = B.InterpolationUnitConversion;
     Encoding	=	B.Encoding;
     bNodeCoordWritten	=	B.bNodeCoordWritten;
     bPrecisionCode		=	B.bPrecisionCode;
@@ -302,6 +319,11 @@ Transformation& Transformation::operator=(const Transformation &B)
     bFinalLineNumber	=	B.bFinalLineNumber;
     Description		=	B.Description;
 	FollowUp	= B.FollowUp;
+    bLastShift = B.bLastShift;
+    LastShift = B.LastShift;
+    for (int k=0; k<9; k++) LastGradient[k] = B.LastGradient[k];
+    for (int k=0; k<3; k++) LastX[k] = B.LastX[k];
+    IterationHistogram = B.IterationHistogram;
     InterpolationOrder =	B.InterpolationOrder;
     N_nodes			=	B.N_nodes;
     N_col			=	B.N_col;
@@ -321,6 +343,9 @@ Transformation& Transformation::operator=(const Transformation &B)
     SouthBound			=	B.SouthBound;
     NorthBound			=	B.NorthBound;
     RateFactor          =   B.RateFactor;
+    bHelmertMatrixOK    =   B.bHelmertMatrixOK;
+    HelmertOA           =   B.HelmertOA;
+    for (int k = 0; k < 12; k++) HelmertMatrix[k] = B.HelmertMatrix[k];
     MinValue			=	B.MinValue;
     MaxValue			=	B.MaxValue;
     MeanValue			=	B.MeanValue;
@@ -332,42 +357,20 @@ Transformation& Transformation::operator=(const Transformation &B)
     Bf				=	B.Bf;
     E2f				=	B.E2f;
     EpochF          =   B.EpochF;
+    ECf             =   B.ECf;
     At				=	B.At;
     Bt				=	B.Bt;
     E2t				=	B.E2t;
     EpochT          =   B.EpochT;
+    ECt             =   B.ECt;
 
     InitValues.reserve(B.InitValues.size());
     copy(B.InitValues.begin(),B.InitValues.end(),back_inserter(InitValues));
 
     Translation.reserve(B.Translation.size());
     copy(B.Translation.begin(),B.Translation.end(),back_inserter(Translation));
-    if (Encoding == ET_UNDEF || Encoding == ET_ASCII)
-    {
-        switch (ValueType)
-        {
-            case 1:
-                VecValI2.reserve(B.VecValI2.size());
-                copy(B.VecValI2.begin(),B.VecValI2.end(),back_inserter(VecValI2));
-                break;
-            case 2:
-                VecValI4.reserve(B.VecValI4.size());
-                copy(B.VecValI4.begin(),B.VecValI4.end(),back_inserter(VecValI4));
-                break;
-            case 3:
-                VecValR4.reserve(B.VecValR4.size());
-                copy(B.VecValR4.begin(),B.VecValR4.end(),back_inserter(VecValR4));
-                break;
-            case 4:
-                VecValR8.reserve(B.VecValR8.size());
-                copy(B.VecValR8.begin(),B.VecValR8.end(),back_inserter(VecValR8));
-                break;
-            default:
-                break;
-        }
-        VecPrec.reserve(B.VecPrec.size());
-        copy(B.VecPrec.begin(),B.VecPrec.end(),back_inserter(VecPrec));
-    }
+    // The loaded values are shared, not copied (see gridValues).
+    Values = B.Values;
 
     return *this;
 }
@@ -722,6 +725,7 @@ void Transformation::toEpoch(double ep)
 		return;
 	double de = ep - Epoch;
     //int drctn = (getOperationApplication() != OA_DIRECT) ? -1 : 1;
+    bHelmertMatrixOK = false;
     for (int i = 0; i<7; i++) InitValues[i] += InitValues[i + 7] * de;
 }
 
@@ -735,6 +739,7 @@ void Transformation::toEpoch(double de, const double values[7])
 {
     if (InitValues.size() < 7)
         return;
+    bHelmertMatrixOK = false;
     if (InitValues.size() < 14)
     {
         for (int i = 0; i<7; i++)
@@ -747,6 +752,31 @@ void Transformation::toEpoch(double de, const double values[7])
 	for (int i = 0; i<7; i++) InitValues[i] = InitValues[i + 7] * de + values[i];
 }
 
+/**
+* \brief Appends the parameters set by toEpoch and setRateFactor (the 7 first transformation
+* values and the rate factor) to a vector.
+* \param[out] values: the vector.
+*/
+void Transformation::getEpochParameters(std::vector<double> *values) const
+{
+    values->insert(values->end(), InitValues.begin(), InitValues.begin()+std::min(int(InitValues.size()),7));
+    values->push_back(RateFactor);
+}
+
+/**
+* \brief Sets the parameters appended by getEpochParameters (the grid values are left unchanged).
+* \param[in] values: pointer to the parameters of this transformation.
+* \return A pointer to the parameters following those of this transformation.
+*/
+const double* Transformation::setEpochParameters(const double *values)
+{
+    int n = std::min(int(InitValues.size()),7);
+    for (int i = 0; i<n; i++) InitValues[i] = values[i];
+    RateFactor = values[n];
+    bHelmertMatrixOK = false;
+    return values+n+1;
+}
+
 /**
 * \brief Checks wether a legacy Circe precision code is valid or not.
 * \param[in] CodePrecision: the int precision code.
@@ -1173,22 +1203,35 @@ int Transformation::InitAccesElement(bool bSystemBinary)
     return 0;
 }
 
+/**
+* \brief Gives the grid values to be modified, copied first if they are shared with another instance.
+* \return A pointer to the gridValues of this instance only.
+*/
+gridValues* Transformation::WritableValues()
+{
+    if (Values.use_count() > 1)
+        Values = std::make_shared<gridValues>(*Values);
+    Values->bInverseGrid = false;
+    return Values.get();
+}
+
 int Transformation::InitVector(int taille)
 {
+    gridValues *gv = WritableValues();
     Encoding = ET_ASCII;
     switch (ValueType)
     {
         case 1:
-            VecValI2.resize(taille);
+            gv->VecValI2.resize(taille);
             break;
         case 2:
-            VecValI4.resize(taille);
+            gv->VecValI4.resize(taille);
             break;
         case 3:
-            VecValR4.resize(taille);
+            gv->VecValR4.resize(taille);
             break;
         case 4:
-            VecValR8.resize(taille);
+            gv->VecValR8.resize(taille);
             break;
         default:
             break;
@@ -1419,19 +1462,19 @@ double Transformation::ReadR8bin_Swap ()
 
 double Transformation::ReadI2tab (int Position)
 {
-    return (double)VecValI2[Position];
+    return (double)Values->VecValI2[Position];
 }
 double Transformation::ReadI4tab (int Position)
 {
-    return (double)VecValI4[Position];
+    return (double)Values->VecValI4[Position];
 }
 double Transformation::ReadR4tab (int Position)
 {
-    return (double)VecValR4[Position];
+    return (double)Values->VecValR4[Position];
 }
 double Transformation::ReadR8tab (int Position)
 {
-    return VecValR8[Position];
+    return Values->VecValR8[Position];
 }
 
 void Transformation::WriteStringBin (const std::string str, int nc)
@@ -1570,19 +1613,19 @@ void Transformation::WriteR8bin_Swap (const double dV)
 
 void Transformation::WriteI2tab (const double dV, int Position)
 {
-    VecValI2[Position] = short(NINT(dV));
+    WritableValues()->VecValI2[Position] = short(NINT(dV));
 }
 void Transformation::WriteI4tab (const double dV, int Position)
 {
-    VecValI4[Position] = int(NINT(dV));
+    WritableValues()->VecValI4[Position] = int(NINT(dV));
 }
 void Transformation::WriteR4tab (const double dV, int Position)
 {
-    VecValR4[Position] = float(dV);
+    WritableValues()->VecValR4[Position] = float(dV);
 }
 void Transformation::WriteR8tab (const double dV, int Position)
 {
-    VecValR8[Position] = dV;
+    WritableValues()->VecValR8[Position] = dV;
 }
 
 int Transformation::WriteElement(const double dV, int Position)
@@ -1620,7 +1663,7 @@ void Transformation::Element(int i, int j, double *VV, int *precision_code)
     {
         for (k=0;k<N_val;k++)
             VV[k]=(this->*ReadElementTab)(int(Nb*N_val+k));
-        if (bPrecisionCode) *precision_code=VecPrec[Nb];
+        if (bPrecisionCode) *precision_code=Values->VecPrec[Nb];
         else *precision_code = 0;
     }
     else if (LoadingType == LD_BINARY)
@@ -1649,9 +1692,11 @@ void Transformation::Element(int i, int j, double *VV, int *precision_code)
 * \param[in] x, y: coordinates of the position to interpolate at.
 * \param[out] VV: an array of double containing the transformation values. Its memory space must have been allocated by the calling function.
 * \param[out] precision_code: the precision code.
+* \param[out] dVV: if not NULL, an array of 2*N_val double receiving the partial derivatives of the
+transformation values wrt x (dVV[2*i]) and y (dVV[2*i+1]), in value units per grid coordinate unit.
 * \throw str A std:string containing the error message if any.
 */
-int Transformation::BilinearInterpolation(double x, double y, double *VV, int *code)
+int Transformation::BilinearInterpolation(double x, double y, double *VV, int *code, double *dVV)
 {
     int      C, L, i, P1, P2, P3, P4;
     double   dx, dy, *V1, *V2, *V3, *V4;
@@ -1783,21 +1828,26 @@ int Transformation::BilinearInterpolation(double x, double y, double *VV, int *c
             VV[i] = Translation[i] + (1-dx)*(1-dy)*V1[i] + (1-dx)*dy*V2[i] + dx*(1-dy)*V3[i] + dx*dy*V4[i];
     }
 
+    if (dVV != NULL)
+    {
+        for (i=0;i<N_val;i++)
+        {
+            if (VV[i] == UnknownValue && UnknownValue!=0.)
+                dVV[2*i] = dVV[2*i+1] = 0.;
+            else
+            {
+                dVV[2*i]   = ((1-dy)*(V3[i]-V1[i]) + dy*(V4[i]-V2[i]))/WE_inc;
+                dVV[2*i+1] = ((1-dx)*(V2[i]-V1[i]) + dx*(V4[i]-V3[i]))/SN_inc;
+            }
+        }
+    }
+
     if (calc_vert_defl)
     {
         double xi, eta;
-        VertDeflection(At, E2t, y, SN_inc, WE_inc, (V1[0]-V3[0]+V2[0]-V4[0])/2.,(V1[0]-V2[0]+V3[0]-V4[0])/2., &xi, &eta);
-        //VertDeflection(6378249, .006803487646, y, SN_inc, WE_inc, -V3[0]+V1[0], -V2[0]+V1[0], &xi, &eta);
-        //VertDeflection(6378137, .006694380025, y, SN_inc, WE_inc, (V1[0]-V3[0]+V2[0]-V4[0])/2.,(V1[0]-V2[0]+V3[0]-V4[0])/2., &xi, &eta);
+        VertDeflection(getTargetEllipsoidContext(), y, SN_inc, WE_inc, (V1[0]-V3[0]+V2[0]-V4[0])/2.,(V1[0]-V2[0]+V3[0]-V4[0])/2., &xi, &eta);
         VV[1] = xi;
         VV[2] = eta;
-//        qDebug("phi:%lf",y);
-//        qDebug("V3-V1:%lf",V3[0]-V1[0]);
-//        qDebug("V2-V1:%lf",V2[0]-V1[0]);
-//        qDebug("SN_inc:%lf °",UnitConvert(SN_inc, MU_RADIAN, MU_DEGREE));
-//        qDebug("WE_inc:%lf °",UnitConvert(WE_inc, MU_RADIAN, MU_DEGREE));
-//        qDebug("xi:%lf \"",UnitConvert(VV[1], MU_RADIAN, MU_SECOND));
-//        qDebug("eta:%lf \"",UnitConvert(VV[2], MU_RADIAN, MU_SECOND));
     }
 
 //    char NomFicSuivi[_MAX_PATH];
@@ -1837,9 +1887,12 @@ int Transformation::BilinearInterpolation(double x, double y, double *VV, int *c
 * \param[in] x, y: coordinates of the position to interpolate at.
 * \param[out] VV: an array of double containing the transformation values. Its memory space must have been allocated by the calling function.
 * \param[out] precision_code: the precision code.
+* \param[out] dVV: if not NULL, an array of 2*N_val double receiving the partial derivatives of the
+spline surface wrt x (dVV[2*i]) and y (dVV[2*i+1]), in value units per grid coordinate unit, calculated
+from the same window.
 * \throw str A std:string containing the error message if any.
 */
-int Transformation::SplineInterpolation(int window_size, double x, double y, double *VV, int *code)
+int Transformation::SplineInterpolation(int window_size, double x, double y, double *VV, int *code, double *dVV)
 {
     int      i, c, l, k, C, L, C0, L0, P;//, P1, P2, P3, P4;
     double   dx, dy;
@@ -1851,6 +1904,8 @@ int Transformation::SplineInterpolation(int window_size, double x, double y, dou
     double *R = (double*)malloc(window_size*sizeof(double));
     double *HC = (double*)malloc(window_size*sizeof(double));
     double *Q = (double*)malloc(window_size*sizeof(double));
+    // not malloc'ed: the function throws out of the grid
+    std::vector<double> HCx(dVV != NULL ? window_size : 0);
 
     dx = (x - WestBound)/WE_inc;
     dy = (y - SouthBound)/SN_inc;
@@ -1903,7 +1958,11 @@ int Transformation::SplineInterpolation(int window_size, double x, double y, dou
     for (k=0;k<N_val;k++)
     {
         if (bValInconnue)
+        {
             VV[k] = UnknownValue;
+            if (dVV != NULL)
+                dVV[2*k] = dVV[2*k+1] = 0.;
+        }
         else
         {
             for (c=0; c<window_size; c++)
@@ -1911,9 +1970,17 @@ int Transformation::SplineInterpolation(int window_size, double x, double y, dou
                 for (l=0; l<window_size; l++) A[l] = T[(c*window_size+l)*N_val+k];
                 InitSpline1D(A, window_size, R, Q);
                 HC[c] = Spline1D(dx-C0+1, A, window_size, R);
+                if (dVV != NULL)
+                    HCx[c] = Spline1DDerivative(dx-C0+1, A, window_size, R);
             }
             InitSpline1D(HC, window_size, R, Q);
             VV[k] = Spline1D(dy-L0+1, HC, window_size, R);
+            if (dVV != NULL)
+            {
+                dVV[2*k+1] = Spline1DDerivative(dy-L0+1, HC, window_size, R)/SN_inc;
+                InitSpline1D(HCx.data(), window_size, R, Q);
+                dVV[2*k] = Spline1D(dy-L0+1, HCx.data(), window_size, R)/WE_inc;
+            }
         }
     }
 
@@ -1983,32 +2050,61 @@ double Transformation::Spline1D(double X, const double *Y, const int n, double *
     return SPLINE;
 }
 
+/**
+* \brief Derivative of Spline1D wrt X (per node increment).
+*/
+double Transformation::Spline1DDerivative(double X, const double *Y, const int n, double *R)
+{
+    double XX,N;
+    int j;
+
+    if (X<1)
+        return Y[1]-Y[0]-R[1]/6;
+    else if (X>n)
+        return Y[n-1]-Y[n-2]+R[n-2]/6;
+    XX = modf(X,&N);
+    j=(int)N;
+    return (Y[j]-Y[j-1]-R[j-1]/3-R[j]/6)+XX*(R[j-1]+XX*(R[j]-R[j-1])/2);
+}
+
 /**
 * \brief Performs an interpolation.
 * \param[in] unite_ini: A MEASURE_UNIT code for the unit of the input coordinates.
 * \param[in] l, p: coordinates of the position to interpolate at.
 * \param[out] VV: an array of double containing the transformation values. Its memory space must have been allocated by the calling function.
 * \param[out] code: the precision code.
+* \param[out] dVV: if not NULL, an array of 2*N_val double receiving the partial derivatives of the
+transformation values wrt l (dVV[2*i]) and p (dVV[2*i+1]), in value units per unite_ini, calculated
+analytically from the nodes fetched for the interpolation.
 * \return 0 if terminated with success.
 */
-int Transformation::Interpolate(MEASURE_UNIT unite_ini, double l, double p, double *VV, int *code)
+int Transformation::Interpolate(MEASURE_UNIT unite_ini, double l, double p, double *VV, int *code, double *dVV)
 {
-    int return_code = 0;
+    int i, return_code = 0;
     bool calc_vert_defl = (*code == CALC_VERT_DEFL);
 
-    l = UnitConvert(l, unite_ini, NodeIncCoordUnit);
-    p = UnitConvert(p, unite_ini, NodeIncCoordUnit);
+    if (InterpolationUnitConversion.u1 != unite_ini || InterpolationUnitConversion.u2 != NodeIncCoordUnit)
+        InitUnitConversion(unite_ini, NodeIncCoordUnit, &InterpolationUnitConversion);
+    l = UnitConvert(l, InterpolationUnitConversion);
+    p = UnitConvert(p, InterpolationUnitConversion);
 
     if (InterpolationType == P_BILINEAR)
     {
-        return_code = BilinearInterpolation (l, p, VV, code);
+        return_code = BilinearInterpolation (l, p, VV, code, dVV);
     }
     else if (InterpolationType == P_SPLINE)
     {
         if (calc_vert_defl)
             BilinearInterpolation (l, p, VV, code); //provisoire, pour eta xi
         //if (InterpolationOrder == 0) InterpolationOrder = 4;
-        return_code = SplineInterpolation(InterpolationOrder, l, p, VV, code);
+        return_code = SplineInterpolation(InterpolationOrder, l, p, VV, code, dVV);
+    }
+    if (dVV != NULL)
+    {
+        //derivatives per NodeIncCoordUnit => per unite_ini
+        double f = UnitConvert(1., InterpolationUnitConversion);
+        for (i=0;i<2*N_val;i++)
+            dVV[i] *= f;
     }
     return return_code;
 }
@@ -3073,29 +3169,31 @@ int Transformation::LoadTextFile()
         break;
 
     case LD_ARRAY :
+        // New values: the copies sharing the former ones keep them.
+        Values = std::make_shared<gridValues>();
         switch (ValueType)
         {
             case 1:
 //            VecValI2.resize(N_col*N_lines*N_val);
-            VecValI2.reserve(N_col*N_lines*N_val);
+            Values->VecValI2.reserve(N_col*N_lines*N_val);
                 break;
             case 2:
 //            VecValI4.resize(N_col*N_lines*N_val);
-            VecValI4.reserve(N_col*N_lines*N_val);
+            Values->VecValI4.reserve(N_col*N_lines*N_val);
                 break;
             case 3:
 //            VecValR4.resize(N_col*N_lines*N_val);
-            VecValR4.reserve(N_col*N_lines*N_val);
+            Values->VecValR4.reserve(N_col*N_lines*N_val);
                 break;
             case 4:
 //            VecValR8.resize(N_col*N_lines*N_val);
-            VecValR8.reserve(N_col*N_lines*N_val);
+            Values->VecValR8.reserve(N_col*N_lines*N_val);
                 break;
             default:
                 break;
         }
 //        VecPrec.resize(N_col*N_lines);
-        VecPrec.reserve(N_col*N_lines);
+        Values->VecPrec.reserve(N_col*N_lines);
         break;
 
     default :
@@ -3136,7 +3234,7 @@ int Transformation::LoadTextFile()
                         break;
                     case LD_ARRAY :
 //                        VecValI2[j++] = sV;
-                        VecValI2.push_back(sV);
+                        Values->VecValI2.push_back(sV);
                         break;
                     default :
                         break;
@@ -3157,7 +3255,7 @@ int Transformation::LoadTextFile()
                         break;
                     case LD_ARRAY :
 //                        VecValI4[j++] = iV;
-                        VecValI4.push_back(iV);
+                        Values->VecValI4.push_back(iV);
                         break;
                     default :
                         break;
@@ -3178,7 +3276,7 @@ int Transformation::LoadTextFile()
                         break;
                     case LD_ARRAY :
 //                        VecValR4[j++] = fV;
-                        VecValR4.push_back(fV);
+                        Values->VecValR4.push_back(fV);
                         break;
                     default :
                         break;
@@ -3199,7 +3297,7 @@ int Transformation::LoadTextFile()
                         break;
                     case LD_ARRAY :
 //                        VecValR8[j++] = dV;
-                        VecValR8.push_back(dV);
+                        Values->VecValR8.push_back(dV);
                         break;
                     default :
                         break;
@@ -3220,7 +3318,7 @@ int Transformation::LoadTextFile()
                 WriteI4bin(entier);
                 break;
             case LD_ARRAY :
-                VecPrec.push_back(entier);
+                Values->VecPrec.push_back(entier);
 //                VecPrec[l] = entier;
                 break;
             default :
@@ -3297,24 +3395,26 @@ int Transformation::LoadBinaryFile()
     std::cout << s << " " << GridFile << "...";
     int prgStep = N_col*N_lines/100;
 
+    // New values: the copies sharing the former ones keep them.
+    Values = std::make_shared<gridValues>();
     switch (ValueType)
     {
         case 1:
-            VecValI2.resize(N_col*N_lines*N_val);
+            Values->VecValI2.resize(N_col*N_lines*N_val);
             break;
         case 2:
-            VecValI4.resize(N_col*N_lines*N_val);
+            Values->VecValI4.resize(N_col*N_lines*N_val);
             break;
         case 3:
-            VecValR4.resize(N_col*N_lines*N_val);
+            Values->VecValR4.resize(N_col*N_lines*N_val);
             break;
         case 4:
-            VecValR8.resize(N_col*N_lines*N_val);
+            Values->VecValR8.resize(N_col*N_lines*N_val);
             break;
         default:
             break;
     }
-    VecPrec.resize(N_col*N_lines);
+    Values->VecPrec.resize(N_col*N_lines);
 
     fin.seekg(Offset, std::ios::beg);
     j = l = 0;
@@ -3325,22 +3425,22 @@ int Transformation::LoadBinaryFile()
             switch (ValueType)
             {
                 case 1:
-                    VecValI2[j++] = ReadI2bin();
+                    Values->VecValI2[j++] = ReadI2bin();
                     break;
                 case 2:
-                    VecValI4[j++] = ReadI4bin();
+                    Values->VecValI4[j++] = ReadI4bin();
                     break;
                 case 3:
-                    VecValR4[j++] = ReadR4bin();
+                    Values->VecValR4[j++] = ReadR4bin();
                     break;
                 case 4:
-                    VecValR8[j++] = ReadR8bin();
+                    Values->VecValR8[j++] = ReadR8bin();
                     break;
                 default:
                     break;
             }
         }
-        if (bPrecisionCode) VecPrec[l] = ReadI4bin();
+        if (bPrecisionCode) Values->VecPrec[l] = ReadI4bin();
         l++;
 
         if(++i==prgStep)
@@ -3438,6 +3538,92 @@ void Transformation::Transform3(OPERATION_APPLICATION oa,
 	}
 }
 
+/**
+* \brief Precomputes the geocentric transformation of a constant 3-, 7- or 14-parameter transformation
+* in its current application (see HelmertCart in conversioncore). The rates of a 14-parameter
+* transformation must already be applied by toEpoch, so the matrix holds the transformation at the
+* epoch of the job. Transform3 and Transform7 give the same results.
+* \param[out] this->HelmertMatrix.
+*/
+void Transformation::InitHelmertMatrix()
+{
+    const std::vector<double>& t = InitValues;
+    OPERATION_APPLICATION oa = getOperationApplication();
+    for (int k = 0; k < 12; k++) HelmertMatrix[k] = 0.;
+    if (N_val == 3 && t.size() >= 3)
+    {
+        double s = (oa == OA_DIRECT) ? RateFactor : -RateFactor;
+        HelmertMatrix[3] = t[0]*s;
+        HelmertMatrix[7] = t[1]*s;
+        HelmertMatrix[11] = t[2]*s;
+    }
+    else if ((N_val == 7 || N_val == 14) && t.size() >= 7)
+    {
+        if (oa == OA_DIRECT || oa == OA_REVERSE_SAME_METHOD)
+        {
+            double s = (oa == OA_DIRECT) ? 1. : -1.;
+            double D[12] = { t[3], -t[6], t[5], t[0],
+                             t[6], t[3], -t[4], t[1],
+                            -t[5], t[4], t[3], t[2] };
+            for (int k = 0; k < 12; k++) HelmertMatrix[k] = s*D[k];
+        }
+        else if (oa == OA_REVERSE_SAME_PARAMETERS)
+        {
+            // alg0063: inverse of A = (1+d)I + R^, written as I+D to avoid the cancellation of the diagonal.
+            double e = 1 + t[3], r2 = t[4]*t[4] + t[5]*t[5] + t[6]*t[6];
+            double denom = e*(e*e + r2), dg = -e*e*t[3] - e*r2;
+            double *D = HelmertMatrix;
+            D[0] = (dg + t[4]*t[4]) / denom;
+            D[1] = (e*t[6] + t[4]*t[5]) / denom;
+            D[2] = (-e*t[5] + t[4]*t[6]) / denom;
+            D[4] = (-e*t[6] + t[5]*t[4]) / denom;
+            D[5] = (dg + t[5]*t[5]) / denom;
+            D[6] = (e*t[4] + t[5]*t[6]) / denom;
+            D[8] = (e*t[5] + t[6]*t[4]) / denom;
+            D[9] = (-e*t[4] + t[6]*t[5]) / denom;
+            D[10] = (dg + t[6]*t[6]) / denom;
+            //Translation first: T = -(I+D)t
+            for (int i = 0; i < 3; i++)
+                D[4*i+3] = -t[i] - (D[4*i]*t[0] + D[4*i+1]*t[1] + D[4*i+2]*t[2]);
+        }
+    }
+    HelmertOA = oa;
+    bHelmertMatrixOK = true;
+}
+
+/**
+* \brief Returns the precomputed geocentric transformation, updated if the values or the application have changed.
+* \return A pointer to 12 doubles (see HelmertCart).
+*/
+const double* Transformation::getHelmertMatrix()
+{
+    if (!bHelmertMatrixOK || HelmertOA != getOperationApplication())
+        InitHelmertMatrix();
+    return HelmertMatrix;
+}
+
+/**
+* \brief Returns the constants derived from the source ellipsoid, updated if Af or E2f has changed.
+* \return A reference to an ellipsoidContext instance.
+*/
+const ellipsoidContext& Transformation::getSourceEllipsoidContext()
+{
+    if (ECf.a != Af || ECf.e2 != E2f)
+        InitEllipsoidContext(Af, E2f, &ECf);
+    return ECf;
+}
+
+/**
+* \brief Returns the constants derived from the target ellipsoid, updated if At or E2t has changed.
+* \return A reference to an ellipsoidContext instance.
+*/
+const ellipsoidContext& Transformation::getTargetEllipsoidContext()
+{
+    if (ECt.a != At || ECt.e2 != E2t)
+        InitEllipsoidContext(At, E2t, &ECt);
+    return ECt;
+}
+
 /**
 * \brief Outputs the source and target epochs in an application context.
 * \param[out] epF: pointer to the source epoch.
@@ -3487,6 +3673,308 @@ std::vector<Transformation>::iterator Transformation::SelectTransfo(double l, do
 	return itTsel;
 }
 
+/**
+* \brief Solves a 3-parameter grid transformation whose nodes are expressed in the target frame (F_TARGET),
+* i.e. finds the shift T such that T = V(geo(X1 + T)), V being the grid interpolation.
+* \param[in] itT: An iterator to the selected Transformation (N_val >= 3, OA_DIRECT).
+* \param[in] x1, y1, z1: Source geocentric coordinates.
+* \param[out] l2, p2, h2, x2, y2, z2: Target geographic and geocentric coordinates.
+* \param[out] VV: The N_val transformation values interpolated at the solution.
+* \param[out] precision_code: The precision code.
+* \return The code returned by the last interpolation.
+* \remark The convergence criterion (1e-7 between the applied and the interpolated shifts) is unchanged.
+The solver starts from the shift of the previous point, corrected at first order by the grid gradient
+(coherent streams), and then performs Newton steps built from the local gradient of the bilinear grid.
+The number of interpolations per point is accumulated in IterationHistogram.
+*/
+int Transformation::SolveTargetFrameGrid(std::vector<Transformation>::iterator itT,
+                                          double x1, double y1, double z1,
+                                          double *l2, double *p2, double *h2,
+                                          double *x2, double *y2, double *z2,
+                                          double *VV, int *precision_code)
+{
+    const double conv = 1e-7, max_jump = 1e4;
+    const int max_iter = 50;
+    double X1[3] = {x1, y1, z1}, J[9], A[9], D[3], R[3];
+    double sl, cl, sp, cp, w, N, M;
+    int i, k, code = 0, n_iter = 0;
+    bool done;
+    std::vector<double> RTS;
+    double rf = itT->RateFactor;
+    // not malloc'ed: Interpolate throws out of the grid
+    std::vector<double> dVV(2*itT->N_val);
+
+    //Warm start
+    if (itT->bLastShift && (int)itT->LastShift.size() == itT->N_val
+     && fabs(x1-itT->LastX[0]) < max_jump && fabs(y1-itT->LastX[1]) < max_jump && fabs(z1-itT->LastX[2]) < max_jump)
+    {
+        RTS = itT->LastShift;
+        //dT/dX1 = (I-G.rf)^-1.G
+        for (i=0; i<3; i++)
+        {
+            R[i] = 0.;
+            for (k=0; k<3; k++)
+                R[i] += itT->LastGradient[3*i+k]*(X1[k]-itT->LastX[k]);
+        }
+        for (k=0; k<9; k++)
+            A[k] = (k%4==0?1.:0.) - itT->LastGradient[k]*rf;
+        if (Solve3(A, R, D))
+            for (i=0; i<3; i++) RTS[i] += D[i];
+    }
+    else //Begin with approximate (mean) transformation
+        RTS = itT->getInitValues();
+
+    do
+    {
+        Transform3(OA_DIRECT, RTS, rf, x1, y1, z1, x2, y2, z2);
+        CartGeo(itT->getTargetEllipsoidContext(), *x2, *y2, *z2, l2, p2, h2);
+        code = itT->Interpolate(MU_RADIAN, *l2, *p2, VV, precision_code, dVV.data());
+        n_iter++;
+
+        //Gradient of the shift wrt geocentric coordinates: G = dV/d(l,p) . d(l,p)/d(x,y,z)
+        sl = sin(*l2);
+        cl = cos(*l2);
+        sp = sin(*p2);
+        cp = cos(*p2);
+        w = sqrt(1.-itT->E2t*sp*sp);
+        N = itT->At/w;
+        M = itT->At*(1.-itT->E2t)/(w*w*w);
+        for (i=0; i<3; i++)
+        {
+            J[3*i+0] = -dVV[2*i]*sl/((N+*h2)*cp) - dVV[2*i+1]*sp*cl/(M+*h2);
+            J[3*i+1] =  dVV[2*i]*cl/((N+*h2)*cp) - dVV[2*i+1]*sp*sl/(M+*h2);
+            J[3*i+2] =  dVV[2*i+1]*cp/(M+*h2);
+        }
+
+        done = true;
+        for (i = 0; i<itT->N_val; i++) if (fabs(RTS[i] - VV[i]) >= conv) done = false;
+        if (code == 2 || n_iter >= max_iter)
+            done = true;
+        if (done)
+            for (i = 0; i<itT->N_val; i++) RTS[i] = VV[i];
+        else
+        {
+            //Newton step: (I-J).D = V(T)-T, J = G.rf
+            for (i=0; i<3; i++)
+                R[i] = VV[i] - RTS[i];
+            for (k=0; k<9; k++)
+                A[k] = (k%4==0?1.:0.) - J[k]*rf;
+            if (!Solve3(A, R, D))
+                for (i=0; i<3; i++) D[i] = R[i];
+            for (i=0; i<3; i++)
+                RTS[i] += D[i];
+            for (i=3; i<itT->N_val; i++)
+                RTS[i] = VV[i];
+        }
+    } while (!done);
+
+    itT->bLastShift = (code != 2);
+    itT->LastShift = RTS;
+    for (k=0; k<9; k++) itT->LastGradient[k] = J[k];
+    for (k=0; k<3; k++) itT->LastX[k] = X1[k];
+    if ((int)itT->IterationHistogram.size() <= n_iter)
+        itT->IterationHistogram.resize(n_iter+1, 0);
+    itT->IterationHistogram[n_iter]++;
+    return code;
+}
+
+/**
+* \brief Tells whether an inverse grid may be derived for this transformation, i.e. whether
+* the grid is applied from the frame opposite to the frame of its nodes: F_TARGET 3-value grids
+* applied directly (otherwise solved by iteration), NTV2 grids applied in reverse (otherwise
+* approximated by the negated shift).
+* \return true if InitInverseGrid is relevant.
+*/
+bool Transformation::IsInverseGridUseful()
+{
+    if (Layout == L_CONSTANT || N_col < 2 || N_lines < 2)
+        return false;
+    if (getNodeFrameInfo() == F_TARGET)
+        return getOperationApplication() == OA_DIRECT && N_val == 3;
+    if (GridType == GF_NTV2_BIN_L || GridType == GF_NTV2_BIN_B || GridType == GF_NTV2_ASC)
+        return getOperationApplication() != OA_DIRECT && N_val >= 2;
+    return false;
+}
+
+/**
+* \brief Solves the transformation values at a point expressed in the frame the grid is applied from.
+* \param[in] l, p: geographic coordinates (radians) in the frame the grid is applied from.
+* \param[out] VV: the N_val values of the grid at the corresponding point of the node frame.
+* \param[out] code: the precision code.
+* \return 0 if the iteration converged.
+*/
+int Transformation::SolveInverseNode(double l, double p, double *VV, int *code)
+{
+    const double conv = 1e-7, conv_rad = 1e-12;
+    const int max_iter = 50;
+    int i, n_iter = 0;
+    bool done;
+
+    if (getNodeFrameInfo() == F_TARGET)
+    {
+        double x1, y1, z1, x2, y2, z2, l2, p2, h2;
+        std::vector<double> RTS = getInitValues();
+        GeoCart(getSourceEllipsoidContext(), l, p, 0., &x1, &y1, &z1);
+        do
+        {
+            Transform3(OA_DIRECT, RTS, RateFactor, x1, y1, z1, &x2, &y2, &z2);
+            CartGeo(getTargetEllipsoidContext(), x2, y2, z2, &l2, &p2, &h2);
+            if (Interpolate(MU_RADIAN, l2, p2, VV, code) != 0)
+                return 1;
+            done = true;
+            for (i = 0; i<N_val; i++)
+            {
+                if (fabs(RTS[i] - VV[i]) >= conv) done = false;
+                RTS[i] = VV[i];
+            }
+        } while (!done && ++n_iter < max_iter);
+    }
+    else
+    {
+        double ls = l, ps = p, ln, pn;
+        do
+        {
+            if (Interpolate(MU_RADIAN, ls, ps, VV, code) != 0)
+                return 1;
+            ln = l + VV[1] * SEC2RAD;
+            pn = p - VV[0] * SEC2RAD;
+            done = (fabs(ln - ls) < conv_rad && fabs(pn - ps) < conv_rad);
+            ls = ln;
+            ps = pn;
+        } while (!done && ++n_iter < max_iter);
+    }
+    if (!done)
+        return 1;
+    for (i = 0; i<N_val; i++)
+        if (UnknownValue != 0. && VV[i] == UnknownValue)
+            return 1;
+    return 0;
+}
+
+/**
+* \brief Derives the inverse grid: the values of the transformation are solved by iteration at each
+* node of the grid lattice taken in the frame the grid is applied from, so that the application
+* costs a single interpolation (see InverseInterpolation). The maximum deviation between the
+* interpolated inverse grid and the iterative solution is measured at the cell centers.
+* The inverse grid is kept with the grid values shared by the copies of this instance (see gridValues),
+* so that it is derived once for all of them. It only applies to the application and the rate factor it
+* has been derived for: at another rate factor (another epoch), the iterative processing applies.
+* This function must not be called while a copy of this instance is operated by another thread.
+* \return The number of nodes that could not be solved (the cells around them fall back to the
+* iterative or approximate processing).
+*/
+int Transformation::InitInverseGrid()
+{
+    int C, L, i, n, code, nFail = 0;
+    double l, p, r, dl, dp, *VV, *WW;
+    gridValues *gv = Values.get();
+
+    if (!IsInverseGridUseful())
+        return 0;
+    if (hasInverseGrid())
+        return std::count(gv->InverseCodes.begin(), gv->InverseCodes.end(), -1);
+
+    gv->bInverseGrid = false;
+    gv->InverseApplication = getOperationApplication();
+    gv->InverseRateFactor = RateFactor;
+    gv->InverseResidual = 0.;
+    VV = (double*)malloc(N_val*sizeof(double));
+    WW = (double*)malloc(N_val*sizeof(double));
+    gv->InverseValues.assign(N_col*N_lines*N_val, 0.);
+    gv->InverseCodes.assign(N_col*N_lines, -1);
+    for (L=0; L<N_lines; L++)
+    for (C=0; C<N_col; C++)
+    {
+        n = L*N_col+C;
+        try
+        {
+            if (SolveInverseNode(WestBound+C*WE_inc, SouthBound+L*SN_inc, VV, &code) != 0)
+            {
+                nFail++;
+                continue;
+            }
+        }
+        catch (std::string)
+        {
+            nFail++;
+            continue;
+        }
+        for (i=0; i<N_val; i++)
+            gv->InverseValues[n*N_val+i] = VV[i];
+        gv->InverseCodes[n] = code;
+    }
+    gv->bInverseGrid = true;
+
+    for (L=0; L<N_lines-1; L++)
+    for (C=0; C<N_col-1; C++)
+    {
+        l = WestBound+(C+0.5)*WE_inc;
+        p = SouthBound+(L+0.5)*SN_inc;
+        if (InverseInterpolation(l, p, WW, &code) != 0)
+            continue;
+        try
+        {
+            if (SolveInverseNode(l, p, VV, &code) != 0)
+                continue;
+        }
+        catch (std::string)
+        {
+            continue;
+        }
+        if (getNodeFrameInfo() == F_TARGET)
+            r = sqrt(pow(WW[0]-VV[0],2)+pow(WW[1]-VV[1],2)+pow(WW[2]-VV[2],2));
+        else
+        {
+            dl = (WW[1]-VV[1])*SEC2RAD*At*cos(p);
+            dp = (WW[0]-VV[0])*SEC2RAD*At;
+            r = sqrt(dl*dl+dp*dp);
+        }
+        if (r > gv->InverseResidual)
+            gv->InverseResidual = r;
+    }
+
+    free(VV);
+    free(WW);
+    return nFail;
+}
+
+/**
+* \brief Bilinear interpolation in the inverse grid.
+* \param[in] x, y: geographic coordinates (radians) in the frame the grid is applied from.
+* \param[out] VV: the N_val interpolated values.
+* \param[out] code: the precision code of the nearest node.
+* \return 0 if the point is inside the inverse grid and its four nodes are solved, 1 otherwise.
+*/
+int Transformation::InverseInterpolation(double x, double y, double *VV, int *code)
+{
+    int C, L, i, n1, n2, n3, n4;
+    double dx, dy;
+    const std::vector<double> &InverseValues = Values->InverseValues;
+    const std::vector<int> &InverseCodes = Values->InverseCodes;
+
+    C = floor((x - WestBound)/WE_inc+EpsilonGrid);
+    L = floor((y - SouthBound)/SN_inc+EpsilonGrid);
+    if (C < 0 || C >= N_col-1 || L < 0 || L >= N_lines-1)
+        return 1;
+    n1 = L*N_col+C;
+    n2 = n1+N_col;
+    n3 = n1+1;
+    n4 = n2+1;
+    if (InverseCodes[n1] < 0 || InverseCodes[n2] < 0 || InverseCodes[n3] < 0 || InverseCodes[n4] < 0)
+        return 1;
+
+    dx = (x - WestBound)/WE_inc - C;
+    dy = (y - SouthBound)/SN_inc - L;
+    for (i=0;i<N_val;i++)
+        VV[i] = (1-dx)*(1-dy)*InverseValues[n1*N_val+i] + (1-dx)*dy*InverseValues[n2*N_val+i]
+              + dx*(1-dy)*InverseValues[n3*N_val+i] + dx*dy*InverseValues[n4*N_val+i];
+    if (dx < 0.5)
+        *code = (dy < 0.5) ? InverseCodes[n1] : InverseCodes[n2];
+    else
+        *code = (dy < 0.5) ? InverseCodes[n3] : InverseCodes[n4];
+    return 0;
+}
+
 /**
 * \brief Applies a Geodetic Transformation to a coordinate set.
 * \param[in] l1, p1, h1: input geographic coordinate set.
@@ -3518,11 +4006,8 @@ OPERATION_MESSAGE Transformation::ApplyGeodeticTransformation(double l1, double
 
 	if (itTsel->getLayout() == L_CONSTANT)
 	{
-		if (itTsel->getValuesNumber() == 3)
-            Transform3(itTsel->getOperationApplication(), itTsel->getInitValues(),
-                       itTsel->RateFactor, x1, y1, z1, x2, y2, z2);
-        else if (itTsel->getValuesNumber() == 7 || itTsel->getValuesNumber() == 14)
-			Transform7(itTsel->getOperationApplication(), itTsel->getInitValues(), x1, y1, z1, x2, y2, z2);
+		if (itTsel->getValuesNumber() == 3 || itTsel->getValuesNumber() == 7 || itTsel->getValuesNumber() == 14)
+            HelmertCart(itTsel->getHelmertMatrix(), x1, y1, z1, x2, y2, z2);
 		*precision_code = itTsel->getPrecisionCodeInit();
 		if (followUpTransfos == 1)
 		{
@@ -3533,8 +4018,8 @@ OPERATION_MESSAGE Transformation::ApplyGeodeticTransformation(double l1, double
         //plate motion model (source and target frames are the same): erase artifactual vertical shift
         if (itTsel->getIGNid().substr(0,3) == std::string("PMM"))
         {
-            CartGeo56(*x2, *y2, *z2, itTsel->At, itTsel->E2t, l2, p2, h2);
-            GeoCart(itTsel->At, itTsel->E2t, *l2, *p2, h1, x2, y2, z2);
+            CartGeo(itTsel->getTargetEllipsoidContext(), *x2, *y2, *z2, l2, p2, h2);
+            GeoCart(itTsel->getTargetEllipsoidContext(), *l2, *p2, h1, x2, y2, z2);
         }
     }
 	else
@@ -3549,13 +4034,22 @@ OPERATION_MESSAGE Transformation::ApplyGeodeticTransformation(double l1, double
 		{
 			if (itTsel->getOperationApplication() == OA_DIRECT)
 			{
+				if (itTsel->hasInverseGrid() && itTsel->InverseInterpolation(l1, p1, VV, precision_code) == 0)
+				{
+					RTS.assign(VV, VV + itTsel->N_val);
+					Transform3(OA_DIRECT, RTS, itTsel->RateFactor, x1, y1, z1, x2, y2, z2);
+				}
+				else if (itTsel->N_val >= 3)
+					code = SolveTargetFrameGrid(itTsel, x1, y1, z1, l2, p2, h2, x2, y2, z2, VV, precision_code);
+				else
+				{
 				//Begin with approximate (mean) transformation
 				RTS = itTsel->getInitValues();
 				do
 				{
                     Transform3(itTsel->getOperationApplication(), RTS,
                                itTsel->RateFactor, x1, y1, z1, x2, y2, z2);
-					CartGeo56(*x2, *y2, *z2, itTsel->At, itTsel->E2t, l2, p2, h2);
+					CartGeo(itTsel->getTargetEllipsoidContext(), *x2, *y2, *z2, l2, p2, h2);
 					//Maybe transform grid units in radians first of all to avoid these conversions
 					code = itTsel->Interpolate(MU_RADIAN, *l2, *p2, VV, precision_code);
 					done = true;
@@ -3564,10 +4058,11 @@ OPERATION_MESSAGE Transformation::ApplyGeodeticTransformation(double l1, double
 						done = true;
 					for (i = 0; i<itTsel->N_val; i++) RTS[i] = VV[i];
 				} while (!done);
+				}
 			}
 			else //Current coordinates are in the target CRS of the transformation.
 			{
-				CartGeo56(x1, y1, z1, itTsel->At, itTsel->E2t, &l1, &p1, &h1);
+				CartGeo(itTsel->getTargetEllipsoidContext(), x1, y1, z1, &l1, &p1, &h1);
 				//Maybe transform grid units in radians first of all to avoid these conversions
 				code = itTsel->Interpolate(MU_RADIAN, l1, p1, VV, precision_code);
 				RTS.reserve(itTsel->N_val);
@@ -3580,9 +4075,11 @@ OPERATION_MESSAGE Transformation::ApplyGeodeticTransformation(double l1, double
 			|| itTsel->getGridType() == GF_NTV2_BIN_B
 			|| itTsel->getGridType() == GF_NTV2_ASC)
 		{
-			code = itTsel->Interpolate(MU_RADIAN, l1, p1, VV, precision_code);
 			if (itTsel->getOperationApplication() != OA_DIRECT)
 				drctn = -1;
+			//The inverse grid holds the shift at the source point of (l1,p1)
+			if (drctn == 1 || !itTsel->hasInverseGrid() || itTsel->InverseInterpolation(l1, p1, VV, precision_code) != 0)
+				code = itTsel->Interpolate(MU_RADIAN, l1, p1, VV, precision_code);
 			*l2 = l1 - drctn*VV[1] * SEC2RAD;
 			*p2 = p1 + drctn*VV[0] * SEC2RAD;
 		}
@@ -3593,6 +4090,7 @@ OPERATION_MESSAGE Transformation::ApplyGeodeticTransformation(double l1, double
 				itTsel->FollowUp += asString(VV[i]) + " ";
             //itTsel->FollowUp += "\n";
 		}
+		free(VV);
 	}
 
 	if (code != 0)
@@ -3683,7 +4181,7 @@ OPERATION_MESSAGE Transformation::ApplyVerticalTransformation2(pt4d *pt, double
             // The node frame a and e2 were copied to the source frame by GeodeticSet::CompleteMetadata().
             *w2 = w1 + drctn*ShifTnTilT (itTsel->getInitValues()[0], itTsel->getInitValues()[1], itTsel->getInitValues()[2],
                                          itTsel->getInitValues()[3], itTsel->getInitValues()[4],
-                                         itTsel->getAf(), itTsel->getE2f(), pt->l, pt->p);
+                                         itTsel->getSourceEllipsoidContext(), pt->l, pt->p);
         *code = itTsel->getPrecisionCodeInit();
         if (followUpTransfos == 1)
             itTsel->FollowUp += asString(drctn*itTsel->getInitValues()[0]) + "\n";
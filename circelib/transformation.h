@@ -46,6 +46,7 @@ Author:
 #include <iterator>     // std::back_inserter
 #include <vector>       // std::vector
 #include <string>
+#include <memory>       // std::shared_ptr
 #include "operation.h"
 #include "units.h"
 #include "stringtools.h"
@@ -59,6 +60,46 @@ namespace circe
 const double EpsilonGrid = 1e-10;
 const int CALC_VERT_DEFL = 5000;
 
+/**
+* \brief Values of a grid loaded in memory. They are shared by the copies of a Transformation
+* (e.g. the copies made for the processing threads) and are not modified once loaded: a
+* Transformation writing into shared values first makes its own copy of them. The inverse grid
+* derived from them is kept alongside, so that it is derived once for all the copies.
+*/
+struct gridValues
+{
+	/**\brief Container for storing grid values as integers 2 bytes.*/
+	std::vector<short>	VecValI2;
+
+	/**\brief Container for storing grid values as integers 4 bytes.*/
+	std::vector<int> 	VecValI4;
+
+	/**\brief Container for storing grid values as floating points 4 bytes.*/
+	std::vector<float>	VecValR4;
+
+	/**\brief Container for storing grid values as double precision floating points 8 bytes.*/
+	std::vector<double>	VecValR8;
+
+	/**\brief Container for storing precision codes.*/
+	std::vector<int>	VecPrec;
+
+	/**\brief Inverse grid: true if InverseValues and InverseCodes have been derived (see Transformation::InitInverseGrid).*/
+	bool bInverseGrid = false;
+
+	/**\brief Inverse grid: application and rate factor of the transformation it has been derived for.*/
+	OPERATION_APPLICATION InverseApplication;
+	double InverseRateFactor;
+
+	/**\brief Inverse grid: N_val shifts per node, on the grid lattice taken in the frame the grid is applied from.*/
+	std::vector<double> InverseValues;
+
+	/**\brief Inverse grid: precision code of each node, -1 if the node could not be solved.*/
+	std::vector<int> InverseCodes;
+
+	/**\brief Inverse grid: maximum round-trip residual (meters) measured at the cell centers.*/
+	double InverseResidual = 0.;
+};
+
 #define TBCKEYW "GRID"
 #define VERSION_BIN 3 //tbc version
 
@@ -166,9 +207,11 @@ private:
     static void Transform3(OPERATION_APPLICATION oa, const std::vector<double>& t, const double &rate_factor, double  x1, double  y1, double  z1, double *x2, double *y2, double *z2);
 	static void InitSpline1D(const double *Y, const int n, double *R, double *Q);
 	static double Spline1D(double X, const double *Y, const int n, double *R);
+	static double Spline1DDerivative(double X, const double *Y, const int n, double *R);
 	static std::vector<Transformation>::iterator SelectTransfo(double l, double p, std::vector<Transformation>& vTransfo);
 	static bool checkPrecisionCodeDefinition(int CodePrecision);
 	static void setDoubleVector(std::string _value, std::vector<double>* doubleVector, int count);
+	static int SolveTargetFrameGrid(std::vector<Transformation>::iterator itT, double x1, double y1, double z1, double *l2, double *p2, double *h2, double *x2, double *y2, double *z2, double *VV, int *precision_code);
 
 public:
     static void ConversionCode2Precision(int CodePrecision, double phi, double *pL, double *pP, double a, double e2);
@@ -193,20 +236,8 @@ private:
 	/**\brief  INTERNAL DATA: Header size in bytes.*/
 	int	Offset; 
 
-	/**\brief  INTERNAL DATA: Container for storing grid values as integers 2 bytes.*/
-	std::vector<short>	VecValI2;
-
-	/**\brief  INTERNAL DATA: Container for storing grid values as integers 4 bytes.*/
-	std::vector<int> 	VecValI4;
-
-	/**\brief  INTERNAL DATA: Container for storing grid values as floating points 4 bytes.*/
-	std::vector<float>	VecValR4;
-
-	/**\brief  INTERNAL DATA: Container for storing grid values as double precision floating points 8 bytes.*/
-	std::vector<double>	VecValR8;
-
-	/**\brief  INTERNAL DATA: Container for storing precision codes.*/
-	std::vector<int>	VecPrec;
+	/**\brief  INTERNAL DATA: Grid values loaded in memory (LD_ARRAY), shared with the copies of this instance.*/
+	std::shared_ptr<gridValues> Values;
 
 	/**\brief  INTERNAL DATA: Loading type.*/
 	LOADING_TYPE LoadingType;
@@ -214,6 +245,21 @@ private:
 	/**\brief  INTERNAL DATA: Contains the values of the transformations actually used to perform an operation.*/
 	std::string FollowUp;
 
+	/**\brief  INTERNAL DATA: F_TARGET inverse solver warm start: true if LastShift, LastGradient and LastX are valid.*/
+	bool bLastShift;
+
+	/**\brief  INTERNAL DATA: F_TARGET inverse solver warm start: converged shift of the previous point.*/
+	std::vector<double> LastShift;
+
+	/**\brief  INTERNAL DATA: F_TARGET inverse solver warm start: gradient of the shift wrt geocentric coordinates (3x3, row-major) at the previous point.*/
+	double LastGradient[9];
+
+	/**\brief  INTERNAL DATA: F_TARGET inverse solver warm start: source geocentric coordinates of the previous point.*/
+	double LastX[3];
+
+	/**\brief  INTERNAL DATA: F_TARGET inverse solver: IterationHistogram[n] is the number of points solved with n grid interpolations.*/
+	std::vector<unsigned int> IterationHistogram;
+
 	/**\brief  INTERNAL DATA: Encoding type.*/
 	ENCODING_TYPE	Encoding;
 
@@ -222,6 +268,12 @@ public:
 	ENCODING_TYPE getEncoding() const { return Encoding; }
     LOADING_TYPE getLoadingType() const {return LoadingType;}
 	std::string	getFollowUp() const { return FollowUp; }
+    std::vector<unsigned int> getIterationHistogram() const { return IterationHistogram; }
+    void resetIterationHistogram() { IterationHistogram.clear(); bLastShift = false; }
+    void resetWarmStart() { bLastShift = false; }
+    bool hasInverseGrid() const { return Values->bInverseGrid && Values->InverseApplication == getOperationApplication()
+                                         && Values->InverseRateFactor == RateFactor; }
+    double getInverseResidual() const { return hasInverseGrid() ? Values->InverseResidual : 0.; }
 
     void setEncoding(std::string _value){if(_value=="")return; Encoding=(ENCODING_TYPE)getIndex(_value,EncodingTypeText,ET_COUNT);}
     void setLoadingType(std::string _value){if(_value=="")return; LoadingType=(LOADING_TYPE)getIndex(_value,LoadingTypeText,LD_COUNT);}
@@ -299,6 +351,9 @@ private:
 	/**\brief  GRID NODE DATA: Node and increment unit*/
 	MEASURE_UNIT NodeIncCoordUnit;
 
+	/**\brief  GRID NODE DATA: Conversion from the unit of the interpolated coordinates to NodeIncCoordUnit, resolved at the first call of Interpolate.*/
+	unitConversion InterpolationUnitConversion;
+
 	/**\brief  GRID NODE DATA: Increment unit (if different from NodeIncCoordUnit, will be converted into NodeIncCoordUnit at grid loading)*/
 	MEASURE_UNIT IncCoordUnit;
 
@@ -386,6 +441,15 @@ private:
     /**\brief  VALUE DATA: Rate factor to multiply values.*/
     double RateFactor;
 
+    /**\brief  VALUE DATA: Constant transformation as a geocentric matrix (see InitHelmertMatrix).*/
+    double HelmertMatrix[12];
+
+    /**\brief  VALUE DATA: true if HelmertMatrix is up to date with the values and HelmertOA.*/
+    bool bHelmertMatrixOK;
+
+    /**\brief  VALUE DATA: Operation application of HelmertMatrix.*/
+    OPERATION_APPLICATION HelmertOA;
+
 	/**\brief  VALUE DATA: Minimum value of the grid parameters (may be usefull if N_val == 1)*/
 	double	MinValue;
 
@@ -407,7 +471,7 @@ private:
 	// Value data getters & setters 
 public:
 	CRS_TYPE getCRStype() const { return crs_type; }
-    std::vector<double> getInitValues() const{return InitValues;}
+    const std::vector<double>& getInitValues() const{return InitValues;}
     double getEpoch() const{return Epoch;}
     int getPrecisionCodeInit() const{return PrecisionCodeInit;}
     int getbPixelCenter() const{return bPixelCenter;}
@@ -429,10 +493,12 @@ public:
     int getInterpolationOrder() const{return InterpolationOrder;}
 
     void ConvertParameters();
+    void InitHelmertMatrix();
+    const double* getHelmertMatrix();
     void setCrsType(std::string _value){if(_value=="")return; crs_type=(CRS_TYPE)getIndex(_value,CRStypeAttributeText,CT_COUNT);}
     void setEpoch(std::string _value) {if(_value=="")return; Epoch=atof(_value.data());}
     void setEpoch(double _value){if(_value==0)return; Epoch=_value;}
-    void setInitValues(std::string _value) {if(_value=="")return; setDoubleVector(_value,&InitValues,N_val); ConvertParameters();}
+    void setInitValues(std::string _value) {if(_value=="")return; setDoubleVector(_value,&InitValues,N_val); ConvertParameters(); bHelmertMatrixOK=false;}
     void setPrecisionCodeInit(std::string _value){if(_value=="")return; PrecisionCodeInit=atoi(_value.data());}
     void setbPixelCenter(std::string _value){if(_value=="")return; bPixelCenter=(VALUES_LOCATION)getIndex(_value,ValuesLocationText,2);}
     void setbDelimiter(std::string _value){if(_value=="")return; bDelimiter=(CIRCE_BOOL)getIndex(_value,BoolText,2);}
@@ -444,7 +510,7 @@ public:
     void setUnknownValue(std::string _value){if(_value=="")return; UnknownValue=atof(_value.data());}
     void setbUnknownValue2zero(std::string _value){if(_value=="")return; bUnknownValue2zero=(CIRCE_BOOL)getIndex(_value,BoolText,2);}
     void setTranslation(std::string _value) {if(_value=="")return; setDoubleVector(_value,&Translation,N_val);}
-    void setRateFactor(std::string _value){if(_value=="")return; RateFactor=atof(_value.data());}
+    void setRateFactor(std::string _value){if(_value=="")return; RateFactor=atof(_value.data()); bHelmertMatrixOK=false;}
     void setMinValue(std::string _value){if(_value=="")return; MinValue=atof(_value.data());}
     void setMaxValue(std::string _value){if(_value=="")return; MaxValue=atof(_value.data());}
     void setMeanValue(std::string _value){if(_value=="")return; MeanValue=atof(_value.data());}
@@ -475,6 +541,9 @@ private:
     /**\brief  GEODETIC FRAME DATA: Source frame epoch.*/
     double  EpochF;
 
+    /**\brief  GEODETIC FRAME DATA: Constants derived from Af and E2f (see getSourceEllipsoidContext).*/
+    ellipsoidContext ECf;
+
     /**\brief  GEODETIC FRAME DATA: Semi-major axis of the ellipsoid (m) associated with the target frame.*/
 	double  At;
 
@@ -487,6 +556,9 @@ private:
     /**\brief  GEODETIC FRAME DATA: Target frame epoch.*/
     double  EpochT;
 
+    /**\brief  GEODETIC FRAME DATA: Constants derived from At and E2t (see getTargetEllipsoidContext).*/
+    ellipsoidContext ECt;
+
 	/**\brief  GEODETIC FRAME DATA: Node frame info.*/
 	NODE_FRAME_INFO NodeFrameInfo;
 
@@ -504,6 +576,8 @@ public:
     double getBt() const{return Bt;}
     double getE2t() const{return E2t;}
     double getEpochT() const{return EpochT;}
+    const ellipsoidContext& getSourceEllipsoidContext();
+    const ellipsoidContext& getTargetEllipsoidContext();
     void GetApplicationFrameEpochs(double *epF, double *epT);
 
     void setSourceFrameId(std::string _value) {if(_value=="")return; SourceFrameId=_value;}
@@ -588,8 +662,10 @@ private:
     void Element(int i, int j, double *VV, int *precision_code);
 
     int WriteHeaderTBC();
-    int BilinearInterpolation (double x, double y, double *VV, int *code);
-    int SplineInterpolation(int window_size, double x, double y, double *VV, int *code);
+    int BilinearInterpolation (double x, double y, double *VV, int *code, double *dVV=NULL);
+    int SplineInterpolation(int window_size, double x, double y, double *VV, int *code, double *dVV=NULL);
+    int InverseInterpolation(double x, double y, double *VV, int *code);
+    int SolveInverseNode(double l, double p, double *VV, int *code);
     void ReadHeaderESRI();
     void ReadHeaderTBC();
     void ReadHeaderDIS();
@@ -602,6 +678,7 @@ private:
     void ReadHeaderTAC();
     void ReadHeaderSurfer();
     int NodePosition(int i, int j) const;
+    gridValues* WritableValues();
 
 public:
     std::string DisplayMetaData();
@@ -614,9 +691,13 @@ public:
     int InitAccesElement(bool bSystemBinary);
     int InitVector(int taille);
     std::string ModifyAndValidateMetaData(bool bModify);
-    int Interpolate (MEASURE_UNIT unite_ini, double l, double p, double *VV, int *code);
+    int Interpolate (MEASURE_UNIT unite_ini, double l, double p, double *VV, int *code, double *dVV=NULL);
+    bool IsInverseGridUseful();
+    int InitInverseGrid();
     void toEpoch(double ep);
 	void toEpoch(double ep, const double values[7]);
+    void getEpochParameters(std::vector<double> *values) const;
+    const double* setEpochParameters(const double *values);
 
 };
 
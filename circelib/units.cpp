@@ -46,8 +46,8 @@ Author:
 #include <cstdlib>//testUnits //rand
 #include <locale>  // std::locale, std::isdigit
 //#include <ctype.h>//isdigit
-#include <cstdio> //remove
-#include <regex>
+#include <cstdio> //remove, snprintf
+#include <cstring> //memmove
 
 namespace circe
 {
@@ -381,6 +381,119 @@ double UnitConvert(double v, MEASURE_UNIT u1, MEASURE_UNIT u2)
     return v;
 }
 
+/**
+* \brief Gets the factor from a unit to decimal degrees, as applied by UnitConvert.
+* \return false if the unit is not converted by a single factor.
+*/
+static bool factorToDegree(MEASURE_UNIT u, double *f)
+{
+    switch (u)
+    {
+    case MU_SECOND: *f = 1/3600.; return true;
+    case MU_DEGREE: *f = 1.; return true;
+    case MU_RADIAN: *f = RAD2DEG; return true;
+    case MU_GON: *f = 0.9; return true;
+    case MU_DEGPERMY: *f = 1e-6; return true;
+    case MU_MASPERY: *f = 1/3600000.; return true;
+    default: return false;
+    }
+}
+
+/**
+* \brief Gets the factor from decimal degrees to a unit, as applied by UnitConvert.
+* \return false if the unit is not converted by a single factor.
+*/
+static bool factorFromDegree(MEASURE_UNIT u, double *f)
+{
+    switch (u)
+    {
+    case MU_SECOND: *f = 3600.; return true;
+    case MU_DEGREE: *f = 1.; return true;
+    case MU_RADIAN: *f = DEG2RAD; return true;
+    case MU_GON: *f = 1/0.9; return true;
+    case MU_DEGPERMY: *f = 1e6; return true;
+    case MU_MASPERY: *f = 3600000.; return true;
+    default: return false;
+    }
+}
+
+/**
+* \brief Resolves a conversion from a unit to another, so that UnitConvert(v, uc) applies a single
+* multiplication between the units that differ by a factor, and a single sexagesimal conversion
+* between DMS or DM and such a unit.
+* \param[in] u1: the MEASURE_UNIT code for input unit.
+* \param[in] u2: the MEASURE_UNIT code for output unit.
+* \param[out] uc: a pointer to a unitConversion instance.
+* \remark The results are those of UnitConvert(v, u1, u2) between radians and degrees, and within two
+* units in the last place otherwise (the divisions being replaced by multiplications, and two factors
+* merged into one). The conversions that cannot be resolved (DMS to DM, unimplemented units) fall
+* back to UnitConvert(v, u1, u2).
+*/
+void InitUnitConversion(MEASURE_UNIT u1, MEASURE_UNIT u2, unitConversion *uc)
+{
+    double f1, f2;
+    bool b1 = factorToDegree(u1, &f1), b2 = factorFromDegree(u2, &f2);
+    uc->u1 = u1;
+    uc->u2 = u2;
+    uc->factor = 1.;
+    if (u1==u2 || u1==MU_METER || u2==MU_METER)
+        uc->path = UCP_IDENTITY;
+    else if (b1 && b2)
+    {
+        uc->path = UCP_FACTOR;
+        uc->factor = f1*f2;
+    }
+    else if (u1==MU_DMS && b2)
+    {
+        uc->path = UCP_FROM_DMS;
+        uc->factor = f2;
+    }
+    else if (u1==MU_DM && b2)
+    {
+        uc->path = UCP_FROM_DM;
+        uc->factor = f2;
+    }
+    else if (b1 && u2==MU_DMS)
+    {
+        uc->path = UCP_TO_DMS;
+        uc->factor = f1;
+    }
+    else if (b1 && u2==MU_DM)
+    {
+        uc->path = UCP_TO_DM;
+        uc->factor = f1;
+    }
+    else
+        uc->path = UCP_GENERIC;
+}
+
+/**
+* \brief Converts n values from a unit to another, the conversion being resolved beforehand.
+* \param[in] n: the number of values.
+* \param[in] v: the values.
+* \param[out] w: the converted values (may be v).
+* \param[in] uc: a unitConversion instance initialized by InitUnitConversion.
+*/
+void UnitConvertMany(unsigned int n, const double *v, double *w, const unitConversion &uc)
+{
+    unsigned int i;
+    if (uc.path == UCP_FACTOR)
+    {
+        double f = uc.factor;
+        for (i=0; i<n; i++)
+            w[i] = v[i]*f;
+    }
+    else if (uc.path == UCP_IDENTITY)
+    {
+        if (w != v)
+            for (i=0; i<n; i++)
+                w[i] = v[i];
+    }
+    else
+        for (i=0; i<n; i++)
+            w[i] = UnitConvert(v[i], uc);
+}
+
 void test_deci_sexadms(std::ofstream *fo, double doudou1)
 {
     double doudou2 = deci_to_sexadms(doudou1);
@@ -414,6 +527,193 @@ void testUnits(std::string filout)
     fo.close();
 }
 
+/**
+* \brief Compares UnitConvertMany with UnitConvert(v, u1, u2) for all pairs of angular units over
+* [-180, 180] degrees, and writes the largest difference of each pair in a file.
+* \param[in] filout: The output file path.
+* \remark The differences are measured in degrees, so that a sexagesimal value rounded up (48.5159999...
+* instead of 48.52) is not a failure.
+*/
+void testUnitConvertMany(std::string filout)
+{
+    const MEASURE_UNIT units[] = {MU_RADIAN, MU_SECOND, MU_DEGREE, MU_DMS, MU_DM, MU_GON,
+                                  MU_METER, MU_DEGPERMY, MU_MASPERY};
+    const unsigned int nu = sizeof(units)/sizeof(units[0]), n = 36001;
+    std::ofstream fo(filout.data());
+    fo << std::setprecision(3);
+    std::vector<double> v(n), w(n);
+    unsigned int nFail = 0;
+    for (unsigned int i1=0; i1<nu; i1++)
+    for (unsigned int i2=0; i2<nu; i2++)
+    {
+        MEASURE_UNIT u1 = units[i1], u2 = units[i2];
+        MEASURE_UNIT ud = u2==MU_METER ? u1 : u2;
+        unitConversion uc;
+        InitUnitConversion(u1, u2, &uc);
+        for (unsigned int i=0; i<n; i++)
+            v[i] = w[i] = UnitConvert(-180.+i/100., MU_DEGREE, u1);
+        UnitConvertMany(n, w.data(), w.data(), uc);
+        double dMax = 0.;
+        for (unsigned int i=0; i<n; i++)
+        {
+            double ref = UnitConvert(v[i], u1, u2);
+            double d = fabs(UnitConvert(w[i], ud, MU_DEGREE)-UnitConvert(ref, ud, MU_DEGREE));
+            if (!(d <= dMax)) dMax = std::isnan(d) ? HUGE_VAL : d;
+        }
+        bool ok = dMax < 1e-11;
+        if (!ok) nFail++;
+        fo << (ok ? "OK   " : "FAIL ") << int(u1) << " -> " << int(u2) << ": " << dMax << " degree" << std::endl;
+    }
+    fo << nFail << " failure(s)" << std::endl;
+    fo.close();
+}
+
+/**
+* \brief A case of testReadDMS: an input of readDMS and the expected result.
+*/
+struct readDMSCase
+{
+    const char *str, *what;
+    bool accepted;
+    double value;
+};
+
+static const readDMSCase readDMSCases[] = {
+    {"-55.4409977", "longitude DMS", true, -55.4409977},
+    {"055\xC2\xB0" "44'09.97\" W", "longitude DMS", true, -55.440997},
+    {"-055\xC2\xB0" "44'09.97\"", "longitude DMS", true, -55.440997},
+    {"W 055\xC2\xB0" "44'09.97\"", "longitude DMS", true, -55.440997},
+    {"055 44 09.97 W", "longitude DMS", true, -55.440997},
+    {"-055 44 09.97", "longitude DMS", true, -55.440997},
+    {"W 055 44 09.97", "longitude DMS", true, -55.440997},
+    {"  055 44 09.97 E ", "longitude DMS", true, 55.440997},
+    {"48\xC2\xB0" "51'", "latitude DMS", true, 48.51},
+    {"48 51 N", "latitude DMS", true, 48.51},
+    {"48 51 S", "latitude DMS", true, -48.51},
+    {"48\xC2\xB0", "latitude DMS", true, 48.},
+    {"48\xC2\xB0" "51.5'", "latitude DM", true, 48.515},
+    {"48 51.5 S", "latitude DM", true, -48.515},
+    {"48.515", "latitude DM", true, 48.515},
+    {"", "longitude DMS", false, 0.},
+    {" ", "longitude DMS", false, 0.},
+    {"W", "longitude DMS", false, 0.},
+    {"12a", "longitude DMS", false, 0.},
+    {"055\xC2\xB0" "44'09.97\" N", "longitude DMS", false, 0.},
+    {"48 51 09.97 E", "latitude DMS", false, 0.},
+    {"55\xC2\xB0" "61'", "longitude DMS", false, 0.},
+    {"55 44 60", "longitude DMS", false, 0.},
+    {"55.61", "longitude DMS", false, 0.},
+    {"55 44.5 09", "longitude DMS", false, 0.},
+    {"48 51 09.97", "latitude DM", false, 0.},
+    {"48 60.5", "latitude DM", false, 0.},
+    {"48''51", "latitude DMS", false, 0.}
+};
+
+void testReadDMS(std::string filout)
+{
+    std::ofstream fo(filout.data());
+    fo << std::setprecision(10);
+    unsigned int nFail = 0;
+    for (unsigned int i=0; i<sizeof(readDMSCases)/sizeof(readDMSCases[0]); i++)
+    {
+        const readDMSCase& c = readDMSCases[i];
+        bool accepted = true;
+        double value = 0.;
+        try
+        {
+            value = readDMS(c.str, c.what, true);
+        }
+        catch (std::string)
+        {
+            accepted = false;
+        }
+        bool ok = (accepted == c.accepted) && (!accepted || fabs(value-c.value) < 1e-9);
+        if (!ok) nFail++;
+        fo << (ok ? "OK   " : "FAIL ") << c.what << " [" << c.str << "] ";
+        if (accepted)
+            fo << value;
+        else
+            fo << "rejected";
+        fo << std::endl;
+    }
+    fo << nFail << " failure(s)" << std::endl;
+    fo.close();
+}
+
+/**
+* \brief Tells whether a character is a sign symbol of a DMS or DM value.
+* \param[in] c: The character.
+* \param[in] sign_lst: The valid sign symbols.
+* \return true if c is in sign_lst.
+*/
+static bool isDMSsign(char c, const char *sign_lst)
+{
+    return c != 0 && strchr(sign_lst, c) != NULL;
+}
+
+/**
+* \brief Tells whether a character separates the numerical values of a DMS or DM value
+(one of the bytes of the UTF-8 degree sign, quotes, space or letter).
+* \param[in] c: The character.
+* \return true if c is a separator.
+*/
+static bool isDMSseparator(char c)
+{
+    return c == '\xC2' || c == '\xB0' || c == '\'' || c == '"' || c == ' '
+            || (c >= 'A' && c <= 'Z') || (c >= 'a' && c <= 'z');
+}
+
+/**
+* \brief Tells whether a character belongs to a class of the grammar of DMS and DM values.
+* \param[in] c: The character.
+* \param[in] cls: 'd' digit, '.' digit or point, 'o' degree sign byte or space, '\'' minute sign
+or space, '"' second sign or space.
+* \return true if c belongs to the class.
+*/
+static bool isDMSclass(char c, char cls)
+{
+    switch (cls)
+    {
+    case 'd':
+        return c >= '0' && c <= '9';
+    case '.':
+        return (c >= '0' && c <= '9') || c == '.';
+    case 'o':
+        return c == '\xC2' || c == '\xB0' || c == ' ';
+    case '\'':
+        return c == '\'' || c == ' ';
+    case '"':
+        return c == '"' || c == ' ';
+    default:
+        return false;
+    }
+}
+
+/**
+* \brief Matches a part of a std::string with a sequence of character classes.
+* \param[in] str: The std::string.
+* \param[in] b, e: The bounds of the part of str.
+* \param[in] pattern: The sequence, as pairs of a class (see isDMSclass) and a quantifier ('+' or '*').
+* \return true if the whole part matches.
+* \remark Each class is matched greedily, without backtracking: a class that shares characters
+with the next one takes them all. The space belongs to the 'o', '\'' and '"' classes, and to
+the sign symbols stripped by readDMS, but the patterns of readDMS never put two of these
+classes one after the other, and their last class is optional, so that the trailing spaces
+stripped with the sign symbols are never needed by a match.
+*/
+static bool matchDMS(const std::string& str, size_t b, size_t e, const char *pattern)
+{
+    for (const char *p=pattern; *p; p+=2)
+    {
+        size_t i = b;
+        while (b < e && isDMSclass(str[b], p[0]))
+            b++;
+        if (p[1] == '+' && b == i)
+            return false;
+    }
+    return b == e;
+}
+
 /**
 * \brief Converts a std::string in a sexagesimal value in decimal format.
 * \param[in] str A std::string.
@@ -431,7 +731,7 @@ void testUnits(std::string filout)
 *- W 055 44 09.97
 *- etc.
 */
-double readDMS(std::string str, std::string what, bool bValid)
+double readDMS(const std::string& str, const std::string& what, bool bValid)
 {
     double coord_as_double = 0.;
     DMS dms;
@@ -439,8 +739,8 @@ double readDMS(std::string str, std::string what, bool bValid)
     dms.neg = dm.neg = false;
     dms.deg = dms.min = dm.deg = 0;
     dms.sec = dm.min = 0.;
-    std::locale loc;
-    std::string sign_lst="";
+    const char *sign_lst = NULL;
+    size_t b = 0, e = str.size();
 
     // What is it about
 
@@ -449,33 +749,30 @@ double readDMS(std::string str, std::string what, bool bValid)
     bool bDMS = (what.find("DMS") != std::string::npos);
     bool bDM = ((what.find("DM") != std::string::npos) && !bDMS);
 
-    // Regular expressions corresponding to valid DMS or DM values
-
     // Valid sign symbols that may be written at the beginning or the end of
     // the input string (and even at both ends !- should be avoided).
     if (bLongitude)
-        sign_lst = "([-+WwEe ]+)?";
+        sign_lst = "-+WwEe ";
     else if (bLatitude)
-        sign_lst = "([-+NnSs ]+)?";
+        sign_lst = "-+NnSs ";
+    if (sign_lst != NULL)
+    {
+        while (b < e && isDMSsign(str[b], sign_lst))
+            b++;
+        while (e > b && isDMSsign(str[e-1], sign_lst))
+            e--;
+    }
 
+    // Does input string fit to a valid DMS or DM value ?
     // DMS: Degrees (int), minutes (int), seconds (real) separated by spaces or symbols
-    std::regex str_expr_dms_3 (sign_lst+"[0-9]+[° ]+[0-9]+[' ]+[0-9.]+([\" ]+)?"+sign_lst);
-
     // DMS: Degrees (int), minutes (int) (without seconds) separated by spaces or symbols
-    std::regex str_expr_dms_2 (sign_lst+"[0-9]+[° ]+[0-9]+([' ]+)?"+sign_lst);
-
     // DM: Degrees (int), minutes (real) separated by spaces or symbols
-    std::regex str_expr_dm_2  (sign_lst+"[0-9]+[° ]+[0-9.]+([' ]+)?"+sign_lst);
-
     // DMS or DM: Sexagesimal value in decimal format.
-    std::regex str_expr_dm_s_1 (sign_lst+"[0-9.]+([° ]+)?"+sign_lst);
-
-    // Does input string fit to a regex ?
 
-    if  ( !( (bDMS && regex_match (str,str_expr_dms_3))
-          || (bDMS && regex_match (str,str_expr_dms_2))
-          || (bDM  && regex_match (str,str_expr_dm_2))
-          || (regex_match (str,str_expr_dm_s_1)) ))
+    if  ( !( (bDMS && matchDMS(str, b, e, "d+o+d+'+.+\"*"))
+          || (bDMS && matchDMS(str, b, e, "d+o+d+'*"))
+          || (bDM  && matchDMS(str, b, e, "d+o+.+'*"))
+          || (matchDMS(str, b, e, ".+o*")) ))
     {
         if (bValid)
             throw std::string(ArgumentValidationText[AV_BAD_DMS_VALUE]+" : "+str);
@@ -483,18 +780,23 @@ double readDMS(std::string str, std::string what, bool bValid)
             return 0.;
     }
 
-    // Copy numerical values (separated by spaces or symbols) into a vector.
+    // Copy numerical values (separated by spaces, symbols or letters) into vec.
 
-    const std::regex coord_sep("[°'\" A-Za-z]+");
-    std::sregex_token_iterator it ( str.begin(), str.end(), coord_sep, -1 );
-    std::sregex_token_iterator itend;
-    std::vector<std::string> vec(it, itend);
-    if (vec[0]=="") // if the input string begins with a space
-        vec.erase(vec.begin());
+    std::string vec[3];
+    unsigned int nv = 0;
+    for (size_t i=0, j; i<str.size(); i=j)
+    {
+        while (i < str.size() && isDMSseparator(str[i]))
+            i++;
+        for (j=i; j<str.size() && !isDMSseparator(str[j]); j++)
+            ;
+        if (j > i && nv++ < 3)
+            vec[nv-1].assign(str, i, j-i);
+    }
 
     // Convert values into sexagesimal value in decimal format.
 
-    if (vec.size()==1)
+    if (nv==1)
     {
         // DMS or DM: Already in decimal format.
         coord_as_double = atof(vec[0].data());
@@ -520,15 +822,15 @@ double readDMS(std::string str, std::string what, bool bValid)
     {
         if (bDMS)
         {
-            if (vec.size()>0)
+            if (nv>0)
             {
                 dms.deg = atoi(vec[0].data());
                 dms.neg = (dms.deg<0);
                 if (dms.neg) dms.deg = -dms.deg;
             }
-            if (vec.size()>1)
+            if (nv>1)
                 dms.min = atoi(vec[1].data());
-            if (vec.size()>2)
+            if (nv>2)
                 dms.sec = atof(vec[2].data());
             if (str.find_first_of("SsWw") != std::string::npos)
                 dms.neg = true;
@@ -538,13 +840,13 @@ double readDMS(std::string str, std::string what, bool bValid)
         }
         else if (bDM)
         {
-            if (vec.size()>0)
+            if (nv>0)
             {
                 dm.deg = atoi(vec[0].data());
                 dm.neg = (dm.deg<0);
                 if (dm.neg) dm.deg = -dm.deg;
             }
-            if (vec.size()>1)
+            if (nv>1)
                 dm.min = atof(vec[1].data());
             if (str.find_first_of("SsWw") != std::string::npos)
                 dm.neg = true;
@@ -573,35 +875,68 @@ void test_decimal_separator()
 }
 
 /**
-* \brief Writes a sexagesimal double value in a human-readable form.
+* \brief Adds the sign of a sexagesimal value written by writeDMS or writeDM.
+* \param aff: the character buffer, the value being written from aff+2.
+* \param[in] n: the number of characters of the value.
+* \param[in] neg: true if the value is negative.
+* \param[in] type: "lat", "lon" or "rot".
+* \return: The number of characters of the signed value, starting from aff.
+*/
+static unsigned int signDMS(char *aff, int n, bool neg, const std::string& type)
+{
+    if (n < 0 || n >= DMS_BUFFER_SIZE-4)
+        return 0;
+    if (type=="rot")
+    {
+        aff[0] = (neg ? '-' : ' ');
+        aff[1] = ' ';
+        return n+2;
+    }
+    if (type=="lat")
+        aff[n+2] = (neg ? 'S' : 'N');
+    else if (type=="lon")
+        aff[n+2] = (neg ? 'W' : 'E');
+    else
+        return 0;
+    aff[n+3] = ' ';
+    memmove(aff, aff+2, n+2);
+    return n+2;
+}
+
+/**
+* \brief Writes a sexagesimal double value in a human-readable form into a character buffer.
+* \param[out] aff: the character buffer (DMS_BUFFER_SIZE characters).
 * \param[in] aa: a sexagesimal value in decimal format (DD.MMSSSSSSSS).
-* \return: The value in a human-readable form (...°...'...").
+* \param[in] type: "lat", "lon" or "rot".
+* \param[in] n_ang: the number of decimal digits of the value in decimal format.
+* \param[in] plainDMS: false to write the value in decimal format.
+* \return: The number of characters written in aff (...°...'...").
 */
-std::string writeDMS (double aa, std::string type, unsigned int n_ang, bool plainDMS)
+unsigned int writeDMS (char *aff, double aa, const std::string& type, unsigned int n_ang, bool plainDMS)
 {
     DMS dms;
-    char aff[20], frmt_sec[20], frmt[20];
+    char frmt_sec[20], frmt[40], *s = aff+2;
+    int n = 0;
 
     double_to_dms((long double)(aa), &dms, n_ang);
 
     if (!plainDMS)
     {
-        std::ostringstream ss;
-        ss << std::setprecision(n_ang) << std::fixed << dms_to_double(&dms);
-        return ss.str();
+        n = snprintf(aff, DMS_BUFFER_SIZE, "%.*Lf", n_ang, dms_to_double(&dms));
+        return (n < 0 || n >= DMS_BUFFER_SIZE) ? 0 : n;
     }
 
     if (n_ang == 0)
     {
-        if      (type=="lat") sprintf(aff,"%02d°",dms.deg);
-        else if (type=="lon") sprintf(aff,"%03d°",dms.deg);
-        else if (type=="rot") sprintf(aff,"%03d ",dms.deg);
+        if      (type=="lat") n = snprintf(s, DMS_BUFFER_SIZE-4, "%02d°",dms.deg);
+        else if (type=="lon") n = snprintf(s, DMS_BUFFER_SIZE-4, "%03d°",dms.deg);
+        else if (type=="rot") n = snprintf(s, DMS_BUFFER_SIZE-4, "%03d ",dms.deg);
     }
     else if (n_ang < 3)
     {
-        if      (type=="lat") sprintf(aff,"%02d°%02d'",dms.deg, dms.min);
-        else if (type=="lon") sprintf(aff,"%03d°%02d'",dms.deg, dms.min);
-        else if (type=="rot") sprintf(aff,"%03d %02d ",dms.deg, dms.min);
+        if      (type=="lat") n = snprintf(s, DMS_BUFFER_SIZE-4, "%02d°%02d'",dms.deg, dms.min);
+        else if (type=="lon") n = snprintf(s, DMS_BUFFER_SIZE-4, "%03d°%02d'",dms.deg, dms.min);
+        else if (type=="rot") n = snprintf(s, DMS_BUFFER_SIZE-4, "%03d %02d ",dms.deg, dms.min);
     }
     else
     {
@@ -614,51 +949,58 @@ std::string writeDMS (double aa, std::string type, unsigned int n_ang, bool plai
         if      (type=="lat") sprintf(frmt,"%s%s%s","%02d°%02d'",frmt_sec,"\"");
         else if (type=="lon") sprintf(frmt,"%s%s%s","%03d°%02d'",frmt_sec,"\"");
         else if (type=="rot") sprintf(frmt,"%s%s","%03d %02d ",frmt_sec);
-        sprintf(aff,frmt,dms.deg, dms.min, dms.sec);
+        else return 0;
+        n = snprintf(s, DMS_BUFFER_SIZE-4, frmt, dms.deg, dms.min, dms.sec);
     }
-
-    std::string ret=aff;
-    if      ( dms.neg && type=="lat") return ret+"S ";
-    else if (!dms.neg && type=="lat") return ret+"N ";
-    else if ( dms.neg && type=="lon") return ret+"W ";
-    else if (!dms.neg && type=="lon") return ret+"E ";
-    else if ( dms.neg && type=="rot") return "- "+ret;
-    else if (!dms.neg && type=="rot") return "  "+ret;
-    return "";
+    return signDMS(aff, n, dms.neg, type);
 }
 
-
 /**
 * \brief Writes a sexagesimal double value in a human-readable form.
+* \param[in] aa: a sexagesimal value in decimal format (DD.MMSSSSSSSS).
+* \return: The value in a human-readable form (...°...'...").
+*/
+std::string writeDMS (double aa, std::string type, unsigned int n_ang, bool plainDMS)
+{
+    char aff[DMS_BUFFER_SIZE];
+    return std::string(aff, writeDMS(aff, aa, type, n_ang, plainDMS));
+}
+
+/**
+* \brief Writes a sexagesimal double value in a human-readable form into a character buffer.
+* \param[out] aff: the character buffer (DMS_BUFFER_SIZE characters).
 * \param[in] aa: a sexagesimal value in decimal format (DD.MMMMMMMMM).
-* \return: The value in a human-readable form (...°...').
+* \param[in] type: "lat", "lon" or "rot".
+* \param[in] n_ang: the number of decimal digits of the value in decimal format.
+* \param[in] plainDMS: false to write the value in decimal format.
+* \return: The number of characters written in aff (...°...').
 */
-std::string writeDM (double aa, std::string type, unsigned int n_ang, bool plainDMS)
+unsigned int writeDM (char *aff, double aa, const std::string& type, unsigned int n_ang, bool plainDMS)
 {
     DM dm;
-    char aff[20], frmt_min[20], frmt[20];
+    char frmt_min[20], frmt[40], *s = aff+2;
+    int n = 0;
 
     //double_to_dm((long double)(aa), &dm, n_ang);
     double_to_dm((long double)(aa), &dm);
 
     if (!plainDMS)
     {
-        std::ostringstream ss;
-        ss << std::setprecision(n_ang) << std::fixed << dm_to_double(&dm);
-        return ss.str();
+        n = snprintf(aff, DMS_BUFFER_SIZE, "%.*Lf", n_ang, dm_to_double(&dm));
+        return (n < 0 || n >= DMS_BUFFER_SIZE) ? 0 : n;
     }
 
     if (n_ang == 0)
     {
-        if      (type=="lat") sprintf(aff,"%02d°",dm.deg);
-        else if (type=="lon") sprintf(aff,"%03d°",dm.deg);
-        else if (type=="rot") sprintf(aff,"%03d ",dm.deg);
+        if      (type=="lat") n = snprintf(s, DMS_BUFFER_SIZE-4, "%02d°",dm.deg);
+        else if (type=="lon") n = snprintf(s, DMS_BUFFER_SIZE-4, "%03d°",dm.deg);
+        else if (type=="rot") n = snprintf(s, DMS_BUFFER_SIZE-4, "%03d ",dm.deg);
     }
     else if (n_ang < 3)
     {
-        if      (type=="lat") sprintf(aff,"%02d°%02.0lf'",dm.deg, dm.min);
-        else if (type=="lon") sprintf(aff,"%03d°%02.0lf'",dm.deg, dm.min);
-        else if (type=="rot") sprintf(aff,"%03d %02.0lf ",dm.deg, dm.min);
+        if      (type=="lat") n = snprintf(s, DMS_BUFFER_SIZE-4, "%02d°%02.0lf'",dm.deg, dm.min);
+        else if (type=="lon") n = snprintf(s, DMS_BUFFER_SIZE-4, "%03d°%02.0lf'",dm.deg, dm.min);
+        else if (type=="rot") n = snprintf(s, DMS_BUFFER_SIZE-4, "%03d %02.0lf ",dm.deg, dm.min);
     }
     else
     {
@@ -667,17 +1009,21 @@ std::string writeDM (double aa, std::string type, unsigned int n_ang, bool plain
         if      (type=="lat") sprintf(frmt,"%s%s%s","%02d°",frmt_min,"'");
         else if (type=="lon") sprintf(frmt,"%s%s%s","%03d°",frmt_min,"'");
         else if (type=="rot") sprintf(frmt,"%s%s","%03d ",frmt_min);
-        sprintf(aff,frmt,dm.deg, dm.min);
+        else return 0;
+        n = snprintf(s, DMS_BUFFER_SIZE-4, frmt, dm.deg, dm.min);
     }
+    return signDMS(aff, n, dm.neg, type);
+}
 
-    std::string ret=aff;
-    if      ( dm.neg && type=="lat") return ret+"S ";
-    else if (!dm.neg && type=="lat") return ret+"N ";
-    else if ( dm.neg && type=="lon") return ret+"W ";
-    else if (!dm.neg && type=="lon") return ret+"E ";
-    else if ( dm.neg && type=="rot") return "- "+ret;
-    else if (!dm.neg && type=="rot") return "  "+ret;
-    return "";
+/**
+* \brief Writes a sexagesimal double value in a human-readable form.
+* \param[in] aa: a sexagesimal value in decimal format (DD.MMMMMMMMM).
+* \return: The value in a human-readable form (...°...').
+*/
+std::string writeDM (double aa, std::string type, unsigned int n_ang, bool plainDMS)
+{
+    char aff[DMS_BUFFER_SIZE];
+    return std::string(aff, writeDM(aff, aa, type, n_ang, plainDMS));
 }
 
 }
@@ -61,6 +61,7 @@ namespace circe
 #define DEG2RAD 0.017453292519943295 //M_PI/180.
 #define RAD2DEG 57.295779513082323 //180./M_PI
 #define SEC2RAD 4.8481368110953598e-06  //M_PI/180./3600.
+#define DMS_BUFFER_SIZE 64 //writeDMS, writeDM
 
 /** \brief Accomodation for sexagesimal coordinates in Degree Minute Second (DMS) format.*/
 struct DMS
@@ -79,6 +80,26 @@ struct DM
     double min;
 } ;
 
+/** \brief Path of a unit conversion, resolved once by InitUnitConversion.*/
+enum UNIT_CONVERSION_PATH
+{
+    UCP_IDENTITY,   // v
+    UCP_FACTOR,     // v*factor
+    UCP_FROM_DMS,   // sexadms_to_deci(v)*factor
+    UCP_FROM_DM,    // sexadm_to_deci(v)*factor
+    UCP_TO_DMS,     // deci_to_sexadms(v*factor)
+    UCP_TO_DM,      // deci_to_sexadm(v*factor)
+    UCP_GENERIC     // UnitConvert(v, u1, u2)
+};
+
+/** \brief Conversion between two measure units, resolved once (see InitUnitConversion).*/
+struct unitConversion
+{
+    MEASURE_UNIT u1, u2;
+    UNIT_CONVERSION_PATH path;
+    double factor;
+};
+
 double dec_round(double z, int ndec);
 double trunk(double z, int ndec);
 void double_to_dms(long double a, DMS *dms, unsigned int n_ang);
@@ -91,15 +112,38 @@ long double deci_to_sexadms(long double val);
 long double sexadms_to_deci(long double val);
 long double sexadm_to_deci(long double val);
 long double deci_to_sexadm(long double val);
-double readDMS(std::string str, std::string what, bool bValide);
+double readDMS(const std::string& str, const std::string& what, bool bValide);
 
 std::string DecodeUnit(const std::string& code);
 double UnitConvert(double v, MEASURE_UNIT u1, MEASURE_UNIT u2);
+void InitUnitConversion(MEASURE_UNIT u1, MEASURE_UNIT u2, unitConversion *uc);
+void UnitConvertMany(unsigned int n, const double *v, double *w, const unitConversion &uc);
+
+/**
+* \brief Converts a value from a unit to another, the conversion being resolved beforehand.
+* \param[in] v: the value.
+* \param[in] uc: a unitConversion instance initialized by InitUnitConversion.
+* \return the converted value.
+*/
+inline double UnitConvert(double v, const unitConversion &uc)
+{
+    if (uc.path == UCP_IDENTITY) return v;
+    if (uc.path == UCP_FACTOR) return v*uc.factor;
+    if (uc.path == UCP_FROM_DMS) return double(sexadms_to_deci(v))*uc.factor;
+    if (uc.path == UCP_FROM_DM) return double(sexadm_to_deci(v))*uc.factor;
+    if (uc.path == UCP_TO_DMS) return v == 0. ? v : deci_to_sexadms(v*uc.factor);
+    if (uc.path == UCP_TO_DM) return v == 0. ? v : deci_to_sexadm(v*uc.factor);
+    return UnitConvert(v, uc.u1, uc.u2);
+}
 void test_deci_sexadms(std::ofstream *fo, double doudou1);
 void testUnits(std::string filout);
+void testReadDMS(std::string filout);
+void testUnitConvertMany(std::string filout);
 void test_decimal_separator();
 std::string writeDMS (double aa, std::string type, unsigned int n_ang, bool plainDMS);
 std::string writeDM (double aa, std::string type, unsigned int n_ang, bool plainDMS);
+unsigned int writeDMS (char *aff, double aa, const std::string& type, unsigned int n_ang, bool plainDMS);
+unsigned int writeDM (char *aff, double aa, const std::string& type, unsigned int n_ang, bool plainDMS);
 
 }
 #endif // TOOLS_H
@@ -4,6 +4,7 @@ QT       -= gui
 TARGET = circeFR
 CONFIG   += console
 CONFIG   -= app_bundle
+CONFIG   += c++17
 
 TEMPLATE = app
 
@@ -23,6 +24,24 @@ unix:CONFIG += QMAKE_WITH_GDAL
 Release:win32:CONFIG += QMAKE_WITH_GDAL
 }
 
+# gzip (zlib) and zstd compressed data files
+unix:CONFIG += WITH_ZLIB
+#win32:CONFIG += WITH_ZLIB
+#unix:CONFIG += WITH_ZSTD
+#win32:CONFIG += WITH_ZSTD
+
+WITH_ZLIB {
+DEFINES += WITH_ZLIB
+unix:LIBS += -lz
+win32:LIBS += zlib.lib
+}
+
+WITH_ZSTD {
+DEFINES += WITH_ZSTD
+unix:LIBS += -lzstd
+win32:LIBS += zstd.lib
+}
+
 #INCLUDEPATH += ../tinyxml2-master
 
 
@@ -56,6 +75,7 @@ SOURCES += \
     ../../circelib/catoperation.cpp \
     ../../circelib/parser.cpp \
     ../../circelib/files.cpp \
+    ../../circelib/compressedstream.cpp \
     ../../circelib/pt4d.cpp \
     ../../circelib/xmlparser.cpp \
     ../../circelib/conversioncore.cpp \
@@ -86,6 +106,7 @@ HEADERS += \
     ../../circelib/StringResourcesEN.h \
     ../../circelib/StringResourcesFR.h \
     ../../circelib/files.h \
+    ../../circelib/compressedstream.h \
     ../../circelib/pt4d.h \
     ../../circelib/xmlparser.h \
     ../../circelib/conversioncore.h \
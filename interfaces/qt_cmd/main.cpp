@@ -53,12 +53,16 @@ int main(int argc, char *argv[])
     circe::circeOptions circopt;
     std::ofstream fo;
     circe::swain s;
+    std::ostream *out = &std::cout;
     s.fi = NULL;
     s.fo = NULL;
     try
     {
         circe::initDefOptions(&circopt);
         circe::parseArgArray(&circopt, argc, argv, &iargv);
+        // data on the standard output, messages on the standard error
+        if (circopt.targetOptions.pathname == "-")
+            out = &std::cerr;
         circe::initFormats(circopt.displayPrecision, circopt.targetOptions.angularUnit, &(circopt.Pt4d.frmt));
         circe::openLog(&fo, circopt.logPathname);
         circe::scrutinizeOptions (&circopt);
@@ -67,7 +71,7 @@ int main(int argc, char *argv[])
 //        qDebug("%s",circopt.sourceOptions.pathname.data());
 //        if (!(s.fi->is_open()))
 //            throw circe::ErrorMessageText[circe::EM_CANNOT_OPEN]+circopt.sourceOptions.pathname;
-        std::cout << circe::processOptions(circopt,NULL,&s) << std::endl;
+        *out << circe::processOptions(circopt,NULL,&s) << std::endl;
         fo.close();
     }
     catch (std::string str)
@@ -75,14 +79,14 @@ int main(int argc, char *argv[])
         circe::writeLog(&fo, circe::CIRCE_ERROR);
         circe::writeLog(&fo, str);
         fo.close();
-        std::cout << circe::displayOutput(circopt, str, "{", "}", true) << std::endl;
+        *out << circe::displayOutput(circopt, str, "{", "}", true) << std::endl;
     }
     catch(std::exception e)
     {
-       std::cout << "Exception: " << e.what() << std::endl;
+       *out << "Exception: " << e.what() << std::endl;
     }
     catch(...)
     {
-      std::cout << "Non-processed exception!" << std::endl;
+      *out << "Non-processed exception!" << std::endl;
     }
 }
@@ -4,6 +4,7 @@ greaterThan(QT_MAJOR_VERSION, 4): QT += widgets
 
 TARGET = circeWidget
 TEMPLATE = app
+CONFIG += c++17
 
 DEFINES += UI_LANGUAGE_FRENCH
 
@@ -21,6 +22,24 @@ unix:CONFIG += QMAKE_WITH_GDAL
 Release:win32:CONFIG += QMAKE_WITH_GDAL
 }
 
+# gzip (zlib) and zstd compressed data files
+unix:CONFIG += WITH_ZLIB
+#win32:CONFIG += WITH_ZLIB
+#unix:CONFIG += WITH_ZSTD
+#win32:CONFIG += WITH_ZSTD
+
+WITH_ZLIB {
+DEFINES += WITH_ZLIB
+unix:LIBS += -lz
+win32:LIBS += zlib.lib
+}
+
+WITH_ZSTD {
+DEFINES += WITH_ZSTD
+unix:LIBS += -lzstd
+win32:LIBS += zstd.lib
+}
+
 #INCLUDEPATH += ../tinyxml2-master
 
 QMAKE_WITH_GDAL {
@@ -47,6 +66,7 @@ SOURCES += main.cpp\
     ../../circelib/crs.cpp \
     ../../circelib/ellipsoid.cpp \
     ../../circelib/files.cpp \
+    ../../circelib/compressedstream.cpp \
     ../../circelib/geodeticreferenceframe.cpp \
     ../../circelib/geodeticset.cpp \
     ../../circelib/meridian.cpp \
@@ -75,6 +95,7 @@ HEADERS  += mainwindow.h \
     ../../circelib/crs.h \
     ../../circelib/ellipsoid.h \
     ../../circelib/files.h \
+    ../../circelib/compressedstream.h \
     ../../circelib/geodeticreferenceframe.h \
     ../../circelib/geodeticset.h \
     ../../circelib/meridian.h \